@@ -91,28 +91,19 @@ namespace ElectricalCircuitSimulator
         {
             // Go to the folder where circuit files and images are contained, and load them all
             Image oBlankImage = new Image();
-            Collection<Collection<string>> oFileTextLines = new Collection<Collection<string>>();
-            Collection<string> oTextLines;
-            StreamReader oStreamReader;
+            Collection<string> oTitles = new Collection<string>();
+            Netlist oNetlist;
             LinearCircuit oLinearCircuit;
             string[] sfiles = new string[0];
-            string[] sComponentParams;
             string sDirectoryPath1 = @"../../../../../../Circuits";
             string sDirectoryPath2 = @"Circuits";
             string sBlankFilePath1 = "../../../../../../Circuits/Blank.png";
             string sBlankFilePath2 = "Circuits/Blank.png";
             string sFileType = "*.txt";
-            string sFileTextLine;
-            string sName;
-            double[] dParamValue = new double[2];
             bool bFirstListSelectionConfigured = false;
             bool bDefaultPathExists;
             int iFile;
-            int iLineIndex;
             int iLoadedFile = 0;
-            int iComponent;
-            int iComponents;
-            int[] iParamValue = new int[2];
 
             m_oSimulations = new Collection<LinearCircuit>();
             m_oVoltageScopeNodes = new Collection<int>();
@@ -150,91 +141,22 @@ namespace ElectricalCircuitSimulator
 
             for (iFile = 0; iFile < sfiles.Length; iFile++)
             {
-                // Load circuit file data
+                // Load circuit file data, the native parser builds the components and reads the scopes and time params
                 try
                 {
-                    oTextLines = new Collection<string>();
-                    oFileTextLines.Add(oTextLines);
-                    oStreamReader = new StreamReader(sfiles[iFile]);
-                    do
+                    // The native netlist is released on every path, also when reading it fails
+                    using (oNetlist = new Netlist(sfiles[iFile]))
                     {
-                        sFileTextLine = oStreamReader.ReadLine();
-                        if (sFileTextLine != null)
-                        {
-                            oTextLines.Add(sFileTextLine);
-                        }
-                    } while (sFileTextLine != null);
-                    oStreamReader.Close();
-
-                    // Build the simulations
-
-                    // Components
-                    iLineIndex = FileConstants.HEADER_LINES;
-                    iComponents = oTextLines.Count() - FileConstants.ALL_EXCEPT_COMPONENTS;
-                    oLinearCircuit = new LinearCircuit(iComponents);
-                    for (iComponent = (iLineIndex); iComponent < (iComponents + iLineIndex); iComponent++)
-                    {
-                        sName = oTextLines[iComponent].Split("(")[0];
-                        sComponentParams = oTextLines[iComponent].Split("(")[1].Split(")")[0].Split(",");
-                        switch (sName)
-                        {
-                            case "Resistor":
-                                oLinearCircuit.addResistor(int.Parse(sComponentParams[0]), int.Parse(sComponentParams[1]), double.Parse(sComponentParams[2]));
-                                break;
-                            case "Capacitor":
-                                oLinearCircuit.addCapacitor(int.Parse(sComponentParams[0]), int.Parse(sComponentParams[1]), double.Parse(sComponentParams[2]));
-                                break;
-                            case "Inductor":
-                                oLinearCircuit.addInductor(int.Parse(sComponentParams[0]), int.Parse(sComponentParams[1]), double.Parse(sComponentParams[2]));
-                                break;
-                            case "GroundedVoltageSource":
-                                oLinearCircuit.addGroundedVoltageSource(int.Parse(sComponentParams[0]), int.Parse(sComponentParams[1]), double.Parse(sComponentParams[2]), double.Parse(sComponentParams[3]));
-                                break;
-                            default:
-                                throw new Exception("Unknown circuit component type!");
-                        }
-                    }
-
-                    // Scopes
-                    iLineIndex += iComponents;
-                    sName = oTextLines[iLineIndex].Split("(")[0];
-                    iParamValue[0] = int.Parse(oTextLines[iLineIndex].Split("(")[1].Split(")")[0]);
-                    if (sName != "ScopeV")
-                    {
-                        throw new Exception("Error with voltage scope formatting!");
+                        oLinearCircuit = oNetlist.createLinearCircuit();
+
+                        // Add everything to collections at the end, so errors don't result in mismatching collection indexes
+                        oTitles.Add(oNetlist.getTitle());
+                        m_oVoltageScopeNodes.Add(oNetlist.getVoltageScopeNode());
+                        m_oCurrentScopeComponents.Add(oNetlist.getCurrentScopeComponent());
+                        m_oTimeSteps.Add(oNetlist.getTimeStep());
+                        m_oStopTimes.Add(oNetlist.getStopTime());
+                        m_oSimulations.Add(oLinearCircuit);
                     }
-
-                    iLineIndex += FileConstants.SCOPE_V_LINES;
-                    sName = oTextLines[iLineIndex].Split("(")[0];
-                    iParamValue[1] = int.Parse(oTextLines[iLineIndex].Split("(")[1].Split(")")[0]);
-                    if (sName != "ScopeI")
-                    {
-                        throw new Exception("Error with current scope formatting!");
-                    }
-
-                    // Time params
-                    iLineIndex += FileConstants.SCOPE_I_LINES;
-                    sName = oTextLines[iLineIndex].Split("(")[0];
-                    dParamValue[0] = double.Parse(oTextLines[iLineIndex].Split("(")[1].Split(")")[0]);
-                    if (sName != "TimeStep")
-                    {
-                        throw new Exception("Error with time step formatting!");
-                    }
-
-                    iLineIndex += FileConstants.TIME_STEP_LINES;
-                    sName = oTextLines[iLineIndex].Split("(")[0];
-                    dParamValue[1] = double.Parse(oTextLines[iLineIndex].Split("(")[1].Split(")")[0]);
-                    if (sName != "StopTime")
-                    {
-                        throw new Exception("Error with stop time formatting!");
-                    }
-
-                    // Add everything to collections at the end, so errors don't result in mismatching collection indexes
-                    m_oVoltageScopeNodes.Add(iParamValue[0]);
-                    m_oCurrentScopeComponents.Add(iParamValue[1]);
-                    m_oTimeSteps.Add(dParamValue[0]);
-                    m_oStopTimes.Add(dParamValue[1]);
-                    m_oSimulations.Add(oLinearCircuit);
                 }
                 catch
                 {
@@ -261,7 +183,7 @@ namespace ElectricalCircuitSimulator
 
                 // Setup selection interface
                 IndexTextBlock oTextBlock = new IndexTextBlock(iLoadedFile - 1);
-                oTextBlock.Text = oFileTextLines[iFile][FileConstants.START_FILE];
+                oTextBlock.Text = oTitles[iLoadedFile - 1];
                 oTextBlock.FontSize = 15;
                 oTextBlock.Margin = new Thickness(4, 5, 5, 0);
                 oTextBlock.Padding = new Thickness(10, 10, 10, 10);
@@ -506,17 +428,6 @@ namespace ElectricalCircuitSimulator
 
 #region Classes
 
-public static class FileConstants
-{
-    public const int START_FILE = 0;
-    public const int HEADER_LINES = 1;
-    public const int SCOPE_V_LINES = 1;
-    public const int SCOPE_I_LINES = 1;
-    public const int TIME_STEP_LINES = 1;
-    public const int STOP_TIME_LINES = 1;
-    public const int ALL_EXCEPT_COMPONENTS = HEADER_LINES + SCOPE_V_LINES + SCOPE_I_LINES + TIME_STEP_LINES + STOP_TIME_LINES;
-}
-
 public class IndexTextBlock : TextBlock
 {
     public IndexTextBlock() : base() { }
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "CircuitDescription.h"
+#include "Matrix.h"
+#include "SparseLU_Factorization.h"
+#include "SparseMatrix.h"
+#include <complex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+// Small signal frequency response of a circuit, solved directly in the frequency domain instead of stepping a transient.
+// Resistors stamp G, capacitors jwC and inductors 1/(jwL). Grounded voltage sources stamp their source resistance and
+// a V/R current source, so every source drives the circuit with its voltage as the amplitude at phase 0. The ground
+// node is the ground of the voltage sources and is left out of the system.
+// The matrix pattern does not depend on the frequency, so the ordering and pivot order are found once and every
+// frequency is a numeric refactor and one solve. Frequencies are independent and split between threads.
+
+namespace SimulationEngine {
+
+    class AcAnalysis final {
+
+        public:
+
+            #pragma region Constructors
+
+            AcAnalysis(const CircuitDescription& oCircuit);
+
+            #pragma endregion
+
+            #pragma region Observers
+
+            size_t getNumFrequencies() const;
+            size_t getNumProbes() const;
+            size_t getNumThreads() const;
+            double getFrequency(const size_t iFrequencyIndex) const; // Hz
+            // Phasor of a probe, probes are numbered in the order added
+            std::complex<double> getResult(const size_t iFrequencyIndex, const size_t iProbeIndex) const;
+            double getMagnitude(const size_t iFrequencyIndex, const size_t iProbeIndex) const;
+            double getPhase(const size_t iFrequencyIndex, const size_t iProbeIndex) const; // Radians
+            std::span<const std::complex<double>> getResults() const; // Frequency major, getNumProbes() values per frequency
+
+            #pragma endregion
+
+            #pragma region Modifiers
+
+            // Frequencies are in Hz and must be greater than 0, they are solved in the order added
+            void addFrequency(const double dFrequency);
+            void addLinearFrequencies(const double dStart, const double dStop, const size_t iNumPoints);
+            void addLogFrequencies(const double dStart, const double dStop, const size_t iNumPoints); // Evenly spaced per decade
+            void clearFrequencies();
+
+            // Both add functions return the index used by getResult
+            size_t addVoltageProbe(const size_t iNode);
+            size_t addCurrentProbe(const size_t iComponentIndex);
+
+            void setNumThreads(const size_t iNumThreads); // 0 uses every hardware thread
+
+            void run();
+
+            #pragma endregion
+
+        private:
+
+            struct AcProbe {
+                bool bVoltage;
+                size_t iIndex; // Node or component index
+            };
+
+            // Per thread copies, only the values change between frequencies
+            struct AcWorkspace {
+                SparseMatrix<std::complex<double>> oAdmittanceMatrix;
+                SparseLU_Factorization<std::complex<double>> oFactorization;
+                Matrix<std::complex<double>> oSolution;
+                Matrix<std::complex<double>> oScratch;
+            };
+
+            static constexpr size_t NO_NODE = static_cast<size_t>(-1);
+
+            #pragma region Private Modifiers
+
+            void addFrequencyChecked(const double dFrequency);
+            void buildSystem();
+            void solveFrequency(AcWorkspace& oWorkspace, const size_t iFrequencyIndex);
+
+            #pragma endregion
+
+            #pragma region Private Observers
+
+            size_t getSystemNode(const size_t iNode) const; // NO_NODE for the ground
+            std::complex<double> getNodeVoltage(const Matrix<std::complex<double>>& oSolution, const size_t iSystemNode) const;
+            void checkResult(const size_t iFrequencyIndex, const size_t iProbeIndex) const;
+
+            #pragma endregion
+
+            #pragma region Members
+
+            CircuitDescription m_oCircuit;
+            size_t m_iNumThreads;
+            bool m_bHasRun;
+            size_t m_iGroundNode; // User node
+            std::unordered_map<size_t, size_t> m_oSystemNodes; // User node -> system row, the ground has none
+            std::vector<size_t> m_oComponentNodes; // System nodes of every component, S then D
+            // G, C and 1/L parts of every matrix entry, all three have the admittance matrix's pattern
+            SparseMatrix<double> m_oConductance;
+            SparseMatrix<double> m_oCapacitance;
+            SparseMatrix<double> m_oInverseInductance;
+            Matrix<std::complex<double>> m_oSourceVector; // Same at every frequency
+            std::vector<double> m_oFrequencies;
+            std::vector<AcProbe> m_oProbes;
+            std::vector<std::complex<double>> m_oResults; // Frequency major
+
+            #pragma endregion
+    };
+
+}
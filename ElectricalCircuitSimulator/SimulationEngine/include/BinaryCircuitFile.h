@@ -0,0 +1,87 @@
+#pragma once
+
+#include "MappedFile.h"
+#include "NetlistParser.h"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+// Versioned binary circuit format, loaded through a memory map without any parsing:
+//     BinaryCircuitHeader                    Fixed size, iHeaderSize lets later versions append fields
+//     Title                                  iTitleSize bytes, zero padded to a multiple of 8
+//     BinaryComponentRecord[iNumComponents]  Starts at iComponentOffset
+// Everything is little endian with 8 byte aligned fields, so the records can be read in place from the mapping.
+// Component indices are the record order, the same order NetlistParser and CircuitDescription use.
+
+namespace SimulationEngine {
+
+    struct BinaryCircuitHeader {
+        char acMagic[8]; // "ECSCIRC" and a 0
+        std::uint32_t iVersion;
+        std::uint32_t iHeaderSize;
+        std::uint64_t iNumNodes; // Distinct node indices, for reserving node storage
+        std::uint64_t iNumComponents;
+        std::uint64_t iTitleSize;
+        std::uint64_t iComponentOffset;
+        std::uint64_t iVoltageScopeNode;
+        std::uint64_t iCurrentScopeComponent;
+        double dTimeStep;
+        double dStopTime;
+    };
+
+    struct BinaryComponentRecord {
+        std::uint32_t iKind; // CircuitComponentKind
+        std::uint32_t iReserved;
+        std::uint64_t iNodeS;
+        std::uint64_t iNodeD;
+        double dValue; // R, C, L or V
+        double dSourceResistance; // Voltage sources only
+    };
+
+    class BinaryCircuitFile final {
+
+        public:
+
+            static constexpr std::uint32_t VERSION = 1;
+
+            #pragma region Constructors
+
+            // Maps the file and checks the header and component kinds, the values are checked when a simulation is built
+            BinaryCircuitFile(const std::string& sPath);
+
+            #pragma endregion
+
+            #pragma region Observers
+
+            const BinaryCircuitHeader& getHeader() const;
+            std::string_view getTitle() const;
+            std::span<const BinaryComponentRecord> getComponents() const; // Points into the mapping
+
+            // Adds every component to an empty simulation and sets the time params from the file
+            void buildSimulation(PartitionedCircuitSimulation& oSimulation) const;
+            CircuitDescription toCircuitDescription() const;
+            Netlist toNetlist() const;
+
+            #pragma endregion
+
+            #pragma region Static Functions
+
+            static void write(const Netlist& oNetlist, const std::string& sPath);
+            // Text netlist (Circuits/*.txt) to the binary format
+            static void convertNetlist(const std::string& sTextPath, const std::string& sBinaryPath);
+
+            #pragma endregion
+
+        private:
+
+            #pragma region Members
+
+            MappedFile m_oFile;
+            const BinaryCircuitHeader* m_pHeader;
+            std::span<const BinaryComponentRecord> m_oComponents;
+
+            #pragma endregion
+    };
+
+}
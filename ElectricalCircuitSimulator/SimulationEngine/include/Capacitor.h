@@ -9,11 +9,18 @@ namespace SimulationEngine {
         public:
 
             Capacitor(const size_t iNodeS, const size_t iNodeD, const double m_dCapacitance);
+            void setCapacitance(const double dCapacitance); // Takes effect on the next initalize
 
-            void LNS_initalize(Matrix<double>& oConductanceMatrix, const double dTimeStep);
-            void LNS_step(Matrix<double>& oSourceVector); // Trapezoidal integration
+            void LNS_initalize(SparseMatrix<double>& oConductanceMatrix, const double dTimeStep);
+            void LNS_step(Matrix<double>& oSourceVector, const double dTime); // Trapezoidal integration
             void LNS_postStep(Matrix<double>& oVoltageMatrix);
-            void applySimulationMatrixStamp(Matrix<double>& oConductanceMatrix, const double dTimeStep);
+            double LNS_getTruncationError(const double dRelativeTolerance, const double dAbsoluteTolerance) const;
+            void LNS_rejectStep();
+            void LNS_initalizeDC(SparseMatrix<double>& oConductanceMatrix);
+            void LNS_stepDC(Matrix<double>& oSourceVector);
+            void LNS_postStepDC(Matrix<double>& oVoltageMatrix);
+            void renumberNodes(const std::unordered_map<size_t, size_t>& oNodeIndices);
+            void applySimulationMatrixStamp(SparseMatrix<double>& oConductanceMatrix, const double dTimeStep);
             void applyThroughVectorMatrixStamp(Matrix<double>& oSourceVector);
 
         private:
@@ -22,6 +29,10 @@ namespace SimulationEngine {
             size_t m_iNodeD;
             double m_dCapacitance;
             double m_dVoltageDelta;
+            double m_dTimeStep;
+            double m_dPreviousVoltageDelta; // State before the last step, restored if the step is rejected
+            double m_dPreviousThrough;
+            TrapezoidalErrorEstimator m_oErrorEstimator; // Tracks the voltage
     };
 
 }
\ No newline at end of file
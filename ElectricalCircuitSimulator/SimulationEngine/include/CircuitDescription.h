@@ -0,0 +1,108 @@
+#pragma once
+
+#include "PartitionedCircuitSimulation.h"
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+// Plain list of the built in components of a circuit. Unlike a simulation it can be copied freely, so it can be built
+// once and turned into many simulations (sweeps, one simulation per thread). Values are checked when a simulation is built.
+
+namespace SimulationEngine {
+
+    struct ComponentDescription {
+        CircuitComponentKind eKind;
+        size_t iNodeS;
+        size_t iNodeD;
+        double dValue; // R, C, L or V
+        double dSourceResistance; // Voltage sources only
+    };
+
+    class CircuitDescription final {
+
+        public:
+
+            #pragma region Observers
+
+            size_t getNumComponents() const {
+                return m_oComponents.size();
+            }
+
+            const ComponentDescription& getComponent(const size_t iComponentIndex) const {
+                if (iComponentIndex >= m_oComponents.size()) {
+                    std::cout << "Requested component does not exist!" << std::endl;
+                    throw std::invalid_argument("Requested component does not exist!");
+                }
+
+                return m_oComponents[iComponentIndex];
+            }
+
+            const std::vector<ComponentDescription>& getComponents() const {
+                return m_oComponents;
+            }
+
+            #pragma endregion
+
+            #pragma region Modifiers
+
+            void reserve(const size_t iNumComponents) {
+                m_oComponents.reserve(iNumComponents);
+            }
+
+            // All add functions return the component index, it is the same index the built simulation uses
+            size_t addResistor(const size_t iNodeS, const size_t iNodeD, const double dResistance) {
+                m_oComponents.push_back({ CircuitComponentKind::Resistor, iNodeS, iNodeD, dResistance, 0 });
+                return m_oComponents.size() - 1;
+            }
+
+            size_t addCapacitor(const size_t iNodeS, const size_t iNodeD, const double dCapacitance) {
+                m_oComponents.push_back({ CircuitComponentKind::Capacitor, iNodeS, iNodeD, dCapacitance, 0 });
+                return m_oComponents.size() - 1;
+            }
+
+            size_t addInductor(const size_t iNodeS, const size_t iNodeD, const double dInductance) {
+                m_oComponents.push_back({ CircuitComponentKind::Inductor, iNodeS, iNodeD, dInductance, 0 });
+                return m_oComponents.size() - 1;
+            }
+
+            size_t addGroundedVoltageSource(const size_t iNodeS, const size_t iNodeD, const double dVoltage, const double dResistance) {
+                m_oComponents.push_back({ CircuitComponentKind::GroundedVoltageSource, iNodeS, iNodeD, dVoltage, dResistance });
+                return m_oComponents.size() - 1;
+            }
+
+            void clear() {
+                m_oComponents.clear();
+            }
+
+            // Adds every component to an empty simulation
+            void buildSimulation(PartitionedCircuitSimulation& oSimulation) const {
+                for (const ComponentDescription& oComponent : m_oComponents) {
+                    switch (oComponent.eKind) {
+                        case CircuitComponentKind::Resistor:
+                            oSimulation.addResistor(oComponent.iNodeS, oComponent.iNodeD, oComponent.dValue);
+                            break;
+                        case CircuitComponentKind::Capacitor:
+                            oSimulation.addCapacitor(oComponent.iNodeS, oComponent.iNodeD, oComponent.dValue);
+                            break;
+                        case CircuitComponentKind::Inductor:
+                            oSimulation.addInductor(oComponent.iNodeS, oComponent.iNodeD, oComponent.dValue);
+                            break;
+                        case CircuitComponentKind::GroundedVoltageSource:
+                            oSimulation.addGroundedVoltageSource(oComponent.iNodeS, oComponent.iNodeD, oComponent.dValue, oComponent.dSourceResistance);
+                            break;
+                    }
+                }
+            }
+
+            #pragma endregion
+
+        private:
+
+            #pragma region Members
+
+            std::vector<ComponentDescription> m_oComponents;
+
+            #pragma endregion
+    };
+
+}
@@ -1,9 +1,37 @@
 #pragma once
 
 #include "Matrix.h"
+#include "SparseMatrix.h"
+#include <array>
+#include <initializer_list>
+#include <span>
+#include <unordered_map>
+#include <vector>
 
 namespace SimulationEngine {
 
+    // Local truncation error of the trapezoidal rule, h^3/12 * x'''(t). x''' is estimated from the third divided
+    // difference of the last four accepted values of a component state (x''' = 6 * DD3).
+    class TrapezoidalErrorEstimator final {
+
+        public:
+
+            TrapezoidalErrorEstimator();
+
+            void reset(const double dValue); // Value at time zero
+            void addSample(const double dValue, const double dTimeStep); // Value at the end of a step of length dTimeStep
+            void removeSample(); // Undo the last addSample (rejected step)
+            double getError() const; // 0 until four values are known
+
+        private:
+
+            static constexpr size_t NUM_SAMPLES = 5; // One more than needed so a rejected step can be undone
+
+            size_t m_iNumSamples;
+            std::array<double, NUM_SAMPLES> m_oValues; // Newest first
+            std::array<double, NUM_SAMPLES> m_oTimeSteps; // m_oTimeSteps[i] is the time between m_oValues[i + 1] and m_oValues[i]
+    };
+
     class DiscreteEventTimeDomainSimComponent {
 
         public:
@@ -14,31 +42,35 @@ namespace SimulationEngine {
             virtual void DETDS_step();
     };
 
+    // Nodes are held in a small inline array, components with more than INLINE_NODES nodes spill the rest to the heap
     class NodeSimComponent : public DiscreteEventTimeDomainSimComponent {
 
         public:
 
-            NodeSimComponent(const size_t iNodeList);
+            NodeSimComponent(std::initializer_list<size_t> oNodes);
 
-            size_t getNumNodes() const;
+            size_t getNumNodes() const {
+                return m_iNumNodes;
+            }
             size_t getNode(const size_t iNodeIndex) const;
-            void setNodeList(const size_t iNodeList) {
-                m_iNodeList = iNodeList;
-            };
+            void setNodes(std::span<const size_t> oNodes);
+            // Replace every node with its index in the simulation (user node -> dense index)
+            virtual void renumberNodes(const std::unordered_map<size_t, size_t>& oNodeIndices);
 
         protected:
 
-            size_t BITS_PER_NODE = 4;
-            size_t NODE_BITMASK = 0xF;
-            size_t MAX_NODES = 16; // 64 bits / BITS_PER_NODE 
-            size_t m_iNodeList;
+            static constexpr size_t INLINE_NODES = 4;
+
+            size_t m_iNumNodes;
+            std::array<size_t, INLINE_NODES> m_oInlineNodes;
+            std::vector<size_t> m_oOverflowNodes; // Nodes past INLINE_NODES
     };
 
     class LinearNaturalSimComponent : public NodeSimComponent {
 
         public:
 
-            LinearNaturalSimComponent(const size_t iNodeList, const bool bHasAcrossReferenceNode, const size_t iAcrossReferenceNode);
+            LinearNaturalSimComponent(std::initializer_list<size_t> oNodes, const bool bHasAcrossReferenceNode, const size_t iAcrossReferenceNode);
 
             bool hasAcrossReferenceNode() const {
                 return m_bHasAcrossReferenceNode;
@@ -49,19 +81,54 @@ namespace SimulationEngine {
             double getThrough() const { // Through param going through component
                 return m_dThrough;
             }
-            virtual void LNS_initalize(Matrix<double>& oSimulationMatrix, const double dTimeStep);
-            virtual void LNS_step(Matrix<double>& oThroughVector);
+            virtual void renumberNodes(const std::unordered_map<size_t, size_t>& oNodeIndices);
+            virtual void LNS_initalize(SparseMatrix<double>& oSimulationMatrix, const double dTimeStep);
+            virtual void LNS_step(Matrix<double>& oThroughVector, const double dTime); // dTime is the time the step solves for (its end)
             virtual void LNS_postStep(Matrix<double>& oAcrossVector);
+            // False if LNS_step always stamps the same values (no history state, no waveform), e.g. components that stamp
+            // nothing in the through vector or a constant source. Static stamps are only redone on initalize.
+            virtual bool LNS_isDynamic() const;
+            // Adaptive time stepping. The state is kept, only the simulation matrix stamp is redone for the new time step.
+            void LNS_restamp(SparseMatrix<double>& oSimulationMatrix, const double dTimeStep);
+            // Error of the last step divided by dRelativeTolerance * |state| + dAbsoluteTolerance, above 1 rejects the step
+            virtual double LNS_getTruncationError(const double dRelativeTolerance, const double dAbsoluteTolerance) const;
+            virtual void LNS_rejectStep(); // Go back to the state before the last LNS_step
+            // DC operating point, solved once without a time step. The defaults fit components without history state,
+            // energy storing components stamp their DC equivalent and keep the DC solution as their state.
+            virtual void LNS_initalizeDC(SparseMatrix<double>& oSimulationMatrix);
+            virtual void LNS_stepDC(Matrix<double>& oThroughVector);
+            virtual void LNS_postStepDC(Matrix<double>& oAcrossVector);
+            // Modified nodal analysis. A branch is an extra unknown next to the node across values (e.g. the current of an
+            // ideal voltage source) with its own simulation matrix row and column. The simulation sets the indices when
+            // the component is added.
+            size_t LNS_getNumBranches() const {
+                return m_oBranches.size();
+            }
+            size_t LNS_getBranch(const size_t iBranchIndex) const;
+            void LNS_setBranch(const size_t iBranchIndex, const size_t iIndex);
 
         protected:
 
+            static constexpr size_t NO_BRANCH = static_cast<size_t>(-1); // Branch index not set yet
+            // Seconds. An open capacitor is stamped as the leak G = C / dDC_OPEN_TIME_CONSTANT, so a node only connected through
+            // capacitors stays solvable and settles where an uncharged capacitive divider would put it. The factorizations test
+            // pivots relative to their own column, so the tiny conductance is kept next to much larger ones.
+            static constexpr double dDC_OPEN_TIME_CONSTANT = 1e12;
+            static constexpr double dDC_SHORT_CONDUCTANCE = 1e9; // Short circuit
+
             bool m_bHasAcrossReferenceNode;
             size_t m_iAcrossReferenceNode;
             double m_dComponentSimulationMatrixStamp;
             double m_dThrough; // Through param is positive if flowing from source to destination, negative if the opposite direction
+            std::vector<size_t> m_oBranches; // Simulation index of every branch unknown, empty for most components
 
-            virtual void applySimulationMatrixStamp(Matrix<double>& oSimulationMatrix, const double dTimeStep);
+            virtual void applySimulationMatrixStamp(SparseMatrix<double>& oSimulationMatrix, const double dTimeStep);
             virtual void applyThroughVectorMatrixStamp(Matrix<double>& oThroughVector);
+            // Conductance between two nodes, without changing m_dComponentSimulationMatrixStamp
+            static void stampConductance(SparseMatrix<double>& oSimulationMatrix, const size_t iNodeS, const size_t iNodeD, const double dConductance);
+            // Branch current flowing from iNodeS to iNodeD inside the component, and the branch row v(iNodeD) - v(iNodeS).
+            // The rest of the branch equation (right hand side, controlling terms) is stamped by the component.
+            static void stampBranch(SparseMatrix<double>& oSimulationMatrix, const size_t iNodeS, const size_t iNodeD, const size_t iBranch);
     };
 
     // AcrossReferenceNode = Circuit Ground
@@ -73,13 +140,13 @@ namespace SimulationEngine {
 
         public:
 
-            LinearCircuitSimComponent(const size_t iNodeList, const bool bHasGroundNode, const size_t iGroundNode) :
-                LinearNaturalSimComponent(iNodeList, bHasGroundNode, iGroundNode) { ; }
+            LinearCircuitSimComponent(std::initializer_list<size_t> oNodes, const bool bHasGroundNode, const size_t iGroundNode) :
+                LinearNaturalSimComponent(oNodes, bHasGroundNode, iGroundNode) { ; }
 
             bool hasGroundNode() const {
                 return hasAcrossReferenceNode();
             }
-            bool getGroundNode() const {
+            size_t getGroundNode() const {
                 return getAcrossReferenceNode();
             }
             double getCurrent() const { // Current going through component
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Component.h"
+#include <array>
+
+namespace SimulationEngine {
+
+    // Linear controlled source with an output port (iNodeS, iNodeD) and a control port (iControlNodeS, iControlNodeD).
+    // Both ports follow the (-), (+) order. The ports can share nodes, every distinct node is one component node.
+    class ControlledSource : public LinearCircuitSimComponent {
+
+        public:
+
+            ControlledSource(const size_t iNodeS, const size_t iNodeD, const size_t iControlNodeS, const size_t iControlNodeD, const double dGain, const size_t iNumBranches);
+            void setGain(const double dGain); // Takes effect on the next initalize
+
+            void LNS_initalize(SparseMatrix<double>& oSimulationMatrix, const double dTimeStep);
+            bool LNS_isDynamic() const;
+            void renumberNodes(const std::unordered_map<size_t, size_t>& oNodeIndices);
+
+        protected:
+
+            size_t m_iNodeS;
+            size_t m_iNodeD;
+            size_t m_iControlNodeS;
+            size_t m_iControlNodeD;
+            double m_dGain;
+
+        private:
+
+            void updateTerminalNodes();
+
+            std::array<size_t, 4> m_oTerminalNodeIndices; // S, D, control S, control D -> component node index
+    };
+
+    // v(D) - v(S) = A * (v(CD) - v(CS)), the output current is a branch unknown
+    class VoltageControlledVoltageSource : public ControlledSource {
+
+        public:
+
+            VoltageControlledVoltageSource(const size_t iNodeS, const size_t iNodeD, const size_t iControlNodeS, const size_t iControlNodeD, const double dGain);
+
+            void LNS_postStep(Matrix<double>& oAcrossVector);
+            void applySimulationMatrixStamp(SparseMatrix<double>& oSimulationMatrix, const double dTimeStep);
+    };
+
+    // i = G * (v(CD) - v(CS)), no branch unknowns
+    class VoltageControlledCurrentSource : public ControlledSource {
+
+        public:
+
+            VoltageControlledCurrentSource(const size_t iNodeS, const size_t iNodeD, const size_t iControlNodeS, const size_t iControlNodeD, const double dTransconductance);
+
+            void LNS_postStep(Matrix<double>& oAcrossVector);
+            void applySimulationMatrixStamp(SparseMatrix<double>& oSimulationMatrix, const double dTimeStep);
+    };
+
+    // i = B * ic, ic flows from CS to CD through a zero volt sense branch between the control nodes
+    class CurrentControlledCurrentSource : public ControlledSource {
+
+        public:
+
+            CurrentControlledCurrentSource(const size_t iNodeS, const size_t iNodeD, const size_t iControlNodeS, const size_t iControlNodeD, const double dGain);
+
+            void LNS_postStep(Matrix<double>& oAcrossVector);
+            void applySimulationMatrixStamp(SparseMatrix<double>& oSimulationMatrix, const double dTimeStep);
+    };
+
+    // v(D) - v(S) = R * ic, ic flows from CS to CD through a zero volt sense branch between the control nodes
+    class CurrentControlledVoltageSource : public ControlledSource {
+
+        public:
+
+            CurrentControlledVoltageSource(const size_t iNodeS, const size_t iNodeD, const size_t iControlNodeS, const size_t iControlNodeD, const double dTransresistance);
+
+            void LNS_postStep(Matrix<double>& oAcrossVector);
+            void applySimulationMatrixStamp(SparseMatrix<double>& oSimulationMatrix, const double dTimeStep);
+    };
+
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Component.h"
+#include "SourceWaveform.h"
+
+namespace SimulationEngine {
+
+    // Ideal current source, only stamps the through vector
+    class CurrentSource : public LinearCircuitSimComponent {
+
+        public:
+
+            CurrentSource(const size_t iNodeS, const size_t iNodeD, const double dCurrent); // Current flows from iNodeS to iNodeD inside the source
+            void setCurrent(const double dCurrent); // Takes effect on the next initalize
+            void setCurrentWaveform(std::shared_ptr<const SourceWaveform> pWaveform); // Replaces the constant current, takes effect on the next initalize
+
+            void LNS_initalize(SparseMatrix<double>& oSimulationMatrix, const double dTimeStep);
+            void LNS_step(Matrix<double>& oThroughVector, const double dTime);
+            void LNS_postStep(Matrix<double>& oAcrossVector);
+            bool LNS_isDynamic() const;
+            void LNS_initalizeDC(SparseMatrix<double>& oSimulationMatrix);
+            void LNS_stepDC(Matrix<double>& oThroughVector);
+            void renumberNodes(const std::unordered_map<size_t, size_t>& oNodeIndices);
+            void applyThroughVectorMatrixStamp(Matrix<double>& oThroughVector);
+
+        private:
+
+            size_t m_iNodeS;
+            size_t m_iNodeD;
+            SourceValue m_oCurrent;
+    };
+
+}
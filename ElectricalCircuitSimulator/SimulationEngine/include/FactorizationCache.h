@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+
+// Least recently used cache of factorizations keyed by (topology hash, time step). Variable step simulations switch
+// between a few step sizes (h, h/2, 2h), each of those simulation matrices is only factored once while it stays cached.
+// Time steps are compared exactly, which works for step sizes that are derived by halving and doubling.
+
+namespace SimulationEngine {
+
+    template<class T>
+    class FactorizationCache final {
+
+        public:
+
+            static constexpr size_t DEFAULT_CAPACITY = 8;
+
+            #pragma region Constructors
+
+            FactorizationCache(const size_t iCapacity = DEFAULT_CAPACITY) :
+                m_iCapacity(iCapacity),
+                m_iNumHits(0),
+                m_iNumMisses(0) { ; }
+
+            #pragma endregion
+
+            #pragma region Observers
+
+            size_t getCapacity() const {
+                return m_iCapacity;
+            }
+
+            size_t getSize() const {
+                return m_oEntries.size();
+            }
+
+            size_t getNumHits() const {
+                return m_iNumHits;
+            }
+
+            size_t getNumMisses() const {
+                return m_iNumMisses;
+            }
+
+            #pragma endregion
+
+            #pragma region Modifiers
+
+            // 0 disables the cache
+            void setCapacity(const size_t iCapacity) {
+                m_iCapacity = iCapacity;
+                while (m_oEntries.size() > m_iCapacity) {
+                    m_oEntries.pop_back();
+                }
+            }
+
+            void clear() {
+                m_oEntries.clear();
+            }
+
+            // Copies the cached factorization into oFactorization, returns false if there is none
+            bool find(const std::uint64_t iTopologyHash, const double dTimeStep, T& oFactorization) {
+                typename std::list<Entry>::iterator oEntry = findEntry(iTopologyHash, dTimeStep);
+
+                if (oEntry == m_oEntries.end()) {
+                    m_iNumMisses++;
+                    return false;
+                }
+
+                m_oEntries.splice(m_oEntries.begin(), m_oEntries, oEntry); // Most recently used goes first
+                oFactorization = m_oEntries.front().m_oFactorization;
+                m_iNumHits++;
+
+                return true;
+            }
+
+            // Stores a copy of oFactorization, the least recently used entry is dropped once the cache is full
+            void insert(const std::uint64_t iTopologyHash, const double dTimeStep, const T& oFactorization) {
+                typename std::list<Entry>::iterator oEntry = findEntry(iTopologyHash, dTimeStep);
+
+                if (m_iCapacity == 0) {
+                    return;
+                }
+                if (oEntry != m_oEntries.end()) {
+                    m_oEntries.splice(m_oEntries.begin(), m_oEntries, oEntry); // Already cached, the factors are the same
+                    return;
+                }
+                if (m_oEntries.size() == m_iCapacity) {
+                    m_oEntries.pop_back();
+                }
+                m_oEntries.push_front(Entry{ iTopologyHash, dTimeStep, oFactorization });
+            }
+
+            #pragma endregion
+
+        private:
+
+            struct Entry {
+                std::uint64_t m_iTopologyHash;
+                double m_dTimeStep;
+                T m_oFactorization;
+            };
+
+            #pragma region Private Observers
+
+            typename std::list<Entry>::iterator findEntry(const std::uint64_t iTopologyHash, const double dTimeStep) {
+                typename std::list<Entry>::iterator oEntry;
+
+                for (oEntry = m_oEntries.begin(); oEntry != m_oEntries.end(); ++oEntry) {
+                    if (oEntry->m_iTopologyHash == iTopologyHash && oEntry->m_dTimeStep == dTimeStep) {
+                        break;
+                    }
+                }
+
+                return oEntry;
+            }
+
+            #pragma endregion
+
+            #pragma region Members
+
+            size_t m_iCapacity;
+            size_t m_iNumHits;
+            size_t m_iNumMisses;
+            std::list<Entry> m_oEntries; // Most recently used first
+
+            #pragma endregion
+    };
+
+}
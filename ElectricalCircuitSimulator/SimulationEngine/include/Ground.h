@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Component.h"
+
+namespace SimulationEngine {
+
+    // Marks a node as the circuit ground (across reference node), for circuits without a grounded voltage source
+    class Ground : public LinearCircuitSimComponent {
+
+        public:
+
+            Ground(const size_t iNode);
+
+            bool LNS_isDynamic() const;
+    };
+
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Component.h"
+#include "SourceWaveform.h"
 
 namespace SimulationEngine {
 
@@ -8,19 +9,26 @@ namespace SimulationEngine {
 
         public:
 
-            GroundedVoltageSource(const size_t iNodeS, const size_t iNodeD, const double dVoltage, const double dResistance); // iNodeS is assumed to be ground
+            GroundedVoltageSource(const size_t iNodeS, const size_t iNodeD, const double dVoltage, const double dResistance); // iNodeS (-) is the across reference node of its island
+            void setVoltage(const double dVoltage); // Takes effect on the next initalize
+            void setVoltageWaveform(std::shared_ptr<const SourceWaveform> pWaveform); // Replaces the constant voltage, takes effect on the next initalize
+            void setResistance(const double dResistance); // Takes effect on the next initalize
 
-            void LNS_initalize(Matrix<double>& oConductanceMatrix, const double dTimeStep);
-            void LNS_step(Matrix<double>& oSourceVector);
+            void LNS_initalize(SparseMatrix<double>& oConductanceMatrix, const double dTimeStep);
+            void LNS_step(Matrix<double>& oSourceVector, const double dTime);
             void LNS_postStep(Matrix<double>& oVoltageMatrix);
-            void applySimulationMatrixStamp(Matrix<double>& oConductanceMatrix, const double dTimeStep);
+            bool LNS_isDynamic() const;
+            void LNS_initalizeDC(SparseMatrix<double>& oConductanceMatrix);
+            void LNS_stepDC(Matrix<double>& oSourceVector);
+            void renumberNodes(const std::unordered_map<size_t, size_t>& oNodeIndices);
+            void applySimulationMatrixStamp(SparseMatrix<double>& oConductanceMatrix, const double dTimeStep);
             void applyThroughVectorMatrixStamp(Matrix<double>& oSourceVector);
 
         private:
 
             size_t m_iNodeS;
             size_t m_iNodeD;
-            double m_dVoltage;
+            SourceValue m_oVoltage;
             double m_dResistance;
     };
 
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// Read only memory map of a whole file. The contents are paged in by the OS on first access, so large files can be
+// parsed in place without copying them into a buffer first. Works on Windows (file mapping) and POSIX (mmap).
+
+namespace SimulationEngine {
+
+    class MappedFile final {
+
+        public:
+
+            #pragma region Constructors
+
+            MappedFile(const std::string& sPath);
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+            ~MappedFile();
+
+            #pragma endregion
+
+            #pragma region Observers
+
+            const char* getData() const; // nullptr for empty files
+            size_t getSize() const;
+            std::string_view getText() const;
+            const std::string& getPath() const;
+
+            #pragma endregion
+
+        private:
+
+            #pragma region Members
+
+            std::string m_sPath;
+            const char* m_pData;
+            size_t m_iSize;
+#ifdef _WIN32
+            void* m_hFile;
+            void* m_hMapping;
+#else
+            int m_iFileDescriptor;
+#endif
+
+            #pragma endregion
+    };
+
+}
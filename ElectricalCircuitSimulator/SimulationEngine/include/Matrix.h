@@ -1,9 +1,14 @@
 #pragma once
 
+#include <algorithm>
 #include <complex>
 #include <memory>
+#include <new>
+#include <span>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <utility>
 
 namespace SimulationEngine {
 
@@ -16,41 +21,43 @@ namespace SimulationEngine {
         requires std::is_arithmetic_v<typename T::value_type>;
     };
 
+    // Dense row-major matrix stored in a single contiguous buffer aligned for SIMD loads. operator() is bounds checked
+    // for API users, the hot kernels use data()/getRow()/uncheckedAt() instead.
     template<Numeric T>
     class Matrix final {
 
         public:
 
+            static constexpr size_t ALIGNMENT = 64; // Bytes, one cache line and one AVX-512 register
+
             #pragma region Constructors and Destructors
 
             Matrix(const size_t iNumRows = 1, const size_t iNumColumns = 1) :
                 m_iNumRows(iNumRows),
                 m_iNumColumns(iNumColumns),
-                m_pData(std::make_unique< std::unique_ptr<T[]>[]>(m_iNumRows))
+                m_pData(nullptr)
             {
-                size_t iRowIndex;
-
                 if (iNumRows == 0 || iNumColumns == 0)
                     throw std::invalid_argument("Matrix dimensions must be positive and non-zero!");
 
-                for (iRowIndex = 0; iRowIndex < m_iNumRows; ++iRowIndex)
-                    m_pData[iRowIndex] = make_unique<T[]>(m_iNumColumns);
+                m_pData = allocate(m_iNumRows * m_iNumColumns);
+                std::uninitialized_fill_n(m_pData.get(), m_iNumRows * m_iNumColumns, T{});
             }
 
             Matrix(const Matrix& oOriginal) :
-                Matrix(oOriginal.m_iNumRows, oOriginal.m_iNumColumns)
+                m_iNumRows(oOriginal.m_iNumRows),
+                m_iNumColumns(oOriginal.m_iNumColumns),
+                m_pData(allocate(oOriginal.m_iNumRows * oOriginal.m_iNumColumns))
             {
-                size_t iRowIndex;
-                size_t iColumnIndex;
-
-                for (iRowIndex = 0; iRowIndex < m_iNumRows; ++iRowIndex) {
-                    for (iColumnIndex = 0; iColumnIndex < m_iNumColumns; ++iColumnIndex) {
-                        m_pData[iRowIndex][iColumnIndex] = oOriginal.m_pData[iRowIndex][iColumnIndex];
-                    }
-                }
+                std::uninitialized_copy_n(oOriginal.m_pData.get(), m_iNumRows * m_iNumColumns, m_pData.get());
             }
 
-            Matrix(Matrix&&) = default;
+            // The source is left empty (0 x 0, no buffer), so a later copy into it always allocates
+            Matrix(Matrix&& oOriginal) noexcept :
+                m_iNumRows(std::exchange(oOriginal.m_iNumRows, 0)),
+                m_iNumColumns(std::exchange(oOriginal.m_iNumColumns, 0)),
+                m_pData(std::move(oOriginal.m_pData)) { ; }
+
             ~Matrix() = default;
 
             #pragma endregion
@@ -60,24 +67,18 @@ namespace SimulationEngine {
             void swapRows(const size_t iRow1, const size_t iRow2) {
                 checkBounds(iRow1, 0);
                 checkBounds(iRow2, 0);
-                std::swap(m_pData[iRow1], m_pData[iRow2]);
+                if (iRow1 != iRow2)
+                    std::swap_ranges(getRowPointer(iRow1), getRowPointer(iRow1) + m_iNumColumns, getRowPointer(iRow2));
             }
 
             void swapValues(const size_t iRow1, const size_t iColumn1, const size_t iRow2, const size_t iColumn2) {
                 checkBounds(iRow1, iColumn1);
                 checkBounds(iRow2, iColumn2);
-                std::swap(m_pData[iRow1][iColumn1], m_pData[iRow2][iColumn2]);
+                std::swap(uncheckedAt(iRow1, iColumn1), uncheckedAt(iRow2, iColumn2));
             }
 
             void clear() {
-                size_t iRowIndex;
-                size_t iColumnIndex;
-
-                for (iRowIndex = 0; iRowIndex < m_iNumRows; ++iRowIndex) {
-                    for (iColumnIndex = 0; iColumnIndex < m_iNumColumns; ++iColumnIndex) {
-                        m_pData[iRowIndex][iColumnIndex] = T{};
-                    }
-                }
+                std::fill(m_pData.get(), m_pData.get() + m_iNumRows * m_iNumColumns, T{});
             }
 
             std::string getMatrixString() const {
@@ -88,7 +89,7 @@ namespace SimulationEngine {
                 for (iRowIndex = 0; iRowIndex < m_iNumRows; ++iRowIndex) {
                     stream << '[';
                     for (iColumnIndex = 0; iColumnIndex < m_iNumColumns; ++iColumnIndex) {
-                        stream << '\t' << m_pData[iRowIndex][iColumnIndex];
+                        stream << '\t' << uncheckedAt(iRowIndex, iColumnIndex);
                     }
                     stream << "\t]\n";
                 }
@@ -109,6 +110,50 @@ namespace SimulationEngine {
                 return m_iNumColumns;
             }
 
+            size_t getStride() const { // Elements between the starts of consecutive rows
+                return m_iNumColumns;
+            }
+
+            T* data() {
+                return m_pData.get();
+            }
+
+            const T* data() const {
+                return m_pData.get();
+            }
+
+            std::span<T> getRow(const size_t iRow) {
+                checkBounds(iRow, 0);
+                return std::span<T>(getRowPointer(iRow), m_iNumColumns);
+            }
+
+            std::span<const T> getRow(const size_t iRow) const {
+                checkBounds(iRow, 0);
+                return std::span<const T>(getRowPointer(iRow), m_iNumColumns);
+            }
+
+            #pragma endregion
+
+            #pragma region Unchecked Accessors
+
+            // No bounds checking, for inner loops that have already validated their ranges
+
+            inline T& uncheckedAt(const size_t iRow, const size_t iColumn = 0) {
+                return m_pData[iRow * m_iNumColumns + iColumn];
+            }
+
+            inline const T& uncheckedAt(const size_t iRow, const size_t iColumn = 0) const {
+                return m_pData[iRow * m_iNumColumns + iColumn];
+            }
+
+            inline T* getRowPointer(const size_t iRow) {
+                return m_pData.get() + iRow * m_iNumColumns;
+            }
+
+            inline const T* getRowPointer(const size_t iRow) const {
+                return m_pData.get() + iRow * m_iNumColumns;
+            }
+
             #pragma endregion
 
             #pragma region Operators
@@ -117,27 +162,30 @@ namespace SimulationEngine {
 
             T& operator()(const size_t iRow = 0, const size_t iColumn = 0) {
                 checkBounds(iRow, iColumn);
-                return m_pData[iRow][iColumn];
+                return uncheckedAt(iRow, iColumn);
             }
 
             Matrix& operator=(const Matrix& oOriginal) {
-                size_t iRowIndex;
-                size_t iColumnIndex;
-                std::unique_ptr<T[]> pRow;
-                m_iNumRows(oOriginal.m_iNumRows);
-                m_iNumColumns(oOriginal.m_iNumColumns);
-                m_pData(std::make_unique< std::unique_ptr<std::unique_ptr<T[]>[]>>(m_iNumRows));
-
-                for (iRowIndex = 0; iRowIndex < m_iNumRows; ++iRowIndex) {
-                    pRow = make_unique<T[]>(m_iNumColumns);
-                    for (iColumnIndex = 0; iColumnIndex < m_iNumColumns; ++iColumnIndex) {
-                        pRow[iColumnIndex] = oOriginal.m_pData[iRowIndex][iColumnIndex];
-                    }
-                    m_pData[iRowIndex] = pRow;
+                if (this != &oOriginal) {
+                    if (m_pData == nullptr || m_iNumRows * m_iNumColumns != oOriginal.m_iNumRows * oOriginal.m_iNumColumns)
+                        m_pData = allocate(oOriginal.m_iNumRows * oOriginal.m_iNumColumns);
+                    m_iNumRows = oOriginal.m_iNumRows;
+                    m_iNumColumns = oOriginal.m_iNumColumns;
+                    std::copy(oOriginal.m_pData.get(), oOriginal.m_pData.get() + m_iNumRows * m_iNumColumns, m_pData.get());
                 }
+
+                return *this;
             }
 
-            Matrix& operator=(Matrix&&) = default;
+            Matrix& operator=(Matrix&& oOriginal) noexcept {
+                if (this != &oOriginal) {
+                    m_iNumRows = std::exchange(oOriginal.m_iNumRows, 0);
+                    m_iNumColumns = std::exchange(oOriginal.m_iNumColumns, 0);
+                    m_pData = std::move(oOriginal.m_pData);
+                }
+
+                return *this;
+            }
 
             #pragma endregion
 
@@ -145,7 +193,7 @@ namespace SimulationEngine {
 
             const T& operator()(const size_t iRow = 0, const size_t iColumn = 0) const {
                 checkBounds(iRow, iColumn);
-                return m_pData[iRow][iColumn];
+                return uncheckedAt(iRow, iColumn);
             }
 
             #pragma endregion
@@ -154,15 +202,25 @@ namespace SimulationEngine {
 
         private:
 
+            struct AlignedDeleter {
+                void operator()(T* pData) const {
+                    ::operator delete[](pData, std::align_val_t{ ALIGNMENT });
+                }
+            };
+
             #pragma region Members
 
             size_t m_iNumRows;
             size_t m_iNumColumns;
-            std::unique_ptr<std::unique_ptr<T[]>[]> m_pData; // Outer pointer is rows, inner pointer is columns
+            std::unique_ptr<T[], AlignedDeleter> m_pData; // Row-major, row i starts at i * m_iNumColumns
 
             #pragma endregion
 
-            #pragma region Observers
+            #pragma region Functions
+
+            static std::unique_ptr<T[], AlignedDeleter> allocate(const size_t iNumElements) {
+                return std::unique_ptr<T[], AlignedDeleter>(static_cast<T*>(::operator new[](iNumElements * sizeof(T), std::align_val_t{ ALIGNMENT })));
+            }
 
             inline void checkBounds(size_t iRow, size_t iColumn) const {
                 if (iRow >= m_iNumRows || iColumn >= m_iNumColumns) {
@@ -173,4 +231,4 @@ namespace SimulationEngine {
             #pragma endregion
     };
 
-}
\ No newline at end of file
+}
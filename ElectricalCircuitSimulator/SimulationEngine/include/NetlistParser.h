@@ -0,0 +1,58 @@
+#pragma once
+
+#include "CircuitDescription.h"
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// Parser for the circuit text files in Circuits/:
+//     <Title line>
+//     Resistor(NodeS, NodeD, R)                        One component per line, any number of them
+//     Capacitor(NodeS, NodeD, C)
+//     Inductor(NodeS, NodeD, L)
+//     GroundedVoltageSource(NodeS, NodeD, V, R)
+//     ScopeV(Node)
+//     ScopeI(ComponentIndex)
+//     TimeStep(dt)
+//     StopTime(t)
+// Spaces and tabs are allowed between tokens, a line may end with ';', blank lines are skipped and both LF and CRLF
+// line endings work.
+// The text is parsed in place in a single pass (no line or token copies), files are memory mapped.
+
+namespace SimulationEngine {
+
+    // Location of the first error, lines and columns start at 1
+    class NetlistParseError final : public std::invalid_argument {
+
+        public:
+
+            NetlistParseError(const std::string& sMessage, const size_t iLine, const size_t iColumn);
+
+            size_t getLine() const;
+            size_t getColumn() const;
+
+        private:
+
+            size_t m_iLine;
+            size_t m_iColumn;
+    };
+
+    struct Netlist {
+        std::string sTitle;
+        CircuitDescription oCircuit;
+        size_t iVoltageScopeNode;
+        size_t iCurrentScopeComponent;
+        double dTimeStep;
+        double dStopTime;
+    };
+
+    namespace NetlistParser {
+
+        // Both throw NetlistParseError with the line and column of the first problem in the text,
+        // parseFile throws the MappedFile error if the file can't be opened or mapped
+        Netlist parse(const std::string_view sText);
+        Netlist parseFile(const std::string& sPath);
+
+    }
+
+}
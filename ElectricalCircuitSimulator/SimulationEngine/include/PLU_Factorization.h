@@ -1,12 +1,28 @@
 #pragma once
 
 #include "Matrix.h"
+#include "SimdKernels.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <vector>
 
 namespace SimulationEngine {
 
+    enum class PivotingPolicy {
+        Full, // Largest entry of the whole trailing submatrix, most stable, O(n^3) comparisons
+        Partial, // Largest entry of the pivot column, rows only
+        Threshold // Keep the diagonal if it is at least the threshold fraction of the largest column entry, otherwise partial
+    };
+
     // Represents a matrix factored into P*A*Q = L*U, where P = Row Permutation Matrix,
     // and Q = Column Permutation Matrix
+    // Partial and threshold pivoting use a right-looking blocked factorization (panel factorization, block row solve,
+    // then a cache-tiled trailing update). Full pivoting records its column pivots in Q without moving any columns,
+    // and P*A*Q is only gathered into L and U once at the end.
+    // refactor() reuses P and Q (the pivot search) for a matrix that only has new values.
+    // A pivot at or below dSINGULAR_PIVOT_TOLERANCE times the largest entry of its column of A means the matrix is singular
+    // and throws. The test is per column, so nodes only connected through very small conductances still factor.
     template<Numeric T>
     class PLU_Factorization final {
 
@@ -14,14 +30,44 @@ namespace SimulationEngine {
 
             #pragma region Constructors and Destructors
 
-            PLU_Factorization(const Matrix<T>& oA = Matrix<T>{}) :
+            // Nothing is factored until a matrix is assigned or passed to refactor()
+            PLU_Factorization() :
+                m_ePivotingPolicy(PivotingPolicy::Full),
+                m_dPivotThreshold(0.1) { ; }
+
+            PLU_Factorization(const Matrix<T>& oA, const PivotingPolicy ePivotingPolicy = PivotingPolicy::Full, const double dPivotThreshold = 0.1) :
+                m_ePivotingPolicy(ePivotingPolicy),
+                m_dPivotThreshold(dPivotThreshold),
                 m_oA(oA),
                 m_oL(m_oA.getNumRows(), m_oA.getNumRows()),
                 m_oU(m_oA),
                 m_oP(m_oA.getNumRows(), 1),
                 m_oQ(m_oA.getNumRows(), 1)
             {
-              runPLU_Factorization();
+                if (m_oA.getNumRows() != m_oA.getNumColumns())
+                    throw std::invalid_argument("Matrix to factor must be square!");
+
+                runPLU_Factorization();
+            }
+
+            #pragma endregion
+
+            #pragma region Modifiers
+
+            // Factor a matrix with new values using the cached pivot order. Falls back to a full pivot search if
+            // the size changed or a reused pivot has become too small.
+            void refactor(const Matrix<T>& oA) {
+                if (oA.getNumRows() != oA.getNumColumns())
+                    throw std::invalid_argument("Matrix to factor must be square!");
+
+                m_oA = oA;
+                if (m_oA.getNumRows() != m_oP.getNumRows() || runFixedPivotFactorization() == false) {
+                    m_oL = Matrix<T>(m_oA.getNumRows(), m_oA.getNumRows());
+                    m_oU = m_oA;
+                    m_oP = Matrix<size_t>(m_oA.getNumRows(), 1);
+                    m_oQ = Matrix<size_t>(m_oA.getNumRows(), 1);
+                    runPLU_Factorization();
+                }
             }
 
             #pragma endregion
@@ -44,59 +90,117 @@ namespace SimulationEngine {
                 return m_oQ;
             }
 
+            PivotingPolicy getPivotingPolicy() const {
+                return m_ePivotingPolicy;
+            }
+
             Matrix<T> solve(const Matrix<T>& oB) const {
-                static const T uEPSILON = 1e-9;
+                Matrix<T> oWorkspace(oB.getNumRows());
+                Matrix<T> oSolution(oB.getNumRows());
+
+                solveInto(oB, oSolution, oWorkspace);
+
+                return oSolution;
+            }
 
-                size_t iNumRows = oB.getNumRows();
+            // Allocation free solve, oSolution and oWorkspace must be preallocated column vectors of the matrix size.
+            // oB and oSolution must not be the same object.
+            void solveInto(const Matrix<T>& oB, Matrix<T>& oSolution, Matrix<T>& oWorkspace) const {
+                size_t iNumRows = m_oP.getNumRows();
+
+                if (oB.getNumRows() != iNumRows || oSolution.getNumRows() != iNumRows || oWorkspace.getNumRows() != iNumRows) {
+                    throw std::invalid_argument("Vector dimensions do not match the factored matrix!");
+                }
+
+                solveInto(oB.data(), oSolution.data(), oWorkspace.data());
+
+#ifdef MATRIX_PRINT
+                std::cout << "X Vector:" << std::endl;
+                std::cout << oWorkspace.getMatrixString();
+#endif
+            }
+
+            // Unchecked solve on raw vectors, only the first n entries of each are used, so longer vectors can be passed
+            void solveInto(const T* pB, T* pSolution, T* pWorkspace) const {
+                size_t iNumRows = m_oP.getNumRows();
                 size_t iRowIndex1;
-                size_t iRowIndex2;
-                T uDiagonal;
-                Matrix<T> oX(iNumRows);
-                Matrix<T> oY(iNumRows);
-                Matrix<T> oB_Permuted(iNumRows);
-                Matrix<T> oSolution(iNumRows);
+                T uValue;
+                const T* pRow;
 
-                // Apply row permutations to B to get B_Permuted
+                // Forward substitution to solve LY = B_Permuted, applying the row permutations to B on the fly
                 for (iRowIndex1 = 0; iRowIndex1 < iNumRows; ++iRowIndex1) {
-                    oB_Permuted(iRowIndex1) = oB(m_oP(iRowIndex1));
+                    pWorkspace[iRowIndex1] = pB[m_oP.uncheckedAt(iRowIndex1)] - SimdKernels::dotProduct(m_oL.getRowPointer(iRowIndex1), pWorkspace, iRowIndex1);
+                }
+
+                // Backward substitution to solve UX = Y, X overwrites Y in the workspace
+                for (iRowIndex1 = iNumRows; iRowIndex1-- > 0;) {
+                    pRow = m_oU.getRowPointer(iRowIndex1);
+                    uValue = pWorkspace[iRowIndex1] - SimdKernels::dotProduct(pRow + iRowIndex1 + 1, pWorkspace + iRowIndex1 + 1, iNumRows - iRowIndex1 - 1);
+
+                    pWorkspace[iRowIndex1] = uValue / pRow[iRowIndex1];
                 }
 
+                // Apply column permutations to X using Q to get Solution
+                for (iRowIndex1 = 0; iRowIndex1 < iNumRows; ++iRowIndex1) {
+                    pSolution[m_oQ.uncheckedAt(iRowIndex1)] = pWorkspace[iRowIndex1];
+                }
+            }
+
+            // Solve for all K columns of an n x K right hand side at once. Rows are contiguous, so every substitution step is
+            // one vectorized row update across all K columns instead of K separate dot products.
+            // oSolution and oWorkspace must be preallocated n x K matrices, oB and oSolution must not be the same object.
+            void solveBlockInto(const Matrix<T>& oB, Matrix<T>& oSolution, Matrix<T>& oWorkspace) const {
+                size_t iNumRows = m_oP.getNumRows();
+                size_t iNumColumns = oB.getNumColumns();
+
+                if (oB.getNumRows() != iNumRows || oSolution.getNumRows() != iNumRows || oWorkspace.getNumRows() != iNumRows ||
+                    oSolution.getNumColumns() != iNumColumns || oWorkspace.getNumColumns() != iNumColumns) {
+                    throw std::invalid_argument("Vector dimensions do not match the factored matrix!");
+                }
+
+                solveBlockInto(oB.data(), oSolution.data(), oWorkspace.data(), iNumColumns);
+            }
+
+            // Unchecked block solve on raw row major blocks with iNumColumns columns, only the first n rows of each are used
+            void solveBlockInto(const T* pB, T* pSolution, T* pWorkspace, const size_t iNumColumns) const {
+                size_t iNumRows = m_oP.getNumRows();
+                size_t iRowIndex1;
+                size_t iRowIndex2;
+                size_t iColumnIndex;
+                T uDiagonal;
+                const T* pRow;
+                T* pWorkspaceRow;
+
                 // Forward substitution to solve LY = B_Permuted
                 for (iRowIndex1 = 0; iRowIndex1 < iNumRows; ++iRowIndex1) {
-                    oY(iRowIndex1) = oB_Permuted(iRowIndex1);
+                    pWorkspaceRow = pWorkspace + iRowIndex1 * iNumColumns;
+                    std::copy_n(pB + m_oP.uncheckedAt(iRowIndex1) * iNumColumns, iNumColumns, pWorkspaceRow);
+                    pRow = m_oL.getRowPointer(iRowIndex1);
                     for (iRowIndex2 = 0; iRowIndex2 < iRowIndex1; ++iRowIndex2) {
-                        oY(iRowIndex1) -= m_oL(iRowIndex1, iRowIndex2)* oY(iRowIndex2);
+                        if (pRow[iRowIndex2] != T{})
+                            SimdKernels::subtractScaled(pWorkspaceRow, pWorkspace + iRowIndex2 * iNumColumns, pRow[iRowIndex2], iNumColumns);
                     }
                 }
 
-                // Backward substitution to solve UX = Y
-                for (iRowIndex1 = iNumRows - 1; iRowIndex1-->0;) {
-                    oX(iRowIndex1) = oY(iRowIndex1);
+                // Backward substitution to solve UX = Y, X overwrites Y in the workspace
+                for (iRowIndex1 = iNumRows; iRowIndex1-- > 0;) {
+                    pWorkspaceRow = pWorkspace + iRowIndex1 * iNumColumns;
+                    pRow = m_oU.getRowPointer(iRowIndex1);
                     for (iRowIndex2 = iRowIndex1 + 1; iRowIndex2 < iNumRows; ++iRowIndex2) {
-                        oX(iRowIndex1) -= m_oU(iRowIndex1, iRowIndex2) * oX(iRowIndex2);
+                        if (pRow[iRowIndex2] != T{})
+                            SimdKernels::subtractScaled(pWorkspaceRow, pWorkspace + iRowIndex2 * iNumColumns, pRow[iRowIndex2], iNumColumns);
                     }
 
-                    uDiagonal = m_oU(iRowIndex1, iRowIndex1);
-                    // If a diagonal on the U matrix is 0, it's due to the ground node being included in the matrix,
-                    // and is effectively infinity, resulting in X = 0 for this row.
-                    oX(iRowIndex1) = (uDiagonal > uEPSILON) || (uDiagonal < -uEPSILON) ? oX(iRowIndex1) / uDiagonal : T{};
+                    uDiagonal = pRow[iRowIndex1];
+                    for (iColumnIndex = 0; iColumnIndex < iNumColumns; ++iColumnIndex) {
+                        pWorkspaceRow[iColumnIndex] /= uDiagonal;
+                    }
                 }
 
                 // Apply column permutations to X using Q to get Solution
                 for (iRowIndex1 = 0; iRowIndex1 < iNumRows; ++iRowIndex1) {
-                    oSolution(m_oQ(iRowIndex1)) = oX(iRowIndex1);
+                    std::copy_n(pWorkspace + iRowIndex1 * iNumColumns, iNumColumns, pSolution + m_oQ.uncheckedAt(iRowIndex1) * iNumColumns);
                 }
-
-#ifdef MATRIX_PRINT
-                std::cout << "X Vector:" << std::endl;
-                std::cout << oX.getMatrixString();
-                std::cout << "Y Vector:" << std::endl;
-                std::cout << oY.getMatrixString();
-                std::cout << "B Permuted Vector:" << std::endl;
-                std::cout << oB_Permuted.getMatrixString();
-#endif
-
-                return oSolution;
             }
 
             #pragma endregion
@@ -105,76 +209,270 @@ namespace SimulationEngine {
 
             #pragma region Members
 
+            static constexpr double dSINGULAR_PIVOT_TOLERANCE = 1e-14; // Relative to the largest entry of the pivot's column
+            static constexpr double dPIVOT_TOLERANCE = 0.001; // A reused pivot must be at least this fraction of the largest entry below it
+            static constexpr size_t BLOCK_SIZE = 64; // Panel width of the blocked factorization
+            static constexpr size_t TILE_COLUMNS = 256; // Trailing update column tile, keeps BLOCK_SIZE x TILE_COLUMNS of U in cache
+
+            PivotingPolicy m_ePivotingPolicy;
+            double m_dPivotThreshold;
             Matrix<T> m_oA; //Matrix to decompose
             Matrix<T> m_oL; //Lower triangular matrix
             Matrix<T> m_oU; //Upper triangular matrix
             Matrix<size_t> m_oP; //Row permuation matrix
             Matrix<size_t> m_oQ; //Column permutation matrix
+            std::vector<double> m_oSingularPivots; // Per column of A, pivots at or below this magnitude mean the matrix is singular
 
             #pragma endregion
 
             #pragma region Functions
 
+            // m_oU holds a copy of A on entry
             void runPLU_Factorization() {
+                size_t iNumRows = m_oA.getNumRows();
+                size_t iRowIndex;
+
+                for (iRowIndex = 0; iRowIndex < iNumRows; ++iRowIndex) {
+                    m_oP.uncheckedAt(iRowIndex) = m_oQ.uncheckedAt(iRowIndex) = iRowIndex;
+                }
+                updateSingularPivots();
+
+                if (m_ePivotingPolicy == PivotingPolicy::Full) {
+                    runFullPivotFactorization();
+                } else {
+                    runBlockedFactorization(false);
+                }
+            }
+
+            // Unblocked right-looking elimination with a full pivot search. Rows are swapped (contiguous), columns are not:
+            // oColumnOrder maps pivot position to physical column and becomes Q. L and U are gathered from the working matrix at the end.
+            void runFullPivotFactorization() {
                 size_t iNumRows = m_oA.getNumRows();
                 size_t iRowIndex1;
                 size_t iRowIndex2;
                 size_t iRowIndex3;
                 size_t iMaxRow;
-                size_t imaxColumn;
-                T uAbsoluteValue;
-                T uMaxValue;
-
-                //Initialize L to an identity matrix
-                for (size_t iRowIndex1 = 0; iRowIndex1 < iNumRows; ++iRowIndex1) {
-                    m_oL(iRowIndex1, iRowIndex1) = 1;
-                }
+                size_t iMaxPosition;
+                size_t iPivotColumn;
+                double dAbsoluteValue;
+                double dMaxValue;
+                T uPivotValue;
+                T uMultiplier;
+                T* pRow;
+                const T* pPivotRow;
+                std::vector<size_t> oColumnOrder(iNumRows);
+                Matrix<T> oWork(m_oA);
 
                 for (iRowIndex1 = 0; iRowIndex1 < iNumRows; ++iRowIndex1) {
-                    m_oP(iRowIndex1, 0) = m_oQ(iRowIndex1, 0) = iRowIndex1;
+                    oColumnOrder[iRowIndex1] = iRowIndex1;
                 }
 
                 for (iRowIndex3 = 0; iRowIndex3 < iNumRows; ++iRowIndex3) {
-                    // Find the pivot (maximum element) in the submatrix U[iRowIndex3:iNumRows][iRowIndex3:iNumRows]
-                    uMaxValue = T{};
+                    // Find the pivot (maximum element) in the remaining rows and columns
+                    dMaxValue = 0;
                     iMaxRow = iRowIndex3;
-                    imaxColumn = iRowIndex3;
+                    iMaxPosition = iRowIndex3;
                     for (iRowIndex1 = iRowIndex3; iRowIndex1 < iNumRows; ++iRowIndex1) {
+                        pRow = oWork.getRowPointer(iRowIndex1);
                         for (iRowIndex2 = iRowIndex3; iRowIndex2 < iNumRows; ++iRowIndex2) {
-                            uAbsoluteValue = (m_oU(iRowIndex1, iRowIndex2) < 0) ? -m_oU(iRowIndex1, iRowIndex2) : m_oU(iRowIndex1, iRowIndex2);
-                            if (uAbsoluteValue > uMaxValue) {
-                                uMaxValue = uAbsoluteValue;
+                            dAbsoluteValue = std::abs(pRow[oColumnOrder[iRowIndex2]]);
+                            if (dAbsoluteValue > dMaxValue) {
+                                dMaxValue = dAbsoluteValue;
                                 iMaxRow = iRowIndex1;
-                                imaxColumn = iRowIndex2;
+                                iMaxPosition = iRowIndex2;
                             }
                         }
                     }
 
-                    // Swap rows in U to move the pivot to position (iRowIndex3, iRowIndex3)
-                    m_oU.swapRows(iRowIndex3, iMaxRow);
+                    if (dMaxValue <= m_oSingularPivots[oColumnOrder[iMaxPosition]])
+                        throwSingular();
+
+                    oWork.swapRows(iRowIndex3, iMaxRow);
                     m_oP.swapRows(iRowIndex3, iMaxRow);
+                    std::swap(oColumnOrder[iRowIndex3], oColumnOrder[iMaxPosition]);
 
-                    // Swap columns in U to move the pivot to position (iRowIndex3, iRowIndex3)
-                    for (iRowIndex1 = 0; iRowIndex1 < iNumRows; ++iRowIndex1) {
-                        m_oU.swapValues(iRowIndex1, iRowIndex3, iRowIndex1, imaxColumn);
+                    // Multipliers are stored in the pivot column of the working matrix
+                    iPivotColumn = oColumnOrder[iRowIndex3];
+                    pPivotRow = oWork.getRowPointer(iRowIndex3);
+                    uPivotValue = pPivotRow[iPivotColumn];
+                    for (iRowIndex1 = iRowIndex3 + 1; iRowIndex1 < iNumRows; ++iRowIndex1) {
+                        pRow = oWork.getRowPointer(iRowIndex1);
+                        uMultiplier = pRow[iPivotColumn] / uPivotValue;
+                        pRow[iPivotColumn] = uMultiplier;
+                        for (iRowIndex2 = iRowIndex3 + 1; iRowIndex2 < iNumRows; ++iRowIndex2) {
+                            pRow[oColumnOrder[iRowIndex2]] -= uMultiplier * pPivotRow[oColumnOrder[iRowIndex2]];
+                        }
                     }
+                }
 
-                    m_oQ.swapRows(iRowIndex3, imaxColumn);
+                // Gather P*A*Q into L and U
+                for (iRowIndex1 = 0; iRowIndex1 < iNumRows; ++iRowIndex1) {
+                    m_oQ.uncheckedAt(iRowIndex1) = oColumnOrder[iRowIndex1];
+                    pRow = oWork.getRowPointer(iRowIndex1);
+                    for (iRowIndex2 = 0; iRowIndex2 < iNumRows; ++iRowIndex2) {
+                        m_oL.uncheckedAt(iRowIndex1, iRowIndex2) = (iRowIndex2 < iRowIndex1) ? pRow[oColumnOrder[iRowIndex2]] : (iRowIndex2 == iRowIndex1) ? T{ 1 } : T{};
+                        m_oU.uncheckedAt(iRowIndex1, iRowIndex2) = (iRowIndex2 >= iRowIndex1) ? pRow[oColumnOrder[iRowIndex2]] : T{};
+                    }
+                }
+            }
 
-                    // Update L for the row swaps
-                    for (iRowIndex1 = 0; iRowIndex1 < iRowIndex3; ++iRowIndex1) {
-                        m_oL.swapValues(iRowIndex3, iRowIndex1, iMaxRow, iRowIndex1);
+            // Right-looking blocked factorization of m_oU in place, with L accumulated below the diagonal and split out at the end.
+            // With bFixedPivots the rows/columns are already in pivot order, no search is done and false is returned if a pivot
+            // fails the threshold test.
+            bool runBlockedFactorization(const bool bFixedPivots) {
+                size_t iNumRows = m_oU.getNumRows();
+                size_t iBlockStart;
+                size_t iBlockEnd;
+                size_t iTileStart;
+                size_t iTileEnd;
+                size_t iRowIndex1;
+                size_t iRowIndex2;
+                size_t iRowIndex3;
+                T uMultiplier;
+                T* pRow;
+                const T* pPivotRow;
+
+                for (iBlockStart = 0; iBlockStart < iNumRows; iBlockStart += BLOCK_SIZE) {
+                    iBlockEnd = std::min(iBlockStart + BLOCK_SIZE, iNumRows);
+
+                    // Panel factorization, only the panel's columns are updated
+                    for (iRowIndex3 = iBlockStart; iRowIndex3 < iBlockEnd; ++iRowIndex3) {
+                        if (selectRowPivot(iRowIndex3, bFixedPivots) == false)
+                            return false;
+
+                        pPivotRow = m_oU.getRowPointer(iRowIndex3);
+                        for (iRowIndex1 = iRowIndex3 + 1; iRowIndex1 < iNumRows; ++iRowIndex1) {
+                            pRow = m_oU.getRowPointer(iRowIndex1);
+                            uMultiplier = pRow[iRowIndex3] / pPivotRow[iRowIndex3];
+                            pRow[iRowIndex3] = uMultiplier;
+                            for (iRowIndex2 = iRowIndex3 + 1; iRowIndex2 < iBlockEnd; ++iRowIndex2) {
+                                pRow[iRowIndex2] -= uMultiplier * pPivotRow[iRowIndex2];
+                            }
+                        }
                     }
 
-                    // Compute multipliers and update U
-                    for (iRowIndex1 = iRowIndex3 + 1; iRowIndex1 < iNumRows; ++iRowIndex1) {
-                        m_oL(iRowIndex1, iRowIndex3) = m_oU(iRowIndex1, iRowIndex3) / m_oU(iRowIndex3, iRowIndex3);
-                        for (iRowIndex2 = iRowIndex3 + 1; iRowIndex2 < iNumRows; ++iRowIndex2) {
-                            m_oU(iRowIndex1, iRowIndex2) = m_oU(iRowIndex1, iRowIndex2) - m_oL(iRowIndex1, iRowIndex3) * m_oU(iRowIndex3, iRowIndex2);
+                    if (iBlockEnd == iNumRows)
+                        break;
+
+                    // Block row of U: solve L11 * U12 = A12
+                    for (iRowIndex3 = iBlockStart; iRowIndex3 < iBlockEnd; ++iRowIndex3) {
+                        pPivotRow = m_oU.getRowPointer(iRowIndex3);
+                        for (iRowIndex1 = iRowIndex3 + 1; iRowIndex1 < iBlockEnd; ++iRowIndex1) {
+                            pRow = m_oU.getRowPointer(iRowIndex1);
+                            uMultiplier = pRow[iRowIndex3];
+                            for (iRowIndex2 = iBlockEnd; iRowIndex2 < iNumRows; ++iRowIndex2) {
+                                pRow[iRowIndex2] -= uMultiplier * pPivotRow[iRowIndex2];
+                            }
+                        }
+                    }
+
+                    // Trailing update A22 -= L21 * U12, tiled over columns so the U12 tile stays in cache across all rows
+                    for (iTileStart = iBlockEnd; iTileStart < iNumRows; iTileStart += TILE_COLUMNS) {
+                        iTileEnd = std::min(iTileStart + TILE_COLUMNS, iNumRows);
+                        for (iRowIndex1 = iBlockEnd; iRowIndex1 < iNumRows; ++iRowIndex1) {
+                            pRow = m_oU.getRowPointer(iRowIndex1);
+                            for (iRowIndex3 = iBlockStart; iRowIndex3 < iBlockEnd; ++iRowIndex3) {
+                                uMultiplier = pRow[iRowIndex3];
+                                pPivotRow = m_oU.getRowPointer(iRowIndex3);
+                                for (iRowIndex2 = iTileStart; iRowIndex2 < iTileEnd; ++iRowIndex2) {
+                                    pRow[iRowIndex2] -= uMultiplier * pPivotRow[iRowIndex2];
+                                }
+                            }
                         }
-                        m_oU(iRowIndex1, iRowIndex3) = T{};
                     }
                 }
+
+                // Split the multipliers out into L
+                for (iRowIndex1 = 0; iRowIndex1 < iNumRows; ++iRowIndex1) {
+                    pRow = m_oU.getRowPointer(iRowIndex1);
+                    for (iRowIndex2 = 0; iRowIndex2 < iRowIndex1; ++iRowIndex2) {
+                        m_oL.uncheckedAt(iRowIndex1, iRowIndex2) = pRow[iRowIndex2];
+                        pRow[iRowIndex2] = T{};
+                    }
+                    m_oL.uncheckedAt(iRowIndex1, iRowIndex1) = T{ 1 };
+                    for (iRowIndex2 = iRowIndex1 + 1; iRowIndex2 < iNumRows; ++iRowIndex2) {
+                        m_oL.uncheckedAt(iRowIndex1, iRowIndex2) = T{};
+                    }
+                }
+
+                return true;
+            }
+
+            // Pick the pivot row for column iPivot among the rows below it and swap it into place (whole rows, so the
+            // multipliers already stored to the left move with it)
+            bool selectRowPivot(const size_t iPivot, const bool bFixedPivots) {
+                size_t iNumRows = m_oU.getNumRows();
+                size_t iRowIndex;
+                size_t iMaxRow = iPivot;
+                double dAbsoluteValue;
+                double dMaxValue = 0;
+                double dDiagonalValue = std::abs(m_oU.uncheckedAt(iPivot, iPivot));
+                double dSingularPivot = m_oSingularPivots[m_oQ.uncheckedAt(iPivot)];
+
+                for (iRowIndex = iPivot + 1; iRowIndex < iNumRows; ++iRowIndex) {
+                    dAbsoluteValue = std::abs(m_oU.uncheckedAt(iRowIndex, iPivot));
+                    if (dAbsoluteValue > dMaxValue) {
+                        dMaxValue = dAbsoluteValue;
+                        iMaxRow = iRowIndex;
+                    }
+                }
+
+                // A reused pivot that is too small falls back to a full pivot search, which throws if the matrix is singular
+                if (bFixedPivots)
+                    return (dDiagonalValue > dSingularPivot) && (dDiagonalValue >= dPIVOT_TOLERANCE * dMaxValue);
+
+                if (std::max(dDiagonalValue, dMaxValue) <= dSingularPivot)
+                    throwSingular();
+                if (dDiagonalValue >= dMaxValue)
+                    return true;
+                if (m_ePivotingPolicy == PivotingPolicy::Threshold && dDiagonalValue >= m_dPivotThreshold * dMaxValue && dDiagonalValue > dSingularPivot)
+                    return true;
+
+                m_oU.swapRows(iPivot, iMaxRow);
+                m_oP.swapRows(iPivot, iMaxRow);
+                return true;
+            }
+
+            // Gaussian elimination of P*A*Q with the current P and Q, no pivot search or swaps
+            bool runFixedPivotFactorization() {
+                size_t iNumRows = m_oA.getNumRows();
+                size_t iRowIndex1;
+                size_t iRowIndex2;
+                T* pURow;
+                const T* pARow;
+
+                for (iRowIndex1 = 0; iRowIndex1 < iNumRows; ++iRowIndex1) {
+                    pURow = m_oU.getRowPointer(iRowIndex1);
+                    pARow = m_oA.getRowPointer(m_oP.uncheckedAt(iRowIndex1));
+                    for (iRowIndex2 = 0; iRowIndex2 < iNumRows; ++iRowIndex2) {
+                        pURow[iRowIndex2] = pARow[m_oQ.uncheckedAt(iRowIndex2)];
+                    }
+                }
+                updateSingularPivots();
+
+                return runBlockedFactorization(true);
+            }
+
+            void updateSingularPivots() {
+                size_t iNumRows = m_oA.getNumRows();
+                size_t iRowIndex;
+                size_t iColumnIndex;
+                const T* pRow;
+
+                m_oSingularPivots.assign(iNumRows, 0);
+                for (iRowIndex = 0; iRowIndex < iNumRows; ++iRowIndex) {
+                    pRow = m_oA.getRowPointer(iRowIndex);
+                    for (iColumnIndex = 0; iColumnIndex < iNumRows; ++iColumnIndex) {
+                        m_oSingularPivots[iColumnIndex] = std::max<double>(m_oSingularPivots[iColumnIndex], std::abs(pRow[iColumnIndex]));
+                    }
+                }
+                for (double& dSingularPivot : m_oSingularPivots) {
+                    dSingularPivot *= dSINGULAR_PIVOT_TOLERANCE;
+                }
+            }
+
+            [[noreturn]] static void throwSingular() {
+                throw std::invalid_argument("Matrix to factor is singular!");
             }
 
             #pragma endregion
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "CircuitDescription.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Runs many independent simulations of one circuit with different component values (grid sweeps and Monte Carlo
+// tolerance analysis) on all cores. Every worker thread builds its own PartitionedCircuitSimulation once and only
+// changes component values between variants, so each variant is a numeric refactor plus the steps.
+// Variants are numbered grid point major: variant = iGridPoint * iNumSamples + iSample. Random values only depend on the
+// seed and the variant, so results do not depend on the number of threads (beyond rounding, a refactor reuses the
+// pivot order of the variant the thread ran before).
+
+namespace SimulationEngine {
+
+    enum class SweepDistribution {
+        Grid, // iNumPoints values evenly spaced from dA to dB
+        Uniform, // Between dA and dB
+        Normal // Mean dA, standard deviation dB
+    };
+
+    class ParameterSweep final {
+
+        public:
+
+            #pragma region Constructors
+
+            ParameterSweep(const CircuitDescription& oCircuit, const double dStopTime, const double dTimeStep);
+
+            #pragma endregion
+
+            #pragma region Observers
+
+            size_t getNumVariants() const;
+            size_t getNumProbes() const;
+            size_t getNumFailedVariants() const; // Variants that threw (e.g. a sampled value <= 0), their results are NaN
+            size_t getNumThreads() const;
+            double getParameterValue(const size_t iVariant, const size_t iParameterIndex) const;
+            // Probe values at the stop time, probes are numbered in the order added
+            double getResult(const size_t iVariant, const size_t iProbeIndex) const;
+            std::span<const double> getResults() const; // Variant major, getNumProbes() values per variant
+
+            #pragma endregion
+
+            #pragma region Modifiers
+
+            // All add functions return the index used by getParameterValue
+            size_t addGridParameter(const size_t iComponentIndex, const double dStart, const double dStop, const size_t iNumPoints);
+            size_t addUniformParameter(const size_t iComponentIndex, const double dMin, const double dMax);
+            size_t addNormalParameter(const size_t iComponentIndex, const double dMean, const double dStandardDeviation);
+
+            // All add functions return the index used by getResult
+            size_t addVoltageProbe(const size_t iNode);
+            size_t addCurrentProbe(const size_t iComponentIndex);
+
+            void setNumSamples(const size_t iNumSamples); // Random samples per grid point, 1 by default
+            void setSeed(const std::uint64_t iSeed);
+            void setNumThreads(const size_t iNumThreads); // 0 uses every hardware thread
+
+            void run();
+
+            #pragma endregion
+
+        private:
+
+            struct SweepParameter {
+                size_t iComponentIndex;
+                SweepDistribution eDistribution;
+                double dA;
+                double dB;
+                size_t iNumPoints;
+            };
+
+            struct SweepProbe {
+                bool bVoltage;
+                size_t iIndex; // Node or component index
+            };
+
+            #pragma region Private Modifiers
+
+            size_t addParameter(const SweepParameter& oParameter);
+            void runVariant(PartitionedCircuitSimulation& oSimulation, const size_t iVariant);
+
+            #pragma endregion
+
+            #pragma region Private Observers
+
+            size_t getNumGridPoints() const;
+            double sampleParameter(const size_t iVariant, const size_t iParameterIndex) const;
+
+            #pragma endregion
+
+            #pragma region Members
+
+            CircuitDescription m_oCircuit;
+            double m_dStopTime;
+            double m_dTimeStep;
+            size_t m_iNumSamples;
+            std::uint64_t m_iSeed;
+            size_t m_iNumThreads;
+            size_t m_iNumFailedVariants;
+            bool m_bHasRun;
+            std::vector<SweepParameter> m_oParameters;
+            std::vector<SweepProbe> m_oProbes;
+            std::vector<double> m_oParameterValues; // Variant major
+            std::vector<double> m_oResults; // Variant major
+            std::vector<unsigned char> m_oFailed; // One flag per variant, written by the worker that ran it
+
+            #pragma endregion
+    };
+
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "Matrix.h"
+#include "PLU_Factorization.h"
+#include "Simulation.h"
+#include "SparseLU_Factorization.h"
+#include "SparseMatrix.h"
+#include <unordered_map>
+#include <vector>
+
+// Linear circuit engine for the built in component types only. Components are not objects, every component kind is kept
+// as a structure of arrays (node indices, matrix stamps and history terms) and stepped in its own non-virtual loop.
+// The math matches the Resistor/Capacitor/Inductor/GroundedVoltageSource components, LinearCircuitSimulation<T> stays
+// the path for custom component types.
+
+namespace SimulationEngine {
+
+    enum class CircuitComponentKind {
+        Resistor,
+        Capacitor,
+        Inductor,
+        GroundedVoltageSource
+    };
+
+    class PartitionedCircuitSimulation final {
+
+        public:
+
+            #pragma region Constructors
+
+            PartitionedCircuitSimulation();
+
+            #pragma endregion
+
+            #pragma region Observers
+
+            double getTime() const;
+            size_t getNumComponents() const;
+            double getVoltage(const size_t iNode) const;
+            double getCurrent(const size_t iComponentIndex) const;
+            CircuitComponentKind getComponentKind(const size_t iComponentIndex) const;
+            MatrixSolverType getMatrixSolverType() const;
+
+            #pragma endregion
+
+            #pragma region Modifiers
+
+            // Storage for one component kind, components can always be added past it
+            void reserve(const CircuitComponentKind eKind, const size_t iNumComponents);
+            void reserveNodes(const size_t iNumNodes);
+
+            // All add functions return the component index, indices are shared between all kinds in the order added
+            size_t addResistor(const size_t iNodeS, const size_t iNodeD, const double dResistance);
+            size_t addCapacitor(const size_t iNodeS, const size_t iNodeD, const double dCapacitance);
+            size_t addInductor(const size_t iNodeS, const size_t iNodeD, const double dInductance);
+            size_t addGroundedVoltageSource(const size_t iNodeS, const size_t iNodeD, const double dVoltage, const double dResistance);
+
+            // Resistance, capacitance, inductance or source voltage depending on the kind. Takes effect on the next initalize.
+            void setComponentValue(const size_t iComponentIndex, const double dValue);
+
+            void setStopTime(const double dStopTime);
+            void setTimeStep(const double dTimeStep);
+            void setMatrixSolverType(const MatrixSolverType eMatrixSolverType);
+            void initalize();
+            bool step();
+
+            #pragma endregion
+
+        private:
+
+            // One component kind, every vector is indexed by the position of the component inside its group
+            struct ComponentGroup {
+                std::vector<size_t> m_oNodeS;
+                std::vector<size_t> m_oNodeD;
+                std::vector<double> m_oValue; // R, C, L or V
+                std::vector<double> m_oSourceResistance; // Voltage sources only
+                std::vector<double> m_oConductance; // Simulation matrix stamp
+                std::vector<double> m_oSource; // Through vector stamp
+                std::vector<double> m_oVoltageDelta; // v(t-1), reactive components only
+                std::vector<double> m_oThrough;
+
+                void reserve(const size_t iNumComponents);
+                void add(const size_t iNodeS, const size_t iNodeD, const double dValue);
+                size_t size() const;
+            };
+
+            #pragma region Private Modifiers
+
+            size_t addTwoTerminal(const CircuitComponentKind eKind, const size_t iNodeS, const size_t iNodeD, const double dValue);
+            size_t registerNode(const size_t iNode);
+            void stampGroup(ComponentGroup& oGroup);
+            void orderAcrossReferenceNodeLast();
+
+            #pragma endregion
+
+            #pragma region Private Observers
+
+            size_t getNodeIndex(const size_t iNode) const;
+            ComponentGroup& getGroup(const CircuitComponentKind eKind);
+            const ComponentGroup& getGroup(const CircuitComponentKind eKind) const;
+
+            #pragma endregion
+
+            #pragma region Members
+
+            static constexpr size_t SPARSE_SOLVER_NODE_THRESHOLD = 32;
+
+            double m_dStopTime;
+            double m_dTime;
+            double m_dTimeStep;
+            bool m_bInitSim;
+            bool m_bRunSim;
+            size_t m_iAcrossReferenceNode; // Dense index, the last node once initalized
+            bool m_bHasAcrossReferenceNode;
+            MatrixSolverType m_eMatrixSolverType;
+            bool m_bUseSparseSolver;
+            bool m_bReuseFactorization; // Topology is unchanged since the last factorization
+            ComponentGroup m_oResistors;
+            ComponentGroup m_oCapacitors;
+            ComponentGroup m_oInductors;
+            ComponentGroup m_oSources;
+            std::vector<CircuitComponentKind> m_oComponentKinds; // Component index -> kind
+            std::vector<size_t> m_oGroupIndices; // Component index -> position inside its group
+            std::unordered_map<size_t, size_t> m_oNodeIndices; // User node -> dense node index
+            SparseMatrix<double> m_oSimulationMatrix;
+            Matrix<double> m_oAcrossVector;
+            Matrix<double> m_oThroughVector;
+            Matrix<double> m_oThroughBaseline; // Source stamps, constant between initalize calls
+            Matrix<double> m_oSolveWorkspace;
+            PLU_Factorization<double> m_oPLU;
+            SparseLU_Factorization<double> m_oSparseLU;
+
+            #pragma endregion
+    };
+
+}
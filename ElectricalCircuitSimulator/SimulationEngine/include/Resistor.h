@@ -9,10 +9,13 @@ namespace SimulationEngine {
         public:
 
             Resistor(const size_t iNodeS, const size_t iNodeD, const double dResistance);
+            void setResistance(const double dResistance); // Takes effect on the next initalize
 
-            void LNS_initalize(Matrix<double>& oConductanceMatrix, const double dTimeStep);
+            void LNS_initalize(SparseMatrix<double>& oConductanceMatrix, const double dTimeStep);
             void LNS_postStep(Matrix<double>& oVoltageMatrix);
-            void applySimulationMatrixStamp(Matrix<double>& oConductanceMatrix, const double dTimeStep);
+            bool LNS_isDynamic() const;
+            void renumberNodes(const std::unordered_map<size_t, size_t>& oNodeIndices);
+            void applySimulationMatrixStamp(SparseMatrix<double>& oConductanceMatrix, const double dTimeStep);
 
         private:
 
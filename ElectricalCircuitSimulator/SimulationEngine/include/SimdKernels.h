@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Matrix.h"
+#include <type_traits>
+
+// Vectorized kernels for the per-step critical path (triangular solve dot products and row updates).
+// The widest instruction set supported by both the build and the running CPU is picked on first use.
+// Build flags:
+//     SIMD_DISABLE_AVX512 - never use the AVX-512 kernels
+//     SIMD_DISABLE_AVX2 - scalar kernels only (also disables AVX-512)
+
+namespace SimulationEngine {
+
+    enum class SimdLevel {
+        Scalar,
+        AVX2,
+        AVX512
+    };
+
+    namespace SimdKernels {
+
+        // Widest level supported by both this build and the CPU
+        SimdLevel getSupportedSimdLevel();
+
+        SimdLevel getSimdLevel();
+
+        // Select the kernels to use, mostly for comparing against the scalar reference. Levels above the supported
+        // level are clamped to it. Returns the level actually selected.
+        SimdLevel setSimdLevel(const SimdLevel eSimdLevel);
+
+        // Sum of pA[i] * pB[i] for i < iCount
+        double dotProduct(const double* pA, const double* pB, const size_t iCount);
+
+        // pValues[i] -= dScale * pOther[i] for i < iCount
+        void subtractScaled(double* pValues, const double* pOther, const double dScale, const size_t iCount);
+
+        // Scalar references, always available
+        double dotProductScalar(const double* pA, const double* pB, const size_t iCount);
+        void subtractScaledScalar(double* pValues, const double* pOther, const double dScale, const size_t iCount);
+
+        // Generic entry points used by the templated solvers, only double is vectorized
+        template<Numeric T>
+        inline T dotProduct(const T* pA, const T* pB, const size_t iCount) {
+            if constexpr (std::is_same_v<T, double>) {
+                return dotProduct(pA, pB, iCount);
+            } else {
+                size_t iIndex;
+                T uSum{};
+
+                for (iIndex = 0; iIndex < iCount; ++iIndex) {
+                    uSum += pA[iIndex] * pB[iIndex];
+                }
+
+                return uSum;
+            }
+        }
+
+        template<Numeric T>
+        inline void subtractScaled(T* pValues, const T* pOther, const T uScale, const size_t iCount) {
+            if constexpr (std::is_same_v<T, double>) {
+                subtractScaled(pValues, pOther, uScale, iCount);
+            } else {
+                size_t iIndex;
+
+                for (iIndex = 0; iIndex < iCount; ++iIndex) {
+                    pValues[iIndex] -= uScale * pOther[iIndex];
+                }
+            }
+        }
+
+    }
+
+}
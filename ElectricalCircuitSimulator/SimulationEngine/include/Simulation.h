@@ -1,12 +1,28 @@
 #pragma once
 
 #include "Component.h"
+#include "FactorizationCache.h"
 #include "PLU_Factorization.h"
 #include "Matrix.h"
+#include "SimdKernels.h"
+#include "SparseLU_Factorization.h"
+#include "SparseMatrix.h"
+#include "WaveformRecorder.h"
+#include <algorithm>
+#include <limits>
+#include <span>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace SimulationEngine {
 
+    enum class MatrixSolverType {
+        Auto, // Dense for small simulations, sparse once the node count reaches SPARSE_SOLVER_NODE_THRESHOLD
+        Dense,
+        Sparse
+    };
+
     #pragma region Concepts
 
     template<class T>
@@ -26,9 +42,10 @@ namespace SimulationEngine {
     };
 
     template<class T>
-    concept NodeSimComponentGeneral = requires(T t, const int iNodeIndex) {
+    concept NodeSimComponentGeneral = requires(T t, const int iNodeIndex, const std::unordered_map<size_t, size_t>& oNodeIndices) {
         { t.getNode(iNodeIndex) } -> std::same_as<size_t>;
         { t.getNumNodes() } -> std::same_as<size_t>;
+        { t.renumberNodes(oNodeIndices) } -> std::same_as<void>;
     };
 
     template<class T>
@@ -39,13 +56,13 @@ namespace SimulationEngine {
     };
 
     template<class T>
-    concept LinearNaturalSimComponentInitalize = requires(T t, Matrix<double>&oMatrix, const double dTimeStep) {
+    concept LinearNaturalSimComponentInitalize = requires(T t, SparseMatrix<double>&oMatrix, const double dTimeStep) {
         { t.LNS_initalize(oMatrix, dTimeStep) } -> std::same_as<void>;
     };
 
     template<class T>
-    concept LinearNaturalSimComponentStep = requires(T t, Matrix<double>&oMatrix, const double dTimeStep) {
-        { t.LNS_step(oMatrix) } -> std::same_as<void>;
+    concept LinearNaturalSimComponentStep = requires(T t, Matrix<double>&oMatrix, const double dTime) {
+        { t.LNS_step(oMatrix, dTime) } -> std::same_as<void>;
     };
 
     template<class T>
@@ -53,6 +70,36 @@ namespace SimulationEngine {
         { t.LNS_postStep(oMatrix) } -> std::same_as<void>;
     };
 
+    // Optional, components without it are restamped every step
+    template<class T>
+    concept LinearNaturalSimComponentDynamic = requires(const T t) {
+        { t.LNS_isDynamic() } -> std::same_as<bool>;
+    };
+
+    // Optional, needed for adaptive time stepping
+    template<class T>
+    concept LinearNaturalSimComponentAdaptive = requires(T t, SparseMatrix<double>& oMatrix, const double dValue) {
+        { t.LNS_restamp(oMatrix, dValue) } -> std::same_as<void>;
+        { t.LNS_getTruncationError(dValue, dValue) } -> std::same_as<double>;
+        { t.LNS_rejectStep() } -> std::same_as<void>;
+    };
+
+    // Optional, needed for the DC operating point
+    template<class T>
+    concept LinearNaturalSimComponentOperatingPoint = requires(T t, SparseMatrix<double>& oMatrix, Matrix<double>& oVector) {
+        { t.LNS_initalizeDC(oMatrix) } -> std::same_as<void>;
+        { t.LNS_stepDC(oVector) } -> std::same_as<void>;
+        { t.LNS_postStepDC(oVector) } -> std::same_as<void>;
+    };
+
+    // Optional, needed for components with branch unknowns (modified nodal analysis)
+    template<class T>
+    concept LinearNaturalSimComponentBranches = requires(T t, const size_t iIndex) {
+        { t.LNS_getNumBranches() } -> std::same_as<size_t>;
+        { t.LNS_getBranch(iIndex) } -> std::same_as<size_t>;
+        { t.LNS_setBranch(iIndex, iIndex) } -> std::same_as<void>;
+    };
+
     template<class T>
     concept LinearCircuitSimComponentGeneral = requires(T t) {
         { t.getCurrent() } -> std::same_as<double>;
@@ -71,20 +118,16 @@ namespace SimulationEngine {
 
             #pragma region Constructors
 
-            DiscreteEventTimeDomainSimulation(const size_t iNumComponents) :
-                m_iMaxComponentCount(iNumComponents),
+            // iNumComponents only reserves storage, components can always be added past it
+            DiscreteEventTimeDomainSimulation(const size_t iNumComponents = 0) :
                 m_iComponentCount(0),
                 m_dStopTime(0),
                 m_dTime(0),
                 m_dTimeStep(0),
                 m_bInitSim(false),
-                m_bRunSim(false),
-                m_pComponents(std::make_unique<std::unique_ptr<T>[]>(m_iMaxComponentCount))
+                m_bRunSim(false)
             {
-                if (iNumComponents <= 0) {
-                    std::cout << "Simulation must have a positive and non-zero number of components!" << std::endl;
-                    throw std::exception("Simulation must have a positive and non-zero number of components!");
-                }
+                m_oComponents.reserve(iNumComponents);
             }
 
             #pragma endregion
@@ -95,26 +138,58 @@ namespace SimulationEngine {
                 return m_dTime;
             }
 
+            size_t getNumComponents() const {
+                return m_iComponentCount;
+            }
+
+            double getTimeStep() const {
+                return m_dTimeStep;
+            }
+
+            // Components can be edited in place (e.g. new values for a parameter sweep), initalize has to be run again afterwards
+            T& getComponent(const size_t iComponentIndex) {
+                if (iComponentIndex >= m_iComponentCount) {
+                    std::cout << "Requested component does not exist!" << std::endl;
+                    throw std::invalid_argument("Requested component does not exist!");
+                }
+
+                m_bInitSim = false;
+                m_bRunSim = false;
+
+                return *m_oComponents[iComponentIndex];
+            }
+
             #pragma endregion
 
             #pragma region Public Modifiers
 
-            virtual size_t addComponent(std::unique_ptr<T> pComponent) {
-                if (m_iComponentCount == m_iMaxComponentCount) {
-                    std::cout << "Simulation is already full of components!" << std::endl;
-                    throw std::exception("Simulation is already full of components!");
-                }
+            void reserve(const size_t iNumComponents) {
+                m_oComponents.reserve(iNumComponents);
+            }
 
+            virtual size_t addComponent(std::unique_ptr<T> pComponent) {
                 // We are changing the simulation
                 m_bInitSim = false;
                 m_bRunSim = false;
 
-                m_pComponents[m_iComponentCount] = move(pComponent);
+                m_oComponents.push_back(std::move(pComponent));
                 m_iComponentCount++;
 
                 return m_iComponentCount - 1; // Index of added component
             };
 
+            // Moves every component out of oComponents, storage is grown once. Returns the index of the first added component.
+            size_t addComponents(std::span<std::unique_ptr<T>> oComponents) {
+                size_t iFirstIndex = m_iComponentCount;
+
+                m_oComponents.reserve(m_iComponentCount + oComponents.size());
+                for (std::unique_ptr<T>& pComponent : oComponents) {
+                    addComponent(std::move(pComponent));
+                }
+
+                return iFirstIndex;
+            }
+
             void setStopTime(const double dStopTime) {
                 if (dStopTime <= 0) {
                     std::cout << "Stop time must be greater than 0!" << std::endl;
@@ -148,7 +223,7 @@ namespace SimulationEngine {
 
                 if (bInitComponents) {
                     for (iIterator = 0; iIterator < m_iComponentCount; iIterator++) {
-                        m_pComponents[iIterator]->DETDS_initalize(m_dTimeStep);
+                        m_oComponents[iIterator]->DETDS_initalize(m_dTimeStep);
                     }
                 }
             }
@@ -160,7 +235,7 @@ namespace SimulationEngine {
 
                 // Run all component step functions
                 for (iIterator = 0; iIterator < m_iComponentCount; iIterator++) {
-                    m_pComponents[iIterator]->DETDS_step();
+                    m_oComponents[iIterator]->DETDS_step();
                 }
 
                 return stepEnd();
@@ -184,7 +259,11 @@ namespace SimulationEngine {
             }
 
             virtual bool stepEnd() {
-                m_dTime += m_dTimeStep; // Update simulation runtime
+                return stepEnd(m_dTimeStep);
+            }
+
+            bool stepEnd(const double dTimeStep) {
+                m_dTime += dTimeStep; // Update simulation runtime
                 m_bRunSim = true; // Simulation has been run at least 1 time step
 
                 if (m_dTime >= m_dStopTime)
@@ -197,14 +276,13 @@ namespace SimulationEngine {
 
             #pragma region Members
 
-            size_t m_iMaxComponentCount;
             size_t m_iComponentCount;
             double m_dStopTime;
             double m_dTime;
             double m_dTimeStep;
             bool m_bInitSim;
             bool m_bRunSim;
-            std::unique_ptr<std::unique_ptr<T>[]> m_pComponents;
+            std::vector<std::unique_ptr<T>> m_oComponents;
 
             #pragma endregion
     };
@@ -220,59 +298,39 @@ namespace SimulationEngine {
 
             #pragma region Constructors
 
-            NodeSimulation(const size_t iNumComponents) :
+            NodeSimulation(const size_t iNumComponents = 0) :
                 DiscreteEventTimeDomainSimulation<T>(iNumComponents),
                 m_iMaxNode(0) { ; }
 
             #pragma endregion
 
+            #pragma region Observers
+
+            // Index of a user node in the simulation's node space
+            size_t getNodeIndex(const size_t iNode) const {
+                typename std::unordered_map<size_t, size_t>::const_iterator oFound = m_oNodeIndices.find(iNode);
+
+                if (oFound == m_oNodeIndices.end()) {
+                    std::cout << "Requested node does not exist!" << std::endl;
+                    throw std::invalid_argument("Requested node does not exist!");
+                }
+
+                return oFound->second;
+            }
+
+            #pragma endregion
+
             #pragma region Modifiers
 
             virtual size_t addComponent(std::unique_ptr<T> pComponent) {
-                size_t iComponentNodeIndex;
-                size_t iSimNodeIndex;
-                size_t iComponentNode;
-                bool bFoundNode;
+                size_t iComponentIndex = DiscreteEventTimeDomainSimulation<T>::addComponent(std::move(pComponent));
 
-                for (iComponentNodeIndex = 0; iComponentNodeIndex < pComponent->getNumNodes(); iComponentNodeIndex++) {
-                    bFoundNode = false;
-                    iComponentNode = pComponent->getNode(iComponentNodeIndex);
-                    for (iSimNodeIndex = 0; iSimNodeIndex < static_cast<int>(m_oNodeList.size()); iSimNodeIndex++) {
-                        if (iComponentNode == m_oNodeList[iSimNodeIndex]) {
-                            bFoundNode = true;
-                            break;
-                        }
-                    }
-                    if (!bFoundNode) {
-                        m_oNodeList.push_back(iComponentNode);
-                        if (iComponentNode > m_iMaxNode) {
-                            m_iMaxNode = iComponentNode;
-                        }
-                    }
-                }
-                return DiscreteEventTimeDomainSimulation<T>::addComponent(std::move(pComponent)); // Index of added component
+                registerNodes(*this->m_oComponents[iComponentIndex]);
+
+                return iComponentIndex; // Index of added component
             };
 
             virtual void initalize(bool bInitComponents) {
-                size_t iNode;
-                size_t iIterator;
-                bool bFoundIndex;
-
-                for (iNode = 0; iNode < m_oNodeList.size(); iNode++) {
-                    bFoundIndex = false;
-                    for (iIterator = 0; iIterator < m_oNodeList.size(); iIterator++) {
-                        if (m_oNodeList[iIterator] == iNode) {
-                            bFoundIndex = true;
-                            break;
-                        }
-                    }
-                    if (bFoundIndex == false) {
-                        std::cout << "Simulation nodes are not condensed into the smallest number possible!" << std::endl;
-                        throw std::exception("Simulation nodes are not condensed into the smallest number possible!");
-                        break;
-                    }
-                }
-
                 DiscreteEventTimeDomainSimulation<T>::initalize(bInitComponents);
             }
 
@@ -280,10 +338,60 @@ namespace SimulationEngine {
 
         protected:
 
+            #pragma region Protected Modifiers
+
+            // User node numbers can be sparse, each new node gets the next dense index (in order of first use) and
+            // the component is renumbered into that index space so it can stamp the simulation matrices directly
+            void registerNodes(T& oComponent) {
+                size_t iComponentNodeIndex;
+
+                for (iComponentNodeIndex = 0; iComponentNodeIndex < oComponent.getNumNodes(); iComponentNodeIndex++) {
+                    if (m_oNodeIndices.try_emplace(oComponent.getNode(iComponentNodeIndex), m_oNodeList.size()).second) {
+                        m_oNodeList.push_back(oComponent.getNode(iComponentNodeIndex));
+                    }
+                }
+                if (m_oNodeList.empty() == false) {
+                    m_iMaxNode = m_oNodeList.size() - 1;
+                }
+
+                oComponent.renumberNodes(m_oNodeIndices);
+            }
+
+            // Dense index without a user node, for unknowns that only a component knows about (e.g. a branch current)
+            size_t addInternalNode() {
+                m_oNodeList.push_back(INTERNAL_NODE);
+                m_iMaxNode = m_oNodeList.size() - 1;
+
+                return m_iMaxNode;
+            }
+
+            // Moves every node to a new dense index (old dense index -> new), the components are renumbered with it
+            virtual void permuteNodes(const std::unordered_map<size_t, size_t>& oNewIndices) {
+                size_t iNodeIndex;
+                size_t iComponentIndex;
+                std::vector<size_t> oNodeList(m_oNodeList.size());
+
+                for (iNodeIndex = 0; iNodeIndex < m_oNodeList.size(); iNodeIndex++) {
+                    oNodeList[oNewIndices.at(iNodeIndex)] = m_oNodeList[iNodeIndex];
+                }
+                m_oNodeList = std::move(oNodeList);
+                for (std::pair<const size_t, size_t>& oEntry : m_oNodeIndices) {
+                    oEntry.second = oNewIndices.at(oEntry.second);
+                }
+                for (iComponentIndex = 0; iComponentIndex < this->m_iComponentCount; iComponentIndex++) {
+                    this->m_oComponents[iComponentIndex]->renumberNodes(oNewIndices);
+                }
+            }
+
+            #pragma endregion
+
             #pragma region Members
 
-            size_t m_iMaxNode;
-            std::vector<size_t> m_oNodeList;
+            static constexpr size_t INTERNAL_NODE = static_cast<size_t>(-1); // Node list entry of an internal node
+
+            size_t m_iMaxNode; // Highest dense node index
+            std::vector<size_t> m_oNodeList; // Dense node index -> user node, INTERNAL_NODE for internal nodes
+            std::unordered_map<size_t, size_t> m_oNodeIndices; // User node -> dense node index
 
             #pragma endregion
     };
@@ -301,26 +409,41 @@ namespace SimulationEngine {
 
             #pragma region Constructors
 
-            LinearNaturalSimulation(const size_t iNumComponents) :
+            LinearNaturalSimulation(const size_t iNumComponents = 0) :
                 NodeSimulation<T>(iNumComponents),
-                m_iAcrossReferenceNode(0),
-                m_bHasAcrossReferenceNode(false) { ; }
+                m_bHasAcrossReferenceNode(false),
+                m_iNumSystemNodes(0),
+                m_eMatrixSolverType(MatrixSolverType::Auto),
+                m_ePivotingPolicy(PivotingPolicy::Full),
+                m_bUseSparseSolver(false),
+                m_bReuseFactorization(false),
+                m_bAdaptiveTimeStep(false),
+                m_bStartFromOperatingPoint(false),
+                m_dMinTimeStep(0),
+                m_dMaxTimeStep(0),
+                m_dRelativeTolerance(1e-3),
+                m_dAbsoluteTolerance(1e-6),
+                m_dCurrentTimeStep(0),
+                m_iNumRejectedSteps(0),
+                m_iStepsSinceTimeStepChange(0),
+                m_bCacheCurrentTimeStep(true),
+                m_iTopologyHash(0),
+                m_iRecordDecimation(1),
+                m_iStepsSinceRecord(0) { ; }
 
             #pragma endregion
 
             #pragma region Observers
 
             double getAcross(const size_t iNode) const {
-                if (iNode > this->m_iMaxNode) {
-                    std::cout << "Requested node does not exist!" << std::endl;
-                    throw std::invalid_argument("Requested node does not exist!");
-                }
+                size_t iNodeIndex = this->getNodeIndex(iNode);
+
                 if (this->m_bRunSim == false) {
                     std::cout << "Cannot read across values from a simulation that has not been simulated!" << std::endl;
                     throw std::exception("Cannot read across values from a simulation that has not been simulated!");
                 }
 
-                return m_oAcrossVector(iNode, 0);
+                return m_oAcrossVector(iNodeIndex, 0);
             }
 
             double getThrough(const size_t iComponentIndex) const {
@@ -333,25 +456,240 @@ namespace SimulationEngine {
                     throw std::exception("Cannot read through values from a simulation that has not been simulated!");
                 }
 
-                return this->m_pComponents[iComponentIndex]->getThrough();
+                return this->m_oComponents[iComponentIndex]->getThrough();
+            }
+
+            MatrixSolverType getMatrixSolverType() const {
+                return m_eMatrixSolverType;
+            }
+
+            PivotingPolicy getPivotingPolicy() const {
+                return m_ePivotingPolicy;
+            }
+
+            bool isAdaptiveTimeStep() const {
+                return m_bAdaptiveTimeStep;
+            }
+
+            bool isStartingFromOperatingPoint() const {
+                return m_bStartFromOperatingPoint;
+            }
+
+            // Electrically isolated parts of the circuit (nodes not connected through any component), each one is solved
+            // against its own across reference node
+            size_t getNumIslands() const {
+                size_t iNode;
+                size_t iNumIslands = 0;
+
+                for (iNode = 0; iNode < m_oIslandParents.size(); iNode++) {
+                    if (m_oIslandParents[iNode] == iNode) {
+                        iNumIslands++;
+                    }
+                }
+
+                return iNumIslands;
+            }
+
+            // Step used by the next step() call, equal to the time step unless adaptive time stepping is enabled
+            double getCurrentTimeStep() const {
+                return m_bAdaptiveTimeStep ? m_dCurrentTimeStep : this->m_dTimeStep;
+            }
+
+            size_t getNumRejectedSteps() const {
+                return m_iNumRejectedSteps;
+            }
+
+            // Step size changes that reused a cached factorization instead of refactoring
+            size_t getNumFactorizationCacheHits() const {
+                return m_oDenseFactorizationCache.getNumHits() + m_oSparseFactorizationCache.getNumHits();
+            }
+
+            WaveformRecorder* getRecorder() const {
+                return m_pRecorder.get();
+            }
+
+            // Values per run() row, the time and one value per probe
+            size_t getRunRowSize() const {
+                return m_oProbes.size() + 1;
+            }
+
+            // Steps left until the stop time, counted from 0 if the simulation has not been initalized. With adaptive
+            // time stepping this is an upper bound (every step at the minimum time step).
+            size_t getNumRemainingSteps() const {
+                double dTime = this->m_bInitSim ? this->m_dTime : 0;
+                size_t iNumSteps = 0;
+
+                if (this->m_dTimeStep <= 0) {
+                    return 0;
+                }
+                if (m_bAdaptiveTimeStep) {
+                    return dTime < this->m_dStopTime ? static_cast<size_t>((this->m_dStopTime - dTime) / m_dMinTimeStep) + 1 : 0;
+                }
+                // Same accumulation as stepEnd, so rounding cannot make the count off by one
+                while (dTime < this->m_dStopTime) {
+                    dTime += this->m_dTimeStep;
+                    iNumSteps++;
+                }
+
+                return iNumSteps;
             }
 
             #pragma endregion
 
             #pragma region Modifiers
 
+            // The time step set by setTimeStep becomes the first step. Steps are halved while the truncation error of a
+            // step is too large and doubled after a few steps with a small error, so only a few distinct step sizes are used.
+            void setAdaptiveTimeStep(const double dMinTimeStep, const double dMaxTimeStep) requires LinearNaturalSimComponentAdaptive<T> {
+                if (dMinTimeStep <= 0 || dMaxTimeStep < dMinTimeStep) {
+                    std::cout << "Adaptive time step bounds must be positive and the minimum cannot be larger than the maximum!" << std::endl;
+                    throw std::invalid_argument("Adaptive time step bounds must be positive and the minimum cannot be larger than the maximum!");
+                }
+                m_bAdaptiveTimeStep = true;
+                m_dMinTimeStep = dMinTimeStep;
+                m_dMaxTimeStep = dMaxTimeStep;
+                this->m_bInitSim = false;
+                this->m_bRunSim = false;
+            }
+
+            void setFixedTimeStep() {
+                m_bAdaptiveTimeStep = false;
+                this->m_bInitSim = false;
+                this->m_bRunSim = false;
+            }
+
+            // initalize seeds the component states with the DC operating point instead of starting from zero, so a
+            // transient starts settled
+            void setStartFromOperatingPoint(const bool bStartFromOperatingPoint) requires LinearNaturalSimComponentOperatingPoint<T> {
+                m_bStartFromOperatingPoint = bStartFromOperatingPoint;
+                this->m_bInitSim = false;
+                this->m_bRunSim = false;
+            }
+
+            // Solves the DC operating point once (capacitors open, inductors shorted), no time step or stop time is
+            // needed. The result is read with getAcross/getThrough, initalize has to be run before stepping.
+            void solveOperatingPoint() requires LinearNaturalSimComponentOperatingPoint<T> {
+                if (this->m_iComponentCount == 0) {
+                    std::cout << "There are no components in the Simulation!" << std::endl;
+                    throw std::exception("There are no components in the Simulation!");
+                }
+                if (m_bHasAcrossReferenceNode == false) {
+                    std::cout << "There is no across reference node in the simulation!" << std::endl;
+                    throw std::exception("There is no across reference node in the simulation!");
+                }
+                this->m_bInitSim = false;
+                this->m_bRunSim = false;
+
+                partitionIslands();
+                orderAcrossReferenceNodesLast();
+                m_oThroughVector = Matrix<double>(this->m_iMaxNode + 1, 1);
+                m_oAcrossVector = Matrix<double>(this->m_iMaxNode + 1, 1);
+                m_oSolveWorkspace = Matrix<double>(this->m_iMaxNode + 1, 1);
+                solveOperatingPointStep();
+
+                this->m_bRunSim = true;
+            }
+
+            // Number of factorizations kept for the step sizes used by adaptive time stepping, 0 disables the cache
+            void setFactorizationCacheCapacity(const size_t iCapacity) {
+                m_oDenseFactorizationCache.setCapacity(iCapacity);
+                m_oSparseFactorizationCache.setCapacity(iCapacity);
+            }
+
+            // A step is accepted if every component's error is below dRelativeTolerance * |state| + dAbsoluteTolerance
+            void setTruncationErrorTolerance(const double dRelativeTolerance, const double dAbsoluteTolerance) {
+                if (dRelativeTolerance < 0 || dAbsoluteTolerance <= 0) {
+                    std::cout << "Truncation error tolerances must be positive!" << std::endl;
+                    throw std::invalid_argument("Truncation error tolerances must be positive!");
+                }
+                m_dRelativeTolerance = dRelativeTolerance;
+                m_dAbsoluteTolerance = dAbsoluteTolerance;
+            }
+
+            void setMatrixSolverType(const MatrixSolverType eMatrixSolverType) {
+                m_eMatrixSolverType = eMatrixSolverType;
+                m_bReuseFactorization = false;
+                this->m_bInitSim = false; // Matrices have to be rebuilt
+                this->m_bRunSim = false;
+            }
+
+            // Pivoting used by the dense solver
+            void setPivotingPolicy(const PivotingPolicy ePivotingPolicy) {
+                m_ePivotingPolicy = ePivotingPolicy;
+                m_bReuseFactorization = false;
+                this->m_bInitSim = false;
+                this->m_bRunSim = false;
+            }
+
+            // Probes are recorded in the order added (channels V(node) and I(component)), they are checked on initalize
+            size_t addAcrossProbe(const size_t iNode) {
+                m_oProbes.push_back({ true, iNode });
+                this->m_bInitSim = false;
+                return m_oProbes.size() - 1;
+            }
+
+            size_t addThroughProbe(const size_t iComponentIndex) {
+                m_oProbes.push_back({ false, iComponentIndex });
+                this->m_bInitSim = false;
+                return m_oProbes.size() - 1;
+            }
+
+            void clearProbes() {
+                m_oProbes.clear();
+                this->m_bInitSim = false;
+            }
+
+            // Every initalize starts a recorder run that ends with the last step. Every iDecimation-th step and the last
+            // step are recorded. nullptr removes the recorder.
+            void setRecorder(std::unique_ptr<WaveformRecorder> pRecorder, const size_t iDecimation = 1) {
+                if (iDecimation == 0) {
+                    std::cout << "Record decimation must be at least 1!" << std::endl;
+                    throw std::invalid_argument("Record decimation must be at least 1!");
+                }
+                m_pRecorder = std::move(pRecorder);
+                m_iRecordDecimation = iDecimation;
+                this->m_bInitSim = false;
+            }
+
+            // Every island can have one across reference node. A component that would put a second one into an island
+            // (its own, or by connecting two islands that both have one) is rejected.
             size_t addComponent(std::unique_ptr<T> pComponent) {
-                if (pComponent->hasAcrossReferenceNode() == true) {
-                    if (m_bHasAcrossReferenceNode == true) {
-                        std::cout << "Simulation already has an across reference node, cannot add another one!" << std::endl;
-                        throw std::exception("Simulation already has an across reference node, cannot add another one!");
-                    } else {
-                        m_bHasAcrossReferenceNode = true;
-                        m_iAcrossReferenceNode = pComponent->getAcrossReferenceNode();
+                size_t iComponentIndex;
+                size_t iComponentNodeIndex;
+                size_t iIsland;
+                size_t iNumReferenceNodes = pComponent->hasAcrossReferenceNode() ? 1 : 0;
+                size_t iConflictNode = 0; // Component node in the island that would get the second reference node
+                std::vector<size_t> oIslands; // Existing islands the component connects
+                std::string sMessage;
+                typename std::unordered_map<size_t, size_t>::const_iterator oFound;
+
+                for (iComponentNodeIndex = 0; iComponentNodeIndex < pComponent->getNumNodes(); iComponentNodeIndex++) {
+                    oFound = this->m_oNodeIndices.find(pComponent->getNode(iComponentNodeIndex));
+                    if (oFound == this->m_oNodeIndices.end()) {
+                        continue; // New node, not in an island yet
+                    }
+                    iIsland = findIsland(oFound->second);
+                    if (std::find(oIslands.begin(), oIslands.end(), iIsland) == oIslands.end()) {
+                        oIslands.push_back(iIsland);
+                        if (m_oIslandReferenceNodes[iIsland] != NO_NODE && ++iNumReferenceNodes == 2) {
+                            iConflictNode = pComponent->getNode(iComponentNodeIndex);
+                        }
                     }
                 }
-                
-                return NodeSimulation<T>::addComponent(std::move(pComponent));
+                if (iNumReferenceNodes > 1) {
+                    sMessage = "The island containing node " + std::to_string(iConflictNode) + " already has an across reference node, cannot add another one!";
+                    std::cout << sMessage << std::endl;
+                    throw std::exception(sMessage.c_str());
+                }
+                m_bReuseFactorization = false; // Topology changed
+
+                iComponentIndex = NodeSimulation<T>::addComponent(std::move(pComponent));
+                if constexpr (LinearNaturalSimComponentBranches<T>) {
+                    addBranches(*this->m_oComponents[iComponentIndex]);
+                }
+                joinIslands(*this->m_oComponents[iComponentIndex]);
+
+                return iComponentIndex;
             };
 
             virtual void initalize(bool bInitComponents) {
@@ -363,21 +701,57 @@ namespace SimulationEngine {
                     std::cout << "There is no across reference node in the simulation!" << std::endl;
                     throw std::exception("There is no across reference node in the simulation!");
                 }
-
-                // Declare blank matrices.
-                m_oSimulationMatrix = Matrix<double>(this->m_iMaxNode + 1, this->m_iMaxNode + 1);
+                partitionIslands();
+                orderAcrossReferenceNodesLast();
+                if (m_bAdaptiveTimeStep && (this->m_dTimeStep < m_dMinTimeStep || this->m_dTimeStep > m_dMaxTimeStep)) {
+                    std::cout << "Time step must be within the adaptive time step bounds!" << std::endl;
+                    throw std::exception("Time step must be within the adaptive time step bounds!");
+                }
+                m_dCurrentTimeStep = this->m_dTimeStep;
+                m_iNumRejectedSteps = 0;
+                m_iStepsSinceTimeStepChange = 0;
+                m_bCacheCurrentTimeStep = true;
+                m_oDenseFactorizationCache.clear(); // Component values may have changed
+                m_oSparseFactorizationCache.clear();
+
+                // Declare blank matrices. With an unchanged topology the sparsity pattern is kept and only the values are restamped.
+                if (m_bReuseFactorization) {
+                    m_oSimulationMatrix.clear();
+                } else {
+                    m_oSimulationMatrix = SparseMatrix<double>(this->m_iMaxNode + 1, this->m_iMaxNode + 1);
+                }
                 m_oThroughVector = Matrix<double>(this->m_iMaxNode + 1, 1);
+                m_oThroughBaseline = Matrix<double>(this->m_iMaxNode + 1, 1);
                 m_oAcrossVector = Matrix<double>(this->m_iMaxNode + 1, 1);
+                m_oSolveWorkspace = Matrix<double>(this->m_iMaxNode + 1, 1);
 
                 // Build the simulation and initial through vector matrices
                 if (bInitComponents) {
                     for (iIterator = 0; iIterator < this->m_iComponentCount; iIterator++) {
-                        this->m_pComponents[iIterator]->LNS_initalize(m_oSimulationMatrix, this->m_dTimeStep);
+                        this->m_oComponents[iIterator]->LNS_initalize(m_oSimulationMatrix, this->m_dTimeStep);
+                    }
+                }
+                m_oSimulationMatrix.compress();
+
+                // Static components stamp the same through values every step, they are stamped once into the baseline
+                m_oDynamicComponents.clear();
+                for (iIterator = 0; iIterator < this->m_iComponentCount; iIterator++) {
+                    if (isDynamicComponent(*this->m_oComponents[iIterator])) {
+                        m_oDynamicComponents.push_back(iIterator);
+                    } else {
+                        this->m_oComponents[iIterator]->LNS_step(m_oThroughBaseline, 0); // Time invariant
                     }
                 }
 
-                // Factor the simulation matrix
-                m_oPLU = PLU_Factorization<double>(m_oSimulationMatrix);
+                factorSimulationMatrix();
+                if constexpr (LinearNaturalSimComponentOperatingPoint<T>) {
+                    if (m_bStartFromOperatingPoint) {
+                        solveOperatingPointStep();
+                        this->m_bRunSim = true; // Time zero values can be read
+                    }
+                }
+                resolveProbes();
+                beginRecording();
 
 #ifdef MATRIX_PRINT
                 // Print out the matrices
@@ -387,43 +761,97 @@ namespace SimulationEngine {
                 std::cout << m_oThroughVector.getMatrixString();
                 std::cout << "PLU Factorization Matrixes:" << std::endl;
                 std::cout << "L:" << std::endl;
-                std::cout << m_oPLU.getL().getMatrixString();
+                std::cout << (m_bUseSparseSolver ? m_oSparseLU.getL().getMatrixString() : m_oPLU.getL().getMatrixString());
                 std::cout << "P:" << std::endl;
-                std::cout << m_oPLU.getP().getMatrixString();
+                std::cout << (m_bUseSparseSolver ? m_oSparseLU.getP().getMatrixString() : m_oPLU.getP().getMatrixString());
                 std::cout << "Q:" << std::endl;
-                std::cout << m_oPLU.getQ().getMatrixString();
+                std::cout << (m_bUseSparseSolver ? m_oSparseLU.getQ().getMatrixString() : m_oPLU.getQ().getMatrixString());
                 std::cout << "U:" << std::endl;
-                std::cout << m_oPLU.getU().getMatrixString();
+                std::cout << (m_bUseSparseSolver ? m_oSparseLU.getU().getMatrixString() : m_oPLU.getU().getMatrixString());
 #endif
             }
 
             virtual bool step() {
-                size_t iIterator;
-                double dNormalizationFactor;
+                bool bDone;
 
                 DiscreteEventTimeDomainSimulation<T>::stepStart();
 
-                this->m_oThroughVector.clear(); // Is rebuilt every step
+                if (m_bAdaptiveTimeStep) {
+                    bDone = stepAdaptive();
+                } else {
+                    solveStep();
+                    bDone = DiscreteEventTimeDomainSimulation<T>::stepEnd();
+                }
+                recordStep(bDone);
 
-                // Run all component step functions
-                for (iIterator = 0; iIterator < this->m_iComponentCount; iIterator++) {
-                    this->m_pComponents[iIterator]->LNS_step(this->m_oThroughVector);
+                return bDone;
+            }
+
+            // Steps until the stop time and writes one row per step into oOutput: the time, then the probe values in the
+            // order the probes were added. The probes are checked once by initalize instead of on every read like
+            // getAcross/getThrough. Stops early once oOutput is full or iMaxSteps steps were taken, the next call
+            // continues the run. Returns the number of rows written, 0 once the stop time has been reached.
+            size_t run(std::span<double> oOutput, const size_t iMaxSteps = std::numeric_limits<size_t>::max()) {
+                size_t iRowSize = getRunRowSize();
+                size_t iMaxRows = std::min(oOutput.size() / iRowSize, iMaxSteps);
+                size_t iNumRows = 0;
+                double* pRow = oOutput.data();
+
+                if (this->m_bInitSim == false) {
+                    std::cout << "Simulation has not been initalized!" << std::endl;
+                    throw std::exception("Simulation has not been initalized!");
                 }
 
-                // Find the new across vector
-                this->m_oAcrossVector = m_oPLU.solve(this->m_oThroughVector);
+                while (iNumRows < iMaxRows && this->m_dTime < this->m_dStopTime) {
+                    step(); // Virtual, ensembles write the rows of instance 0
+                    pRow[0] = this->m_dTime;
+                    readProbes(pRow + 1);
+                    pRow += iRowSize;
+                    iNumRows++;
+                }
 
-                // Check to see if the across vector requires normalization
-                dNormalizationFactor = -m_oAcrossVector(m_iAcrossReferenceNode);
-                if (dNormalizationFactor != 0) {
-                    for (iIterator = 0; iIterator <= this->m_iMaxNode; iIterator++) {
-                        this->m_oAcrossVector(iIterator) = this->m_oAcrossVector(iIterator) + dNormalizationFactor;
-                    }
+                return iNumRows;
+            }
+
+            #pragma endregion
+
+        protected:
+
+            #pragma region Protected Observers
+
+            static bool isDynamicComponent(const T& oComponent) {
+                if constexpr (LinearNaturalSimComponentDynamic<T>) {
+                    return oComponent.LNS_isDynamic();
+                } else {
+                    return true;
+                }
+            }
+
+            #pragma endregion
+
+            #pragma region Protected Modifiers
+
+            // Stamp, solve and post-step one step with the current simulation matrix, the time is not advanced
+            void solveStep() {
+                size_t iIterator;
+                double dStepTime = this->m_dTime + getCurrentTimeStep(); // Same sum as stepEnd
+
+                // Start from the static stamps and only run the step functions of components with history state
+                std::copy_n(m_oThroughBaseline.data(), this->m_iMaxNode + 1, this->m_oThroughVector.data());
+                for (size_t iComponentIndex : m_oDynamicComponents) {
+                    this->m_oComponents[iComponentIndex]->LNS_step(this->m_oThroughVector, dStepTime);
+                }
+
+                // Find the new across vector, only the system nodes are solved and the reference nodes stay at 0
+                if (m_bUseSparseSolver) {
+                    m_oSparseLU.solveInto(this->m_oThroughVector.data(), this->m_oAcrossVector.data(), m_oSolveWorkspace.data());
+                } else {
+                    m_oPLU.solveInto(this->m_oThroughVector.data(), this->m_oAcrossVector.data(), m_oSolveWorkspace.data());
                 }
 
                 // Run all component post-step functions 
                 for (iIterator = 0; iIterator < this->m_iComponentCount; iIterator++) {
-                    this->m_pComponents[iIterator]->LNS_postStep(this->m_oAcrossVector);
+                    this->m_oComponents[iIterator]->LNS_postStep(this->m_oAcrossVector);
                 }
 
 #ifdef MATRIX_PRINT
@@ -432,65 +860,507 @@ namespace SimulationEngine {
                 std::cout << "Across Vector:" << std::endl;
                 std::cout << m_oAcrossVector.getMatrixString();
 #endif
-
-                return DiscreteEventTimeDomainSimulation<T>::stepEnd();
             }
 
-            #pragma endregion
-
-        protected:
-
-            #pragma region Members
+            bool stepAdaptive() {
+                size_t iIterator;
+                double dError = 0;
 
-            size_t m_iAcrossReferenceNode;
-            bool m_bHasAcrossReferenceNode;
-            Matrix<double> m_oSimulationMatrix;
-            Matrix<double> m_oAcrossVector;
-            Matrix<double> m_oThroughVector;
-            PLU_Factorization<double> m_oPLU;
+                if constexpr (LinearNaturalSimComponentAdaptive<T>) {
+                    // Land on the stop time instead of stepping past it. The shortened step is a one-off, so it is not cached
+                    // where it could evict a step size that is used again.
+                    if (this->m_dTime + m_dCurrentTimeStep > this->m_dStopTime && this->m_dStopTime - this->m_dTime >= m_dMinTimeStep) {
+                        changeTimeStep(this->m_dStopTime - this->m_dTime, false);
+                    }
 
-            #pragma endregion
-    };
+                    while (true) {
+                        solveStep();
 
-    template<class T>
-    requires DiscreteEventTimeDomainSimComponentGeneral<T> &&
-             NodeSimComponentGeneral<T> &&
-             LinearNaturalSimComponentGeneral <T> &&
-             LinearNaturalSimComponentInitalize <T> &&
-             LinearNaturalSimComponentStep <T> &&
-             LinearNaturalSimComponentPostStep <T> &&
-             LinearCircuitSimComponentGeneral<T>
-    class LinearCircuitSimulation : public LinearNaturalSimulation<T> {
+                        dError = 0;
+                        for (size_t iComponentIndex : m_oDynamicComponents) {
+                            dError = std::max(dError, this->m_oComponents[iComponentIndex]->LNS_getTruncationError(m_dRelativeTolerance, m_dAbsoluteTolerance));
+                        }
+                        if (dError <= 1 || m_dCurrentTimeStep / 2 < m_dMinTimeStep) {
+                            break; // Accepted, or already at the minimum step
+                        }
 
-        public:
+                        for (iIterator = 0; iIterator < this->m_iComponentCount; iIterator++) {
+                            this->m_oComponents[iIterator]->LNS_rejectStep();
+                        }
+                        m_iNumRejectedSteps++;
+                        changeTimeStep(m_dCurrentTimeStep / 2, m_bCacheCurrentTimeStep);
+                    }
+                }
 
-            LinearCircuitSimulation(const size_t iNumComponents) :
-                LinearNaturalSimulation<T>(iNumComponents) { ; }
+                if (DiscreteEventTimeDomainSimulation<T>::stepEnd(m_dCurrentTimeStep)) {
+                    return true;
+                }
 
-            virtual size_t addComponent(std::unique_ptr<T> pComponent) {
-                return LinearNaturalSimulation<T>::addComponent(std::move(pComponent));
-            };
+                // The error grows with h^3, so doubling is safe while it stays below 1/8 (with some margin)
+                m_iStepsSinceTimeStepChange++;
+                if (dError < dSTEP_GROWTH_ERROR && m_iStepsSinceTimeStepChange >= STEPS_BEFORE_GROWTH && m_dCurrentTimeStep * 2 <= m_dMaxTimeStep) {
+                    changeTimeStep(m_dCurrentTimeStep * 2);
+                }
 
-            void setStopTime(const double dStopTime) {
-                DiscreteEventTimeDomainSimulation<T>::setStopTime(dStopTime);
+                return false;
             }
 
-            double getTime() const {
-                return DiscreteEventTimeDomainSimulation<T>::getTime();
-            }
+            // Restamp the simulation matrix for a new step size, the component states are kept. The factorization of the
+            // old step size is cached (unless it was a one-off) and the new one is only computed if it is not cached yet.
+            void changeTimeStep(const double dTimeStep, const bool bCacheTimeStep = true) {
+                size_t iIterator;
+                bool bCached;
 
-            void setTimeStep(const double dTimeStep) {
-                DiscreteEventTimeDomainSimulation<T>::setTimeStep(dTimeStep);
-            }
+                if constexpr (LinearNaturalSimComponentAdaptive<T>) {
+                    if (m_bCacheCurrentTimeStep && m_bUseSparseSolver) {
+                        m_oSparseFactorizationCache.insert(m_iTopologyHash, m_dCurrentTimeStep, m_oSparseLU);
+                    } else if (m_bCacheCurrentTimeStep) {
+                        m_oDenseFactorizationCache.insert(m_iTopologyHash, m_dCurrentTimeStep, m_oPLU);
+                    }
+                    m_dCurrentTimeStep = dTimeStep;
+                    m_bCacheCurrentTimeStep = bCacheTimeStep;
+                    m_iStepsSinceTimeStepChange = 0;
 
-            double getVoltage(const size_t iNode) const {
-                return LinearNaturalSimulation<T>::getAcross(iNode);
+                    // Components keep their own copy of the stamp, so they are always restamped
+                    m_oSimulationMatrix.clear();
+                    for (iIterator = 0; iIterator < this->m_iComponentCount; iIterator++) {
+                        this->m_oComponents[iIterator]->LNS_restamp(m_oSimulationMatrix, dTimeStep);
+                    }
+                    m_oSimulationMatrix.compress();
+
+                    if (m_bUseSparseSolver) {
+                        bCached = m_oSparseFactorizationCache.find(m_iTopologyHash, dTimeStep, m_oSparseLU);
+                    } else {
+                        bCached = m_oDenseFactorizationCache.find(m_iTopologyHash, dTimeStep, m_oPLU);
+                    }
+                    if (bCached == false) {
+                        factorSimulationMatrix();
+                    }
+                }
+            }
+
+            // Stamps the DC equivalent circuit into its own matrix and solves it once, the components keep the DC state.
+            // The simulation matrix and its factorization are left alone.
+            void solveOperatingPointStep() requires LinearNaturalSimComponentOperatingPoint<T> {
+                size_t iIterator;
+                size_t iNumNodes = this->m_iMaxNode + 1;
+                SparseMatrix<double> oOperatingPointMatrix(iNumNodes, iNumNodes);
+                SparseMatrix<double> oSystemMatrix;
+
+                for (iIterator = 0; iIterator < this->m_iComponentCount; iIterator++) {
+                    this->m_oComponents[iIterator]->LNS_initalizeDC(oOperatingPointMatrix);
+                }
+                oOperatingPointMatrix.compress();
+
+                m_oThroughVector.clear();
+                for (iIterator = 0; iIterator < this->m_iComponentCount; iIterator++) {
+                    this->m_oComponents[iIterator]->LNS_stepDC(m_oThroughVector);
+                }
+
+                oSystemMatrix = oOperatingPointMatrix.getLeadingBlock(m_iNumSystemNodes);
+                if ((m_eMatrixSolverType == MatrixSolverType::Sparse) || (m_eMatrixSolverType == MatrixSolverType::Auto && m_iNumSystemNodes >= SPARSE_SOLVER_NODE_THRESHOLD)) {
+                    SparseLU_Factorization<double>(oSystemMatrix).solveInto(m_oThroughVector.data(), m_oAcrossVector.data(), m_oSolveWorkspace.data());
+                } else {
+                    PLU_Factorization<double>(oSystemMatrix.toDense(), m_ePivotingPolicy).solveInto(m_oThroughVector.data(), m_oAcrossVector.data(), m_oSolveWorkspace.data());
+                }
+
+                for (iIterator = 0; iIterator < this->m_iComponentCount; iIterator++) {
+                    this->m_oComponents[iIterator]->LNS_postStepDC(m_oAcrossVector);
+                }
+            }
+
+            // Checks the probes once so recording and run() can read them without checks
+            void resolveProbes() {
+                m_oProbeIndices.clear();
+                for (const RecordProbe& oProbe : m_oProbes) {
+                    if (oProbe.bAcross) {
+                        m_oProbeIndices.push_back(this->getNodeIndex(oProbe.iIndex));
+                    } else {
+                        if (oProbe.iIndex >= this->m_iComponentCount) {
+                            std::cout << "Requested component does not exist!" << std::endl;
+                            throw std::invalid_argument("Requested component does not exist!");
+                        }
+                        m_oProbeIndices.push_back(oProbe.iIndex);
+                    }
+                }
+                m_oProbeValues.assign(m_oProbes.size(), 0);
+            }
+
+            // Opens a recorder run, the probes have to be resolved
+            void beginRecording() {
+                std::vector<std::string> oChannelNames;
+
+                if (m_pRecorder == nullptr) {
+                    return;
+                }
+
+                for (const RecordProbe& oProbe : m_oProbes) {
+                    oChannelNames.push_back((oProbe.bAcross ? "V(" : "I(") + std::to_string(oProbe.iIndex) + ")");
+                }
+                m_iStepsSinceRecord = 0;
+                m_pRecorder->beginRun(oChannelNames);
+            }
+
+            void readProbes(double* pValues) const {
+                size_t iProbe;
+
+                for (iProbe = 0; iProbe < m_oProbes.size(); iProbe++) {
+                    pValues[iProbe] = m_oProbes[iProbe].bAcross ? m_oAcrossVector.uncheckedAt(m_oProbeIndices[iProbe]) :
+                                                                  this->m_oComponents[m_oProbeIndices[iProbe]]->getThrough();
+                }
+            }
+
+            void recordStep(const bool bDone) {
+                if (m_pRecorder == nullptr || m_pRecorder->isRecording() == false) {
+                    return;
+                }
+                m_iStepsSinceRecord++;
+                if (m_iStepsSinceRecord < m_iRecordDecimation && bDone == false) {
+                    return;
+                }
+                m_iStepsSinceRecord = 0;
+
+                readProbes(m_oProbeValues.data());
+                m_pRecorder->record(this->m_dTime, m_oProbeValues);
+                if (bDone) {
+                    m_pRecorder->endRun();
+                }
+            }
+
+            // Only the numeric part is redone if the topology has not changed since the last factorization
+            // The system matrix is the leading block of the simulation matrix, the reference nodes' rows and columns are left out
+            void factorSimulationMatrix() {
+                SparseMatrix<double> oSystemMatrix;
+
+                if (m_bReuseFactorization == false) {
+                    m_bUseSparseSolver = (m_eMatrixSolverType == MatrixSolverType::Sparse) ||
+                                         (m_eMatrixSolverType == MatrixSolverType::Auto && m_iNumSystemNodes >= SPARSE_SOLVER_NODE_THRESHOLD);
+                    m_iTopologyHash = m_oSimulationMatrix.getPatternHash();
+                }
+                oSystemMatrix = m_oSimulationMatrix.getLeadingBlock(m_iNumSystemNodes);
+                if (m_bUseSparseSolver) {
+                    if (m_bReuseFactorization) {
+                        m_oSparseLU.refactor(oSystemMatrix);
+                    } else {
+                        m_oSparseLU = SparseLU_Factorization<double>(oSystemMatrix);
+                    }
+                } else {
+                    if (m_bReuseFactorization) {
+                        m_oPLU.refactor(oSystemMatrix.toDense());
+                    } else {
+                        m_oPLU = PLU_Factorization<double>(oSystemMatrix.toDense(), m_ePivotingPolicy);
+                    }
+                }
+                m_bReuseFactorization = true;
+            }
+
+            // Union-find root of a node's island, paths are halved on the way up
+            size_t findIsland(size_t iNode) {
+                while (m_oIslandParents[iNode] != iNode) {
+                    m_oIslandParents[iNode] = m_oIslandParents[m_oIslandParents[iNode]];
+                    iNode = m_oIslandParents[iNode];
+                }
+
+                return iNode;
+            }
+
+            // Merges the islands of every node of a renumbered component, new nodes start as their own island
+            void joinIslands(const T& oComponent) {
+                size_t iComponentNodeIndex;
+                size_t iBranchIndex;
+                size_t iRoot;
+                size_t iIsland;
+
+                addIslandNodes();
+                if (oComponent.getNumNodes() == 0) {
+                    return;
+                }
+
+                iRoot = findIsland(oComponent.getNode(0));
+                for (iComponentNodeIndex = 1; iComponentNodeIndex < oComponent.getNumNodes(); iComponentNodeIndex++) {
+                    iIsland = findIsland(oComponent.getNode(iComponentNodeIndex));
+                    if (iIsland != iRoot) {
+                        m_oIslandParents[iIsland] = iRoot;
+                        if (m_oIslandReferenceNodes[iRoot] == NO_NODE) {
+                            m_oIslandReferenceNodes[iRoot] = m_oIslandReferenceNodes[iIsland];
+                        }
+                    }
+                }
+                if constexpr (LinearNaturalSimComponentBranches<T>) {
+                    for (iBranchIndex = 0; iBranchIndex < oComponent.LNS_getNumBranches(); iBranchIndex++) {
+                        m_oIslandParents[findIsland(oComponent.LNS_getBranch(iBranchIndex))] = iRoot; // New internal node, has no reference
+                    }
+                }
+                if (oComponent.hasAcrossReferenceNode()) {
+                    m_bHasAcrossReferenceNode = true;
+                    m_oIslandReferenceNodes[iRoot] = oComponent.getAcrossReferenceNode(); // Already renumbered
+                }
+            }
+
+            // Every branch unknown of the component gets an internal node, it is solved for like an across value
+            void addBranches(T& oComponent) requires LinearNaturalSimComponentBranches<T> {
+                size_t iBranchIndex;
+
+                for (iBranchIndex = 0; iBranchIndex < oComponent.LNS_getNumBranches(); iBranchIndex++) {
+                    oComponent.LNS_setBranch(iBranchIndex, this->addInternalNode());
+                }
+            }
+
+            // Nodes registered since the last call start as their own island
+            void addIslandNodes() {
+                while (m_oIslandParents.size() < this->m_oNodeList.size()) {
+                    m_oIslandParents.push_back(m_oIslandParents.size());
+                    m_oIslandReferenceNodes.push_back(NO_NODE);
+                }
+            }
+
+            // Collects the reference node of every island in node order and checks that none of them is missing one
+            void partitionIslands() {
+                size_t iNode;
+                size_t iRoot;
+                std::vector<bool> oVisited;
+
+                addIslandNodes();
+                oVisited.assign(m_oIslandParents.size(), false);
+                m_oIslandAcrossReferenceNodes.clear();
+                for (iNode = 0; iNode < m_oIslandParents.size(); iNode++) {
+                    iRoot = findIsland(iNode);
+                    if (oVisited[iRoot] == false) {
+                        if (m_oIslandReferenceNodes[iRoot] == NO_NODE) {
+                            std::cout << "Every isolated part of the simulation needs an across reference node!" << std::endl;
+                            throw std::exception("Every isolated part of the simulation needs an across reference node!");
+                        }
+                        oVisited[iRoot] = true;
+                        m_oIslandAcrossReferenceNodes.push_back(m_oIslandReferenceNodes[iRoot]);
+                    }
+                }
+                m_iNumSystemNodes = m_oIslandParents.size() - m_oIslandAcrossReferenceNodes.size();
+            }
+
+            // The reference nodes are moved behind every other node, so the unknown across values are the leading block
+            // of the node space. The system that is factored leaves the reference rows and columns out, it is nonsingular
+            // and the reference nodes stay at 0 without a normalization pass. Nothing moves once the order is in place.
+            void orderAcrossReferenceNodesLast() {
+                size_t iNode;
+                size_t iNextIndex = 0;
+                std::vector<bool> oIsReferenceNode(m_oIslandParents.size(), false);
+                std::unordered_map<size_t, size_t> oNewIndices; // Old dense node index -> new
+
+                for (size_t iReferenceNode : m_oIslandAcrossReferenceNodes) {
+                    oIsReferenceNode[iReferenceNode] = true;
+                }
+                if (std::all_of(m_oIslandAcrossReferenceNodes.begin(), m_oIslandAcrossReferenceNodes.end(), [this](const size_t iReferenceNode) { return iReferenceNode >= m_iNumSystemNodes; })) {
+                    return;
+                }
+
+                oNewIndices.reserve(m_oIslandParents.size());
+                for (iNode = 0; iNode < m_oIslandParents.size(); iNode++) {
+                    if (oIsReferenceNode[iNode] == false) {
+                        oNewIndices[iNode] = iNextIndex++;
+                    }
+                }
+                for (size_t iReferenceNode : m_oIslandAcrossReferenceNodes) {
+                    oNewIndices[iReferenceNode] = iNextIndex++;
+                }
+                permuteNodes(oNewIndices);
+            }
+
+            virtual void permuteNodes(const std::unordered_map<size_t, size_t>& oNewIndices) {
+                size_t iNode;
+                std::vector<size_t> oIslandParents(m_oIslandParents.size());
+                std::vector<size_t> oIslandReferenceNodes(m_oIslandReferenceNodes.size());
+
+                NodeSimulation<T>::permuteNodes(oNewIndices);
+
+                for (iNode = 0; iNode < m_oIslandParents.size(); iNode++) {
+                    oIslandParents[oNewIndices.at(iNode)] = oNewIndices.at(m_oIslandParents[iNode]);
+                    oIslandReferenceNodes[oNewIndices.at(iNode)] = (m_oIslandReferenceNodes[iNode] == NO_NODE) ? NO_NODE : oNewIndices.at(m_oIslandReferenceNodes[iNode]);
+                }
+                m_oIslandParents = std::move(oIslandParents);
+                m_oIslandReferenceNodes = std::move(oIslandReferenceNodes);
+                for (size_t& iReferenceNode : m_oIslandAcrossReferenceNodes) {
+                    iReferenceNode = oNewIndices.at(iReferenceNode);
+                }
+                m_bReuseFactorization = false; // The simulation matrix is laid out for the old order
+            }
+
+            #pragma endregion
+
+            struct RecordProbe {
+                bool bAcross;
+                size_t iIndex; // Node or component index
+            };
+
+            #pragma region Members
+
+            static constexpr size_t SPARSE_SOLVER_NODE_THRESHOLD = 32;
+            static constexpr double dSTEP_GROWTH_ERROR = 0.1;
+            static constexpr size_t STEPS_BEFORE_GROWTH = 3;
+            static constexpr size_t NO_NODE = static_cast<size_t>(-1);
+
+            bool m_bHasAcrossReferenceNode;
+            std::vector<size_t> m_oIslandParents; // Union-find over the dense node indices, roots are islands
+            std::vector<size_t> m_oIslandReferenceNodes; // Root -> across reference node of the island, NO_NODE if none
+            std::vector<size_t> m_oIslandAcrossReferenceNodes; // Reference node of every island, set by initalize
+            size_t m_iNumSystemNodes; // Dense node indices below this are solved, the reference nodes come after them
+            MatrixSolverType m_eMatrixSolverType;
+            PivotingPolicy m_ePivotingPolicy;
+            bool m_bUseSparseSolver;
+            bool m_bReuseFactorization; // Topology is unchanged since the last factorization
+            SparseMatrix<double> m_oSimulationMatrix;
+            Matrix<double> m_oAcrossVector;
+            Matrix<double> m_oThroughVector;
+            Matrix<double> m_oThroughBaseline; // Through vector stamps of the static components
+            std::vector<size_t> m_oDynamicComponents; // Components restamped every step
+            Matrix<double> m_oSolveWorkspace; // Scratch space so step() does not allocate
+            PLU_Factorization<double> m_oPLU;
+            SparseLU_Factorization<double> m_oSparseLU;
+            bool m_bAdaptiveTimeStep;
+            bool m_bStartFromOperatingPoint;
+            double m_dMinTimeStep;
+            double m_dMaxTimeStep;
+            double m_dRelativeTolerance;
+            double m_dAbsoluteTolerance;
+            double m_dCurrentTimeStep;
+            size_t m_iNumRejectedSteps;
+            size_t m_iStepsSinceTimeStepChange;
+            bool m_bCacheCurrentTimeStep; // False for the shortened step onto the stop time and the halvings of it
+            std::uint64_t m_iTopologyHash; // Pattern of the simulation matrix when it was last factored from scratch
+            FactorizationCache<PLU_Factorization<double>> m_oDenseFactorizationCache;
+            FactorizationCache<SparseLU_Factorization<double>> m_oSparseFactorizationCache;
+            std::unique_ptr<WaveformRecorder> m_pRecorder;
+            size_t m_iRecordDecimation;
+            size_t m_iStepsSinceRecord;
+            std::vector<RecordProbe> m_oProbes;
+            std::vector<size_t> m_oProbeIndices; // Dense node index or component index of every probe
+            std::vector<double> m_oProbeValues; // Scratch row handed to the recorder
+
+            #pragma endregion
+    };
+
+    template<class T>
+    requires DiscreteEventTimeDomainSimComponentGeneral<T> &&
+             NodeSimComponentGeneral<T> &&
+             LinearNaturalSimComponentGeneral <T> &&
+             LinearNaturalSimComponentInitalize <T> &&
+             LinearNaturalSimComponentStep <T> &&
+             LinearNaturalSimComponentPostStep <T> &&
+             LinearCircuitSimComponentGeneral<T>
+    class LinearCircuitSimulation : public LinearNaturalSimulation<T> {
+
+        public:
+
+            LinearCircuitSimulation(const size_t iNumComponents = 0) :
+                LinearNaturalSimulation<T>(iNumComponents) { ; }
+
+            virtual size_t addComponent(std::unique_ptr<T> pComponent) {
+                return LinearNaturalSimulation<T>::addComponent(std::move(pComponent));
+            };
+
+            void setStopTime(const double dStopTime) {
+                DiscreteEventTimeDomainSimulation<T>::setStopTime(dStopTime);
+            }
+
+            double getTime() const {
+                return DiscreteEventTimeDomainSimulation<T>::getTime();
+            }
+
+            void setTimeStep(const double dTimeStep) {
+                DiscreteEventTimeDomainSimulation<T>::setTimeStep(dTimeStep);
+            }
+
+            double getVoltage(const size_t iNode) const {
+                return LinearNaturalSimulation<T>::getAcross(iNode);
             }
 
             double getCurrent(const size_t iComponentIndex) const {
                 return LinearNaturalSimulation<T>::getThrough(iComponentIndex);
             }
 
+            void setMatrixSolverType(const MatrixSolverType eMatrixSolverType) {
+                LinearNaturalSimulation<T>::setMatrixSolverType(eMatrixSolverType);
+            }
+
+            void setPivotingPolicy(const PivotingPolicy ePivotingPolicy) {
+                LinearNaturalSimulation<T>::setPivotingPolicy(ePivotingPolicy);
+            }
+
+            void setAdaptiveTimeStep(const double dMinTimeStep, const double dMaxTimeStep) requires LinearNaturalSimComponentAdaptive<T> {
+                LinearNaturalSimulation<T>::setAdaptiveTimeStep(dMinTimeStep, dMaxTimeStep);
+            }
+
+            void setFixedTimeStep() {
+                LinearNaturalSimulation<T>::setFixedTimeStep();
+            }
+
+            void setStartFromOperatingPoint(const bool bStartFromOperatingPoint) requires LinearNaturalSimComponentOperatingPoint<T> {
+                LinearNaturalSimulation<T>::setStartFromOperatingPoint(bStartFromOperatingPoint);
+            }
+
+            bool isStartingFromOperatingPoint() const {
+                return LinearNaturalSimulation<T>::isStartingFromOperatingPoint();
+            }
+
+            void solveOperatingPoint() requires LinearNaturalSimComponentOperatingPoint<T> {
+                LinearNaturalSimulation<T>::solveOperatingPoint();
+            }
+
+            void setTruncationErrorTolerance(const double dRelativeTolerance, const double dAbsoluteTolerance) {
+                LinearNaturalSimulation<T>::setTruncationErrorTolerance(dRelativeTolerance, dAbsoluteTolerance);
+            }
+
+            double getCurrentTimeStep() const {
+                return LinearNaturalSimulation<T>::getCurrentTimeStep();
+            }
+
+            size_t getNumRejectedSteps() const {
+                return LinearNaturalSimulation<T>::getNumRejectedSteps();
+            }
+
+            size_t getNumIslands() const {
+                return LinearNaturalSimulation<T>::getNumIslands();
+            }
+
+            void setFactorizationCacheCapacity(const size_t iCapacity) {
+                LinearNaturalSimulation<T>::setFactorizationCacheCapacity(iCapacity);
+            }
+
+            size_t getNumFactorizationCacheHits() const {
+                return LinearNaturalSimulation<T>::getNumFactorizationCacheHits();
+            }
+
+            size_t addVoltageProbe(const size_t iNode) {
+                return LinearNaturalSimulation<T>::addAcrossProbe(iNode);
+            }
+
+            size_t addCurrentProbe(const size_t iComponentIndex) {
+                return LinearNaturalSimulation<T>::addThroughProbe(iComponentIndex);
+            }
+
+            void clearProbes() {
+                LinearNaturalSimulation<T>::clearProbes();
+            }
+
+            void setRecorder(std::unique_ptr<WaveformRecorder> pRecorder, const size_t iDecimation = 1) {
+                LinearNaturalSimulation<T>::setRecorder(std::move(pRecorder), iDecimation);
+            }
+
+            WaveformRecorder* getRecorder() const {
+                return LinearNaturalSimulation<T>::getRecorder();
+            }
+
+            size_t getRunRowSize() const {
+                return LinearNaturalSimulation<T>::getRunRowSize();
+            }
+
+            size_t getNumRemainingSteps() const {
+                return LinearNaturalSimulation<T>::getNumRemainingSteps();
+            }
+
+            size_t run(std::span<double> oOutput, const size_t iMaxSteps = std::numeric_limits<size_t>::max()) {
+                return LinearNaturalSimulation<T>::run(oOutput, iMaxSteps);
+            }
+
             virtual void initalize(bool bInitComponents) {
                 LinearNaturalSimulation<T>::initalize(bInitComponents);
             }
@@ -505,13 +1375,21 @@ namespace SimulationEngine {
 
         public:
 
-            LinearCircuitSimulationCC(const size_t iNumComponents) :
+            LinearCircuitSimulationCC(const size_t iNumComponents = 0) :
                 LinearCircuitSimulation<LinearCircuitSimComponent>(iNumComponents) { ; }
 
             virtual size_t addComponent(std::unique_ptr<LinearCircuitSimComponent> pComponent) {
                 return LinearCircuitSimulation<LinearCircuitSimComponent>::addComponent(std::move(pComponent));
             };
 
+            size_t addComponents(std::span<std::unique_ptr<LinearCircuitSimComponent>> oComponents) {
+                return LinearCircuitSimulation<LinearCircuitSimComponent>::addComponents(oComponents);
+            }
+
+            void reserve(const size_t iNumComponents) {
+                LinearCircuitSimulation<LinearCircuitSimComponent>::reserve(iNumComponents);
+            }
+
             void setStopTime(const double dStopTime) {
                 LinearCircuitSimulation<LinearCircuitSimComponent>::setStopTime(dStopTime);
             }
@@ -520,6 +1398,10 @@ namespace SimulationEngine {
                 return LinearCircuitSimulation<LinearCircuitSimComponent>::getTime();
             }
 
+            size_t getNumComponents() const {
+                return LinearCircuitSimulation<LinearCircuitSimComponent>::getNumComponents();
+            }
+
             void setTimeStep(const double dTimeStep) {
                 LinearCircuitSimulation<LinearCircuitSimComponent>::setTimeStep(dTimeStep);
             }
@@ -532,6 +1414,90 @@ namespace SimulationEngine {
                 return LinearCircuitSimulation<LinearCircuitSimComponent>::getCurrent(iComponentIndex);
             }
 
+            void setMatrixSolverType(const MatrixSolverType eMatrixSolverType) {
+                LinearCircuitSimulation<LinearCircuitSimComponent>::setMatrixSolverType(eMatrixSolverType);
+            }
+
+            void setPivotingPolicy(const PivotingPolicy ePivotingPolicy) {
+                LinearCircuitSimulation<LinearCircuitSimComponent>::setPivotingPolicy(ePivotingPolicy);
+            }
+
+            void setAdaptiveTimeStep(const double dMinTimeStep, const double dMaxTimeStep) {
+                LinearCircuitSimulation<LinearCircuitSimComponent>::setAdaptiveTimeStep(dMinTimeStep, dMaxTimeStep);
+            }
+
+            void setFixedTimeStep() {
+                LinearCircuitSimulation<LinearCircuitSimComponent>::setFixedTimeStep();
+            }
+
+            void setStartFromOperatingPoint(const bool bStartFromOperatingPoint) {
+                LinearCircuitSimulation<LinearCircuitSimComponent>::setStartFromOperatingPoint(bStartFromOperatingPoint);
+            }
+
+            bool isStartingFromOperatingPoint() const {
+                return LinearCircuitSimulation<LinearCircuitSimComponent>::isStartingFromOperatingPoint();
+            }
+
+            void solveOperatingPoint() {
+                LinearCircuitSimulation<LinearCircuitSimComponent>::solveOperatingPoint();
+            }
+
+            void setTruncationErrorTolerance(const double dRelativeTolerance, const double dAbsoluteTolerance) {
+                LinearCircuitSimulation<LinearCircuitSimComponent>::setTruncationErrorTolerance(dRelativeTolerance, dAbsoluteTolerance);
+            }
+
+            double getCurrentTimeStep() const {
+                return LinearCircuitSimulation<LinearCircuitSimComponent>::getCurrentTimeStep();
+            }
+
+            size_t getNumRejectedSteps() const {
+                return LinearCircuitSimulation<LinearCircuitSimComponent>::getNumRejectedSteps();
+            }
+
+            size_t getNumIslands() const {
+                return LinearCircuitSimulation<LinearCircuitSimComponent>::getNumIslands();
+            }
+
+            void setFactorizationCacheCapacity(const size_t iCapacity) {
+                LinearCircuitSimulation<LinearCircuitSimComponent>::setFactorizationCacheCapacity(iCapacity);
+            }
+
+            size_t getNumFactorizationCacheHits() const {
+                return LinearCircuitSimulation<LinearCircuitSimComponent>::getNumFactorizationCacheHits();
+            }
+
+            size_t addVoltageProbe(const size_t iNode) {
+                return LinearCircuitSimulation<LinearCircuitSimComponent>::addVoltageProbe(iNode);
+            }
+
+            size_t addCurrentProbe(const size_t iComponentIndex) {
+                return LinearCircuitSimulation<LinearCircuitSimComponent>::addCurrentProbe(iComponentIndex);
+            }
+
+            void clearProbes() {
+                LinearCircuitSimulation<LinearCircuitSimComponent>::clearProbes();
+            }
+
+            void setRecorder(std::unique_ptr<WaveformRecorder> pRecorder, const size_t iDecimation = 1) {
+                LinearCircuitSimulation<LinearCircuitSimComponent>::setRecorder(std::move(pRecorder), iDecimation);
+            }
+
+            WaveformRecorder* getRecorder() const {
+                return LinearCircuitSimulation<LinearCircuitSimComponent>::getRecorder();
+            }
+
+            size_t getRunRowSize() const {
+                return LinearCircuitSimulation<LinearCircuitSimComponent>::getRunRowSize();
+            }
+
+            size_t getNumRemainingSteps() const {
+                return LinearCircuitSimulation<LinearCircuitSimComponent>::getNumRemainingSteps();
+            }
+
+            size_t run(std::span<double> oOutput, const size_t iMaxSteps = std::numeric_limits<size_t>::max()) {
+                return LinearCircuitSimulation<LinearCircuitSimComponent>::run(oOutput, iMaxSteps);
+            }
+
             virtual void initalize(bool bInitComponents) {
                 LinearCircuitSimulation<LinearCircuitSimComponent>::initalize(bInitComponents);
             }
@@ -541,4 +1507,387 @@ namespace SimulationEngine {
             }
         };
 
+    // Runs K instances of one circuit that share the same simulation matrix and only differ in their through vector stamps
+    // (source excitations). The matrix is factored once and every step solves the K through vectors as one n x K block.
+    // Instance 0 is made of the components added with addComponent(), the other instances with addInstanceComponent().
+    template<class T>
+    requires DiscreteEventTimeDomainSimComponentGeneral<T> &&
+             NodeSimComponentGeneral<T> &&
+             LinearNaturalSimComponentGeneral <T> &&
+             LinearNaturalSimComponentInitalize <T> &&
+             LinearNaturalSimComponentStep <T> &&
+             LinearNaturalSimComponentPostStep <T>
+    class LinearNaturalEnsembleSimulation : public LinearNaturalSimulation<T> {
+
+        public:
+
+            #pragma region Constructors
+
+            LinearNaturalEnsembleSimulation(const size_t iNumComponents, const size_t iNumInstances) :
+                LinearNaturalSimulation<T>(iNumComponents),
+                m_iNumInstances(iNumInstances),
+                m_oInstanceComponents(iNumInstances > 0 ? iNumInstances - 1 : 0)
+            {
+                if (iNumInstances == 0) {
+                    std::cout << "Ensemble must have a positive and non-zero number of instances!" << std::endl;
+                    throw std::invalid_argument("Ensemble must have a positive and non-zero number of instances!");
+                }
+                for (std::vector<std::unique_ptr<T>>& oComponents : m_oInstanceComponents) {
+                    oComponents.reserve(iNumComponents);
+                }
+            }
+
+            #pragma endregion
+
+            #pragma region Observers
+
+            size_t getNumInstances() const {
+                return m_iNumInstances;
+            }
+
+            double getInstanceAcross(const size_t iInstance, const size_t iNode) const {
+                size_t iNodeIndex;
+
+                checkInstance(iInstance);
+                iNodeIndex = this->getNodeIndex(iNode);
+                if (this->m_bRunSim == false) {
+                    std::cout << "Cannot read across values from a simulation that has not been simulated!" << std::endl;
+                    throw std::exception("Cannot read across values from a simulation that has not been simulated!");
+                }
+
+                return m_oAcrossBlock(iNodeIndex, iInstance);
+            }
+
+            double getInstanceThrough(const size_t iInstance, const size_t iComponentIndex) const {
+                checkInstance(iInstance);
+                if (iComponentIndex >= this->m_iComponentCount || (iInstance > 0 && iComponentIndex >= m_oInstanceComponents[iInstance - 1].size())) {
+                    std::cout << "Requested component does not exist!" << std::endl;
+                    throw std::invalid_argument("Requested component does not exist!");
+                }
+                if (this->m_bRunSim == false) {
+                    std::cout << "Cannot read through values from a simulation that has not been simulated!" << std::endl;
+                    throw std::exception("Cannot read through values from a simulation that has not been simulated!");
+                }
+
+                return getInstanceComponentUnchecked(iInstance, iComponentIndex).getThrough();
+            }
+
+            // Components can be edited in place (e.g. a new source value for one instance), initalize has to be run again afterwards
+            T& getInstanceComponent(const size_t iInstance, const size_t iComponentIndex) {
+                checkInstance(iInstance);
+                if (iInstance == 0)
+                    return this->getComponent(iComponentIndex);
+                if (iComponentIndex >= m_oInstanceComponents[iInstance - 1].size()) {
+                    std::cout << "Requested component does not exist!" << std::endl;
+                    throw std::invalid_argument("Requested component does not exist!");
+                }
+
+                this->m_bInitSim = false;
+                this->m_bRunSim = false;
+
+                return *m_oInstanceComponents[iInstance - 1][iComponentIndex];
+            }
+
+            #pragma endregion
+
+            #pragma region Modifiers
+
+            size_t addInstanceComponent(const size_t iInstance, std::unique_ptr<T> pComponent) {
+                checkInstance(iInstance);
+                if (iInstance == 0)
+                    return this->addComponent(std::move(pComponent));
+                this->m_bInitSim = false;
+                this->m_bRunSim = false;
+
+                this->registerNodes(*pComponent); // Nodes not used by instance 0 have no reference node, partitionIslands rejects them in initalize
+                m_oInstanceComponents[iInstance - 1].push_back(std::move(pComponent));
+
+                return m_oInstanceComponents[iInstance - 1].size() - 1; // Index of added component
+            }
+
+            virtual void initalize(bool bInitComponents) {
+                size_t iInstance;
+                size_t iIterator;
+                size_t iNumNodes;
+
+                if (this->m_bAdaptiveTimeStep) {
+                    std::cout << "Ensemble simulations do not support adaptive time stepping!" << std::endl;
+                    throw std::exception("Ensemble simulations do not support adaptive time stepping!");
+                }
+                if (this->m_bStartFromOperatingPoint) {
+                    std::cout << "Ensemble simulations cannot start from the operating point!" << std::endl;
+                    throw std::exception("Ensemble simulations cannot start from the operating point!");
+                }
+                if constexpr (LinearNaturalSimComponentBranches<T>) {
+                    shareInstanceBranches();
+                }
+                LinearNaturalSimulation<T>::initalize(bInitComponents);
+
+                iNumNodes = this->m_iMaxNode + 1;
+                for (iInstance = 1; iInstance < m_iNumInstances; iInstance++) {
+                    if (m_oInstanceComponents[iInstance - 1].size() != this->m_iComponentCount) {
+                        std::cout << "Ensemble instances must have the same number of components!" << std::endl;
+                        throw std::exception("Ensemble instances must have the same number of components!");
+                    }
+                    if (bInitComponents) {
+                        m_oInstanceMatrix = SparseMatrix<double>(iNumNodes, iNumNodes);
+                        for (iIterator = 0; iIterator < this->m_iComponentCount; iIterator++) {
+                            m_oInstanceComponents[iInstance - 1][iIterator]->LNS_initalize(m_oInstanceMatrix, this->m_dTimeStep);
+                        }
+                        m_oInstanceMatrix.compress();
+                        checkInstanceMatrix();
+                    }
+                }
+
+                m_oThroughBlock = Matrix<double>(iNumNodes, m_iNumInstances);
+                m_oAcrossBlock = Matrix<double>(iNumNodes, m_iNumInstances);
+                m_oBlockWorkspace = Matrix<double>(iNumNodes, m_iNumInstances);
+
+                // Static stamps of every instance, one row per instance
+                m_oThroughBaselines = Matrix<double>(m_iNumInstances, iNumNodes);
+                m_oInstanceDynamicComponents.assign(m_iNumInstances, std::vector<size_t>());
+                for (iInstance = 0; iInstance < m_iNumInstances; iInstance++) {
+                    this->m_oThroughVector.clear();
+                    for (iIterator = 0; iIterator < this->m_iComponentCount; iIterator++) {
+                        T& oComponent = getInstanceComponentUnchecked(iInstance, iIterator);
+
+                        if (this->isDynamicComponent(oComponent)) {
+                            m_oInstanceDynamicComponents[iInstance].push_back(iIterator);
+                        } else {
+                            oComponent.LNS_step(this->m_oThroughVector, 0); // Time invariant
+                        }
+                    }
+                    std::copy_n(this->m_oThroughVector.data(), iNumNodes, m_oThroughBaselines.getRow(iInstance).data());
+                }
+            }
+
+            virtual bool step() {
+                size_t iInstance;
+                size_t iIterator;
+                size_t iNumNodes = this->m_iMaxNode + 1;
+                double dStepTime = this->m_dTime + this->m_dTimeStep; // Same sum as stepEnd
+                bool bDone;
+
+                DiscreteEventTimeDomainSimulation<T>::stepStart();
+
+                // Each instance stamps its own through vector, which becomes one column of the block
+                for (iInstance = 0; iInstance < m_iNumInstances; iInstance++) {
+                    std::copy_n(m_oThroughBaselines.getRow(iInstance).data(), iNumNodes, this->m_oThroughVector.data());
+                    for (size_t iComponentIndex : m_oInstanceDynamicComponents[iInstance]) {
+                        getInstanceComponentUnchecked(iInstance, iComponentIndex).LNS_step(this->m_oThroughVector, dStepTime);
+                    }
+                    for (iIterator = 0; iIterator < iNumNodes; iIterator++) {
+                        m_oThroughBlock.uncheckedAt(iIterator, iInstance) = this->m_oThroughVector.uncheckedAt(iIterator);
+                    }
+                }
+
+                // Find all across vectors with one block solve, the reference node rows come last and stay at 0
+                if (this->m_bUseSparseSolver) {
+                    this->m_oSparseLU.solveBlockInto(m_oThroughBlock.data(), m_oAcrossBlock.data(), m_oBlockWorkspace.data(), m_iNumInstances);
+                } else {
+                    this->m_oPLU.solveBlockInto(m_oThroughBlock.data(), m_oAcrossBlock.data(), m_oBlockWorkspace.data(), m_iNumInstances);
+                }
+
+                // Run the post-step functions one instance at a time, instance 0 goes last so the single instance
+                // observers (getAcross) see its across vector
+                for (iInstance = m_iNumInstances; iInstance-- > 0;) {
+                    for (iIterator = 0; iIterator < iNumNodes; iIterator++) {
+                        this->m_oAcrossVector.uncheckedAt(iIterator) = m_oAcrossBlock.uncheckedAt(iIterator, iInstance);
+                    }
+                    for (iIterator = 0; iIterator < this->m_iComponentCount; iIterator++) {
+                        getInstanceComponentUnchecked(iInstance, iIterator).LNS_postStep(this->m_oAcrossVector);
+                    }
+                }
+
+#ifdef MATRIX_PRINT
+                std::cout << "Through Block:" << std::endl;
+                std::cout << m_oThroughBlock.getMatrixString();
+                std::cout << "Across Block:" << std::endl;
+                std::cout << m_oAcrossBlock.getMatrixString();
+#endif
+
+                bDone = DiscreteEventTimeDomainSimulation<T>::stepEnd();
+                this->recordStep(bDone); // Probes see instance 0
+
+                return bDone;
+            }
+
+            #pragma endregion
+
+        protected:
+
+            #pragma region Protected Modifiers
+
+            virtual void permuteNodes(const std::unordered_map<size_t, size_t>& oNewIndices) {
+                LinearNaturalSimulation<T>::permuteNodes(oNewIndices);
+                for (std::vector<std::unique_ptr<T>>& oComponents : m_oInstanceComponents) {
+                    for (std::unique_ptr<T>& pComponent : oComponents) {
+                        pComponent->renumberNodes(oNewIndices);
+                    }
+                }
+            }
+
+            // Instance components use the branch unknowns of the instance 0 component with the same index
+            void shareInstanceBranches() requires LinearNaturalSimComponentBranches<T> {
+                size_t iInstance;
+                size_t iComponentIndex;
+                size_t iBranchIndex;
+
+                for (iInstance = 1; iInstance < m_iNumInstances; iInstance++) {
+                    for (iComponentIndex = 0; iComponentIndex < std::min(m_oInstanceComponents[iInstance - 1].size(), this->m_iComponentCount); iComponentIndex++) {
+                        T& oComponent = *m_oInstanceComponents[iInstance - 1][iComponentIndex];
+                        const T& oSharedComponent = *this->m_oComponents[iComponentIndex];
+
+                        if (oComponent.LNS_getNumBranches() != oSharedComponent.LNS_getNumBranches()) {
+                            std::cout << "Ensemble instances must have the same simulation matrix!" << std::endl;
+                            throw std::exception("Ensemble instances must have the same simulation matrix!");
+                        }
+                        for (iBranchIndex = 0; iBranchIndex < oComponent.LNS_getNumBranches(); iBranchIndex++) {
+                            oComponent.LNS_setBranch(iBranchIndex, oSharedComponent.LNS_getBranch(iBranchIndex));
+                        }
+                    }
+                }
+            }
+
+            #pragma endregion
+
+            #pragma region Protected Observers
+
+            void checkInstance(const size_t iInstance) const {
+                if (iInstance >= m_iNumInstances) {
+                    std::cout << "Requested instance does not exist!" << std::endl;
+                    throw std::invalid_argument("Requested instance does not exist!");
+                }
+            }
+
+            T& getInstanceComponentUnchecked(const size_t iInstance, const size_t iComponentIndex) const {
+                return (iInstance == 0) ? *this->m_oComponents[iComponentIndex] : *m_oInstanceComponents[iInstance - 1][iComponentIndex];
+            }
+
+            // The shared factorization is only valid if every instance stamps the same matrix
+            void checkInstanceMatrix() const {
+                size_t iColumnIndex;
+                size_t iEntryIndex;
+                size_t iRowIndex;
+                size_t iPass;
+                const SparseMatrix<double>& oSimulationMatrix = this->m_oSimulationMatrix;
+                const SparseMatrix<double>* pMatrices[2] = { &oSimulationMatrix, &m_oInstanceMatrix };
+                const SparseMatrix<double>* pOthers[2] = { &m_oInstanceMatrix, &oSimulationMatrix };
+
+                for (iPass = 0; iPass < 2; iPass++) {
+                    const std::vector<size_t>& oColumnPointers = pMatrices[iPass]->getColumnPointers();
+                    const std::vector<size_t>& oRowIndices = pMatrices[iPass]->getRowIndices();
+                    const std::vector<double>& oValues = pMatrices[iPass]->getValues();
+
+                    for (iColumnIndex = 0; iColumnIndex < pMatrices[iPass]->getNumColumns(); iColumnIndex++) {
+                        for (iEntryIndex = oColumnPointers[iColumnIndex]; iEntryIndex < oColumnPointers[iColumnIndex + 1]; iEntryIndex++) {
+                            iRowIndex = oRowIndices[iEntryIndex];
+                            if (std::abs(oValues[iEntryIndex] - (*pOthers[iPass])(iRowIndex, iColumnIndex)) > dMATRIX_TOLERANCE * std::max(1.0, std::abs(oValues[iEntryIndex]))) {
+                                std::cout << "Ensemble instances must have the same simulation matrix!" << std::endl;
+                                throw std::exception("Ensemble instances must have the same simulation matrix!");
+                            }
+                        }
+                    }
+                }
+            }
+
+            #pragma endregion
+
+            #pragma region Members
+
+            static constexpr double dMATRIX_TOLERANCE = 1e-12;
+
+            size_t m_iNumInstances;
+            std::vector<std::vector<std::unique_ptr<T>>> m_oInstanceComponents; // Components of instances 1 to K - 1
+            SparseMatrix<double> m_oInstanceMatrix; // Scratch matrix to validate each instance's stamps
+            Matrix<double> m_oThroughBlock; // n x K, one column per instance
+            Matrix<double> m_oAcrossBlock;
+            Matrix<double> m_oBlockWorkspace;
+            Matrix<double> m_oThroughBaselines; // K x n, static through stamps of each instance
+            std::vector<std::vector<size_t>> m_oInstanceDynamicComponents;
+
+            #pragma endregion
+    };
+
+    template<class T>
+    requires DiscreteEventTimeDomainSimComponentGeneral<T> &&
+             NodeSimComponentGeneral<T> &&
+             LinearNaturalSimComponentGeneral <T> &&
+             LinearNaturalSimComponentInitalize <T> &&
+             LinearNaturalSimComponentStep <T> &&
+             LinearNaturalSimComponentPostStep <T> &&
+             LinearCircuitSimComponentGeneral<T>
+    class LinearCircuitEnsembleSimulation : public LinearNaturalEnsembleSimulation<T> {
+
+        public:
+
+            LinearCircuitEnsembleSimulation(const size_t iNumComponents, const size_t iNumInstances) :
+                LinearNaturalEnsembleSimulation<T>(iNumComponents, iNumInstances) { ; }
+
+            double getVoltage(const size_t iInstance, const size_t iNode) const {
+                return LinearNaturalEnsembleSimulation<T>::getInstanceAcross(iInstance, iNode);
+            }
+
+            double getCurrent(const size_t iInstance, const size_t iComponentIndex) const {
+                return LinearNaturalEnsembleSimulation<T>::getInstanceThrough(iInstance, iComponentIndex);
+            }
+
+            virtual void initalize(bool bInitComponents) {
+                LinearNaturalEnsembleSimulation<T>::initalize(bInitComponents);
+            }
+
+            virtual bool step() {
+                return LinearNaturalEnsembleSimulation<T>::step();
+            }
+    };
+
+    // C++ CLI needs this
+    class LinearCircuitEnsembleSimulationCC : public LinearCircuitEnsembleSimulation<LinearCircuitSimComponent> {
+
+        public:
+
+            LinearCircuitEnsembleSimulationCC(const size_t iNumComponents, const size_t iNumInstances) :
+                LinearCircuitEnsembleSimulation<LinearCircuitSimComponent>(iNumComponents, iNumInstances) { ; }
+
+            size_t addInstanceComponent(const size_t iInstance, std::unique_ptr<LinearCircuitSimComponent> pComponent) {
+                return LinearCircuitEnsembleSimulation<LinearCircuitSimComponent>::addInstanceComponent(iInstance, std::move(pComponent));
+            }
+
+            size_t getNumInstances() const {
+                return LinearCircuitEnsembleSimulation<LinearCircuitSimComponent>::getNumInstances();
+            }
+
+            void setStopTime(const double dStopTime) {
+                LinearCircuitEnsembleSimulation<LinearCircuitSimComponent>::setStopTime(dStopTime);
+            }
+
+            double getTime() const {
+                return LinearCircuitEnsembleSimulation<LinearCircuitSimComponent>::getTime();
+            }
+
+            void setTimeStep(const double dTimeStep) {
+                LinearCircuitEnsembleSimulation<LinearCircuitSimComponent>::setTimeStep(dTimeStep);
+            }
+
+            double getVoltage(const size_t iInstance, const size_t iNode) const {
+                return LinearCircuitEnsembleSimulation<LinearCircuitSimComponent>::getVoltage(iInstance, iNode);
+            }
+
+            double getCurrent(const size_t iInstance, const size_t iComponentIndex) const {
+                return LinearCircuitEnsembleSimulation<LinearCircuitSimComponent>::getCurrent(iInstance, iComponentIndex);
+            }
+
+            void setMatrixSolverType(const MatrixSolverType eMatrixSolverType) {
+                LinearCircuitEnsembleSimulation<LinearCircuitSimComponent>::setMatrixSolverType(eMatrixSolverType);
+            }
+
+            virtual void initalize(bool bInitComponents) {
+                LinearCircuitEnsembleSimulation<LinearCircuitSimComponent>::initalize(bInitComponents);
+            }
+
+            virtual bool step() {
+                return LinearCircuitEnsembleSimulation<LinearCircuitSimComponent>::step();
+            }
+    };
+
 }
\ No newline at end of file
@@ -0,0 +1,193 @@
+#pragma once
+
+#include "MappedFile.h"
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+// Time varying values for independent sources. A waveform is a pure function of the simulation time (0 is the start of
+// the simulation), it holds no step state so one waveform can drive several sources and ensemble instances.
+
+namespace SimulationEngine {
+
+    class SourceWaveform {
+
+        public:
+
+            virtual ~SourceWaveform() = default;
+
+            virtual double getValue(const double dTime) const = 0;
+    };
+
+    // Straight lines between (time, value) points. The first value is held before the first point, the last one after
+    // the last point.
+    class PiecewiseLinearWaveform final : public SourceWaveform {
+
+        public:
+
+            #pragma region Constructors
+
+            PiecewiseLinearWaveform(std::span<const double> oTimes, std::span<const double> oValues); // Times must be increasing
+
+            #pragma endregion
+
+            #pragma region Observers
+
+            size_t getNumPoints() const;
+            double getValue(const double dTime) const;
+
+            #pragma endregion
+
+        private:
+
+            #pragma region Members
+
+            std::vector<double> m_oTimes;
+            std::vector<double> m_oValues;
+
+            #pragma endregion
+    };
+
+    // Periodic trapezoid, starts at the initial value and repeats every period after the delay
+    class PulseWaveform final : public SourceWaveform {
+
+        public:
+
+            #pragma region Constructors
+
+            PulseWaveform(const double dInitialValue, const double dPulsedValue, const double dDelay, const double dRiseTime, const double dFallTime, const double dPulseWidth, const double dPeriod);
+
+            #pragma endregion
+
+            #pragma region Observers
+
+            double getValue(const double dTime) const;
+
+            #pragma endregion
+
+        private:
+
+            #pragma region Members
+
+            double m_dInitialValue;
+            double m_dPulsedValue;
+            double m_dDelay;
+            double m_dRiseTime;
+            double m_dFallTime;
+            double m_dPulseWidth;
+            double m_dPeriod;
+
+            #pragma endregion
+    };
+
+    // Offset + Amplitude * e^(-Damping * (t - Delay)) * sin(2 pi Frequency (t - Delay) + Phase), held at the t = Delay
+    // value before the delay. Phase is in radians, frequency in Hz and damping in 1/s.
+    class SineWaveform final : public SourceWaveform {
+
+        public:
+
+            #pragma region Constructors
+
+            SineWaveform(const double dOffset, const double dAmplitude, const double dFrequency, const double dDelay = 0, const double dDamping = 0, const double dPhase = 0);
+
+            #pragma endregion
+
+            #pragma region Observers
+
+            double getValue(const double dTime) const;
+
+            #pragma endregion
+
+        private:
+
+            #pragma region Members
+
+            double m_dOffset;
+            double m_dAmplitude;
+            double m_dAngularFrequency;
+            double m_dDelay;
+            double m_dDamping;
+            double m_dPhase;
+
+            #pragma endregion
+    };
+
+    // Evenly spaced samples read in place from a memory mapped file of raw doubles (native byte order), nothing is
+    // copied so only the pages the simulation reaches are loaded. Values are interpolated linearly between samples, the
+    // first sample is held before the start time and the last one after the end of the file.
+    class SampledWaveform final : public SourceWaveform {
+
+        public:
+
+            #pragma region Constructors
+
+            SampledWaveform(const std::string& sPath, const double dSampleTime, const double dStartTime = 0);
+
+            #pragma endregion
+
+            #pragma region Observers
+
+            size_t getNumSamples() const;
+            double getSample(const size_t iSampleIndex) const;
+            double getValue(const double dTime) const;
+
+            #pragma endregion
+
+        private:
+
+            #pragma region Private Observers
+
+            double getSampleUnchecked(const size_t iSampleIndex) const;
+
+            #pragma endregion
+
+            #pragma region Members
+
+            MappedFile m_oFile;
+            size_t m_iNumSamples;
+            double m_dSampleTime;
+            double m_dStartTime;
+
+            #pragma endregion
+    };
+
+    // Value of a source, constant or a waveform. It keeps no clock of its own, the source updates it with the simulation
+    // time it is stamped for (the end of the step).
+    class SourceValue final {
+
+        public:
+
+            #pragma region Constructors
+
+            SourceValue(const double dValue);
+
+            #pragma endregion
+
+            #pragma region Observers
+
+            bool isTimeVarying() const;
+            double getValue() const; // Value at the time of the last update
+
+            #pragma endregion
+
+            #pragma region Modifiers
+
+            void setValue(const double dValue); // Also removes the waveform
+            void setWaveform(std::shared_ptr<const SourceWaveform> pWaveform);
+            void update(const double dTime); // Evaluates the waveform at the simulation time dTime
+
+            #pragma endregion
+
+        private:
+
+            #pragma region Members
+
+            double m_dConstantValue;
+            std::shared_ptr<const SourceWaveform> m_pWaveform; // nullptr for a constant value
+            double m_dValue;
+
+            #pragma endregion
+    };
+
+}
@@ -0,0 +1,560 @@
+#pragma once
+
+#include "Matrix.h"
+#include "SimdKernels.h"
+#include "SparseMatrix.h"
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <set>
+
+namespace SimulationEngine {
+
+    // Represents a sparse matrix factored into P*A*Q = L*U, where P = Row Permutation Matrix,
+    // and Q = Column Permutation Matrix. Q is a fill-reducing minimum degree ordering of A + A',
+    // P comes from threshold partial pivoting that prefers the diagonal of the reordered matrix.
+    // The factorization is left-looking (Gilbert-Peierls), so the work done is proportional to
+    // the number of floating point operations instead of the matrix dimensions.
+    // The ordering and the pivot order/fill pattern (symbolic part) are kept, so refactor() can redo
+    // only the numeric part when a matrix with the same sparsity pattern gets new values.
+    // A pivot at or below dSINGULAR_PIVOT_TOLERANCE times the largest entry of its column of A means the matrix is singular
+    // and throws. The test is per column, so nodes only connected through very small conductances still factor.
+    template<Numeric T>
+    class SparseLU_Factorization final {
+
+        public:
+
+            #pragma region Constructors and Destructors
+
+            // Nothing is factored until a matrix is assigned or passed to refactor()
+            SparseLU_Factorization() :
+                m_iNumRows(0),
+                m_dPivotTolerance(0.001) { ; }
+
+            SparseLU_Factorization(const SparseMatrix<T>& oA, const double dPivotTolerance = 0.001) :
+                m_iNumRows(oA.getNumRows()),
+                m_dPivotTolerance(dPivotTolerance),
+                m_oL(oA.getNumRows(), oA.getNumRows()),
+                m_oU(oA.getNumRows(), oA.getNumRows()),
+                m_oP(oA.getNumRows(), 1),
+                m_oQ(oA.getNumRows(), 1)
+            {
+                if (oA.getNumRows() != oA.getNumColumns())
+                    throw std::invalid_argument("Matrix to factor must be square!");
+                if (oA.isCompressed() == false)
+                    throw std::invalid_argument("Matrix to factor must be compressed!");
+
+                runMinimumDegreeOrdering(oA);
+                runLU_Factorization(oA);
+            }
+
+            #pragma endregion
+
+            #pragma region Modifiers
+
+            // Factor a matrix with new values. If the sparsity pattern is unchanged the cached ordering, pivot order and fill
+            // pattern are reused. If a reused pivot has become too small the pivot order is recomputed, and if the pattern
+            // changed the whole factorization is redone.
+            void refactor(const SparseMatrix<T>& oA) {
+                if (oA.getNumRows() != oA.getNumColumns())
+                    throw std::invalid_argument("Matrix to factor must be square!");
+                if (oA.isCompressed() == false)
+                    throw std::invalid_argument("Matrix to factor must be compressed!");
+
+                if (hasSamePattern(oA) == false) {
+                    m_iNumRows = oA.getNumRows();
+                    m_oP = Matrix<size_t>(m_iNumRows, 1);
+                    m_oQ = Matrix<size_t>(m_iNumRows, 1);
+                    runMinimumDegreeOrdering(oA);
+                    runLU_Factorization(oA);
+                } else if (runNumericRefactor(oA) == false) {
+                    runLU_Factorization(oA);
+                }
+            }
+
+            #pragma endregion
+
+            #pragma region Observers
+
+            bool hasSamePattern(const SparseMatrix<T>& oA) const {
+                return oA.getNumRows() == m_iNumRows && oA.getColumnPointers() == m_oAColumnPointers && oA.getRowIndices() == m_oARowIndices;
+            }
+
+            const SparseMatrix<T>& getL() const {
+                return m_oL;
+            }
+
+            const SparseMatrix<T>& getU() const {
+                return m_oU;
+            }
+
+            const Matrix<size_t>& getP() const {
+                return m_oP;
+            }
+
+            const Matrix<size_t>& getQ() const {
+                return m_oQ;
+            }
+
+            Matrix<T> solve(const Matrix<T>& oB) const {
+                Matrix<T> oWorkspace(m_iNumRows);
+                Matrix<T> oSolution(m_iNumRows);
+
+                solveInto(oB, oSolution, oWorkspace);
+
+                return oSolution;
+            }
+
+            // Allocation free solve, oSolution and oWorkspace must be preallocated column vectors of the matrix size.
+            // oB and oSolution must not be the same object.
+            void solveInto(const Matrix<T>& oB, Matrix<T>& oSolution, Matrix<T>& oWorkspace) const {
+                if (oB.getNumRows() != m_iNumRows || oSolution.getNumRows() != m_iNumRows || oWorkspace.getNumRows() != m_iNumRows) {
+                    throw std::invalid_argument("Vector dimensions do not match the factored matrix!");
+                }
+
+                solveInto(oB.data(), oSolution.data(), oWorkspace.data());
+            }
+
+            // Unchecked solve on raw vectors, only the first n entries of each are used, so longer vectors can be passed
+            void solveInto(const T* pB, T* pSolution, T* pWorkspace) const {
+                size_t iRowIndex;
+                size_t iColumnIndex;
+                size_t iEntryIndex;
+                T uValue;
+                const std::vector<size_t>& oLColumnPointers = m_oL.getColumnPointers();
+                const std::vector<size_t>& oLRowIndices = m_oL.getRowIndices();
+                const std::vector<T>& oLValues = m_oL.getValues();
+                const std::vector<size_t>& oUColumnPointers = m_oU.getColumnPointers();
+                const std::vector<size_t>& oURowIndices = m_oU.getRowIndices();
+                const std::vector<T>& oUValues = m_oU.getValues();
+
+                // Apply row permutations to B
+                for (iRowIndex = 0; iRowIndex < m_iNumRows; ++iRowIndex) {
+                    pWorkspace[iRowIndex] = pB[m_oP.uncheckedAt(iRowIndex)];
+                }
+
+                // Forward substitution to solve LY = B_Permuted, L is unit lower triangular with the diagonal stored first in each column
+                for (iColumnIndex = 0; iColumnIndex < m_iNumRows; ++iColumnIndex) {
+                    uValue = pWorkspace[iColumnIndex];
+                    for (iEntryIndex = oLColumnPointers[iColumnIndex] + 1; iEntryIndex < oLColumnPointers[iColumnIndex + 1]; ++iEntryIndex) {
+                        pWorkspace[oLRowIndices[iEntryIndex]] -= oLValues[iEntryIndex] * uValue;
+                    }
+                }
+
+                // Backward substitution to solve UX = Y, the diagonal is stored last in each column of U
+                for (iColumnIndex = m_iNumRows; iColumnIndex-- > 0;) {
+                    uValue = pWorkspace[iColumnIndex] / oUValues[oUColumnPointers[iColumnIndex + 1] - 1];
+                    pWorkspace[iColumnIndex] = uValue;
+                    for (iEntryIndex = oUColumnPointers[iColumnIndex]; iEntryIndex < oUColumnPointers[iColumnIndex + 1] - 1; ++iEntryIndex) {
+                        pWorkspace[oURowIndices[iEntryIndex]] -= oUValues[iEntryIndex] * uValue;
+                    }
+                }
+
+                // Apply column permutations to X using Q to get Solution
+                for (iRowIndex = 0; iRowIndex < m_iNumRows; ++iRowIndex) {
+                    pSolution[m_oQ.uncheckedAt(iRowIndex)] = pWorkspace[iRowIndex];
+                }
+            }
+
+            // Solve for all K columns of an n x K right hand side at once, each L/U entry is applied to a whole contiguous row.
+            // oSolution and oWorkspace must be preallocated n x K matrices, oB and oSolution must not be the same object.
+            void solveBlockInto(const Matrix<T>& oB, Matrix<T>& oSolution, Matrix<T>& oWorkspace) const {
+                size_t iNumColumns = oB.getNumColumns();
+
+                if (oB.getNumRows() != m_iNumRows || oSolution.getNumRows() != m_iNumRows || oWorkspace.getNumRows() != m_iNumRows ||
+                    oSolution.getNumColumns() != iNumColumns || oWorkspace.getNumColumns() != iNumColumns) {
+                    throw std::invalid_argument("Vector dimensions do not match the factored matrix!");
+                }
+
+                solveBlockInto(oB.data(), oSolution.data(), oWorkspace.data(), iNumColumns);
+            }
+
+            // Unchecked block solve on raw row major blocks with iNumColumns columns, only the first n rows of each are used
+            void solveBlockInto(const T* pB, T* pSolution, T* pWorkspace, const size_t iNumColumns) const {
+                size_t iRowIndex;
+                size_t iColumnIndex;
+                size_t iEntryIndex;
+                T uValue;
+                T* pWorkspaceRow;
+                const std::vector<size_t>& oLColumnPointers = m_oL.getColumnPointers();
+                const std::vector<size_t>& oLRowIndices = m_oL.getRowIndices();
+                const std::vector<T>& oLValues = m_oL.getValues();
+                const std::vector<size_t>& oUColumnPointers = m_oU.getColumnPointers();
+                const std::vector<size_t>& oURowIndices = m_oU.getRowIndices();
+                const std::vector<T>& oUValues = m_oU.getValues();
+
+                // Apply row permutations to B
+                for (iRowIndex = 0; iRowIndex < m_iNumRows; ++iRowIndex) {
+                    std::copy_n(pB + m_oP.uncheckedAt(iRowIndex) * iNumColumns, iNumColumns, pWorkspace + iRowIndex * iNumColumns);
+                }
+
+                // Forward substitution to solve LY = B_Permuted
+                for (iColumnIndex = 0; iColumnIndex < m_iNumRows; ++iColumnIndex) {
+                    pWorkspaceRow = pWorkspace + iColumnIndex * iNumColumns;
+                    for (iEntryIndex = oLColumnPointers[iColumnIndex] + 1; iEntryIndex < oLColumnPointers[iColumnIndex + 1]; ++iEntryIndex) {
+                        SimdKernels::subtractScaled(pWorkspace + oLRowIndices[iEntryIndex] * iNumColumns, pWorkspaceRow, oLValues[iEntryIndex], iNumColumns);
+                    }
+                }
+
+                // Backward substitution to solve UX = Y
+                for (iColumnIndex = m_iNumRows; iColumnIndex-- > 0;) {
+                    pWorkspaceRow = pWorkspace + iColumnIndex * iNumColumns;
+                    uValue = oUValues[oUColumnPointers[iColumnIndex + 1] - 1];
+                    for (iRowIndex = 0; iRowIndex < iNumColumns; ++iRowIndex) {
+                        pWorkspaceRow[iRowIndex] /= uValue;
+                    }
+                    for (iEntryIndex = oUColumnPointers[iColumnIndex]; iEntryIndex < oUColumnPointers[iColumnIndex + 1] - 1; ++iEntryIndex) {
+                        SimdKernels::subtractScaled(pWorkspace + oURowIndices[iEntryIndex] * iNumColumns, pWorkspaceRow, oUValues[iEntryIndex], iNumColumns);
+                    }
+                }
+
+                // Apply column permutations to X using Q to get Solution
+                for (iRowIndex = 0; iRowIndex < m_iNumRows; ++iRowIndex) {
+                    std::copy_n(pWorkspace + iRowIndex * iNumColumns, iNumColumns, pSolution + m_oQ.uncheckedAt(iRowIndex) * iNumColumns);
+                }
+            }
+
+            #pragma endregion
+
+        private:
+
+            #pragma region Members
+
+            static constexpr double dSINGULAR_PIVOT_TOLERANCE = 1e-14; // Relative to the largest entry of the pivot's column
+            static constexpr size_t iUNASSIGNED = std::numeric_limits<size_t>::max();
+
+            size_t m_iNumRows;
+            double m_dPivotTolerance; // A diagonal pivot is kept if it is at least this fraction of the largest candidate
+            std::vector<size_t> m_oAColumnPointers; // Pattern of the factored matrix, used to validate refactors
+            std::vector<size_t> m_oARowIndices;
+            std::vector<size_t> m_oPivotOfRow; // Inverse row permutation
+            std::vector<double> m_oSingularPivots; // Per column of A, pivots at or below this magnitude mean the matrix is singular
+            SparseMatrix<T> m_oL; //Unit lower triangular matrix
+            SparseMatrix<T> m_oU; //Upper triangular matrix
+            Matrix<size_t> m_oP; //Row permuation matrix
+            Matrix<size_t> m_oQ; //Column permutation matrix
+
+            #pragma endregion
+
+            #pragma region Functions
+
+            // Minimum degree ordering on the pattern of A + A'. Rows with a degree above 10*sqrt(n) (typically the ground node)
+            // are treated as dense and ordered last, like AMD does, so they don't make every elimination step expensive.
+            void runMinimumDegreeOrdering(const SparseMatrix<T>& oA) {
+                size_t iNode;
+                size_t iNeighbour;
+                size_t iEntryIndex;
+                size_t iOrderIndex = 0;
+                size_t iMark = 0;
+                size_t iDenseDegree = std::max<size_t>(16, static_cast<size_t>(10.0 * std::sqrt(static_cast<double>(m_iNumRows))));
+                const std::vector<size_t>& oColumnPointers = oA.getColumnPointers();
+                const std::vector<size_t>& oRowIndices = oA.getRowIndices();
+                std::vector<std::vector<size_t>> oAdjacency(m_iNumRows);
+                std::vector<size_t> oDenseNodes;
+                std::vector<size_t> oDegree(m_iNumRows, 0);
+                std::vector<size_t> oMarker(m_iNumRows, 0);
+                std::vector<bool> oEliminated(m_iNumRows, false);
+                std::vector<size_t> oNeighbours;
+                std::set<std::pair<size_t, size_t>> oDegreeQueue; // (degree, node)
+
+                for (iNode = 0; iNode < m_iNumRows; ++iNode) {
+                    for (iEntryIndex = oColumnPointers[iNode]; iEntryIndex < oColumnPointers[iNode + 1]; ++iEntryIndex) {
+                        iNeighbour = oRowIndices[iEntryIndex];
+                        if (iNeighbour != iNode) {
+                            oAdjacency[iNode].push_back(iNeighbour);
+                            oAdjacency[iNeighbour].push_back(iNode);
+                        }
+                    }
+                }
+                for (iNode = 0; iNode < m_iNumRows; ++iNode) {
+                    std::sort(oAdjacency[iNode].begin(), oAdjacency[iNode].end());
+                    oAdjacency[iNode].erase(std::unique(oAdjacency[iNode].begin(), oAdjacency[iNode].end()), oAdjacency[iNode].end());
+                    if (oAdjacency[iNode].size() > iDenseDegree) {
+                        oDenseNodes.push_back(iNode);
+                        oEliminated[iNode] = true;
+                    }
+                }
+                for (iNode = 0; iNode < m_iNumRows; ++iNode) {
+                    if (oEliminated[iNode] == false) {
+                        removeEliminated(oAdjacency[iNode], oEliminated);
+                        oDegree[iNode] = oAdjacency[iNode].size();
+                        oDegreeQueue.emplace(oDegree[iNode], iNode);
+                    }
+                }
+
+                while (oDegreeQueue.empty() == false) {
+                    iNode = oDegreeQueue.begin()->second;
+                    oDegreeQueue.erase(oDegreeQueue.begin());
+                    oEliminated[iNode] = true;
+                    m_oQ(iOrderIndex++) = iNode;
+
+                    // Eliminating the node turns its remaining neighbours into a clique
+                    oNeighbours.clear();
+                    for (size_t iAdjacent : oAdjacency[iNode]) {
+                        if (oEliminated[iAdjacent] == false)
+                            oNeighbours.push_back(iAdjacent);
+                    }
+                    for (size_t iAdjacent : oNeighbours) {
+                        std::vector<size_t>& oMerged = oAdjacency[iAdjacent];
+
+                        iMark++;
+                        removeEliminated(oMerged, oEliminated);
+                        for (size_t iOther : oMerged) {
+                            oMarker[iOther] = iMark;
+                        }
+                        for (size_t iOther : oNeighbours) {
+                            if (iOther != iAdjacent && oMarker[iOther] != iMark) {
+                                oMarker[iOther] = iMark;
+                                oMerged.push_back(iOther);
+                            }
+                        }
+                        oDegreeQueue.erase({ oDegree[iAdjacent], iAdjacent });
+                        oDegree[iAdjacent] = oMerged.size();
+                        oDegreeQueue.emplace(oDegree[iAdjacent], iAdjacent);
+                    }
+                    oAdjacency[iNode].clear();
+                    oAdjacency[iNode].shrink_to_fit();
+                }
+
+                for (size_t iDenseNode : oDenseNodes) {
+                    m_oQ(iOrderIndex++) = iDenseNode;
+                }
+            }
+
+            void updateSingularPivots(const SparseMatrix<T>& oA) {
+                size_t iColumnIndex;
+                size_t iEntryIndex;
+                const std::vector<size_t>& oColumnPointers = oA.getColumnPointers();
+                const std::vector<T>& oValues = oA.getValues();
+
+                m_oSingularPivots.assign(m_iNumRows, 0);
+                for (iColumnIndex = 0; iColumnIndex < m_iNumRows; ++iColumnIndex) {
+                    for (iEntryIndex = oColumnPointers[iColumnIndex]; iEntryIndex < oColumnPointers[iColumnIndex + 1]; ++iEntryIndex) {
+                        m_oSingularPivots[iColumnIndex] = std::max<double>(m_oSingularPivots[iColumnIndex], std::abs(oValues[iEntryIndex]));
+                    }
+                    m_oSingularPivots[iColumnIndex] *= dSINGULAR_PIVOT_TOLERANCE;
+                }
+            }
+
+            static void removeEliminated(std::vector<size_t>& oNeighbours, const std::vector<bool>& oEliminated) {
+                oNeighbours.erase(std::remove_if(oNeighbours.begin(), oNeighbours.end(), [&oEliminated](const size_t iNeighbour) { return oEliminated[iNeighbour]; }), oNeighbours.end());
+            }
+
+            void runLU_Factorization(const SparseMatrix<T>& oA) {
+                size_t iStep;
+                size_t iColumn;
+                size_t iRow;
+                size_t iTop;
+                size_t iEntryIndex;
+                size_t iPivotRow;
+                double dMaxValue;
+                double dAbsoluteValue;
+                T uPivot;
+                const std::vector<size_t>& oAColumnPointers = oA.getColumnPointers();
+                const std::vector<size_t>& oARowIndices = oA.getRowIndices();
+                const std::vector<T>& oAValues = oA.getValues();
+                std::vector<size_t> oLColumnPointers(m_iNumRows + 1, 0);
+                std::vector<size_t> oLRowIndices;
+                std::vector<T> oLValues;
+                std::vector<size_t> oUColumnPointers(m_iNumRows + 1, 0);
+                std::vector<size_t> oURowIndices;
+                std::vector<T> oUValues;
+                std::vector<size_t>& oPivotOfRow = m_oPivotOfRow;
+                std::vector<size_t> oReach(m_iNumRows);
+                std::vector<size_t> oStack(m_iNumRows);
+                std::vector<size_t> oStackPosition(m_iNumRows);
+                std::vector<size_t> oVisited(m_iNumRows, iUNASSIGNED);
+                std::vector<T> oX(m_iNumRows, T{});
+
+                m_oAColumnPointers = oAColumnPointers;
+                m_oARowIndices = oARowIndices;
+                oPivotOfRow.assign(m_iNumRows, iUNASSIGNED);
+                updateSingularPivots(oA);
+
+                oLRowIndices.reserve(4 * oAValues.size() + m_iNumRows);
+                oLValues.reserve(4 * oAValues.size() + m_iNumRows);
+                oURowIndices.reserve(4 * oAValues.size() + m_iNumRows);
+                oUValues.reserve(4 * oAValues.size() + m_iNumRows);
+
+                for (iStep = 0; iStep < m_iNumRows; ++iStep) {
+                    oLColumnPointers[iStep] = oLValues.size();
+                    oUColumnPointers[iStep] = oUValues.size();
+                    iColumn = m_oQ(iStep);
+
+                    // Sparse triangular solve X = L \ A(:, iColumn), only touching the rows reachable from the column's pattern
+                    iTop = computeReach(oA, iColumn, iStep, oLColumnPointers, oLRowIndices, oPivotOfRow, oReach, oStack, oStackPosition, oVisited);
+                    for (iEntryIndex = oAColumnPointers[iColumn]; iEntryIndex < oAColumnPointers[iColumn + 1]; ++iEntryIndex) {
+                        oX[oARowIndices[iEntryIndex]] = oAValues[iEntryIndex];
+                    }
+                    for (size_t iReachIndex = iTop; iReachIndex < m_iNumRows; ++iReachIndex) {
+                        iRow = oReach[iReachIndex];
+                        if (oPivotOfRow[iRow] == iUNASSIGNED)
+                            continue;
+                        for (iEntryIndex = oLColumnPointers[oPivotOfRow[iRow]] + 1; iEntryIndex < oLColumnPointers[oPivotOfRow[iRow] + 1]; ++iEntryIndex) {
+                            oX[oLRowIndices[iEntryIndex]] -= oLValues[iEntryIndex] * oX[iRow];
+                        }
+                    }
+
+                    // Split the result into U entries (already pivoted rows) and pivot candidates
+                    iPivotRow = iUNASSIGNED;
+                    dMaxValue = -1;
+                    for (size_t iReachIndex = iTop; iReachIndex < m_iNumRows; ++iReachIndex) {
+                        iRow = oReach[iReachIndex];
+                        if (oPivotOfRow[iRow] == iUNASSIGNED) {
+                            dAbsoluteValue = std::abs(oX[iRow]);
+                            if (dAbsoluteValue > dMaxValue) {
+                                dMaxValue = dAbsoluteValue;
+                                iPivotRow = iRow;
+                            }
+                        } else {
+                            oURowIndices.push_back(oPivotOfRow[iRow]);
+                            oUValues.push_back(oX[iRow]);
+                        }
+                    }
+                    if (oPivotOfRow[iColumn] == iUNASSIGNED && std::abs(oX[iColumn]) >= m_dPivotTolerance * dMaxValue && iPivotRow != iUNASSIGNED) {
+                        iPivotRow = iColumn; // Prefer the diagonal to keep the ordering's fill estimate
+                    }
+                    if (iPivotRow == iUNASSIGNED || std::abs(oX[iPivotRow]) <= m_oSingularPivots[iColumn]) {
+                        throw std::invalid_argument("Matrix to factor is singular!");
+                    }
+
+                    uPivot = oX[iPivotRow];
+                    oURowIndices.push_back(iStep);
+                    oUValues.push_back(uPivot);
+                    oPivotOfRow[iPivotRow] = iStep;
+                    oLRowIndices.push_back(iPivotRow);
+                    oLValues.push_back(T{ 1 });
+                    for (size_t iReachIndex = iTop; iReachIndex < m_iNumRows; ++iReachIndex) {
+                        iRow = oReach[iReachIndex];
+                        if (oPivotOfRow[iRow] == iUNASSIGNED) {
+                            oLRowIndices.push_back(iRow);
+                            oLValues.push_back(oX[iRow] / uPivot);
+                        }
+                        oX[iRow] = T{};
+                    }
+                    oX[iPivotRow] = T{};
+                }
+                oLColumnPointers[m_iNumRows] = oLValues.size();
+                oUColumnPointers[m_iNumRows] = oUValues.size();
+
+                // L was built with original row indices, renumber them into pivot order
+                for (iEntryIndex = 0; iEntryIndex < oLRowIndices.size(); ++iEntryIndex) {
+                    oLRowIndices[iEntryIndex] = oPivotOfRow[oLRowIndices[iEntryIndex]];
+                }
+                for (iRow = 0; iRow < m_iNumRows; ++iRow) {
+                    m_oP(oPivotOfRow[iRow]) = iRow;
+                }
+
+                // Columns keep the reach order (diagonal first in L, last in U) that the solves and the refactor replay rely on
+                m_oL = SparseMatrix<T>(m_iNumRows, m_iNumRows, std::move(oLColumnPointers), std::move(oLRowIndices), std::move(oLValues), SparseRowOrder::Unsorted);
+                m_oU = SparseMatrix<T>(m_iNumRows, m_iNumRows, std::move(oUColumnPointers), std::move(oURowIndices), std::move(oUValues), SparseRowOrder::Unsorted);
+            }
+
+            // Numeric-only factorization that replays the cached pivot order over the cached L and U patterns. U columns are stored
+            // in the topological order found by computeReach, so each entry is final before it updates the rows below it.
+            // Returns false if a pivot fails the threshold test, in which case the pivot order has to be recomputed.
+            bool runNumericRefactor(const SparseMatrix<T>& oA) {
+                size_t iStep;
+                size_t iEntryIndex;
+                size_t iLEntryIndex;
+                size_t iPivotStep;
+                double dMaxValue;
+                T uPivot;
+                const std::vector<size_t>& oAColumnPointers = oA.getColumnPointers();
+                const std::vector<size_t>& oARowIndices = oA.getRowIndices();
+                const std::vector<T>& oAValues = oA.getValues();
+                const std::vector<size_t>& oLColumnPointers = m_oL.getColumnPointers();
+                const std::vector<size_t>& oLRowIndices = m_oL.getRowIndices();
+                std::vector<T>& oLValues = m_oL.getValues();
+                const std::vector<size_t>& oUColumnPointers = m_oU.getColumnPointers();
+                const std::vector<size_t>& oURowIndices = m_oU.getRowIndices();
+                std::vector<T>& oUValues = m_oU.getValues();
+                std::vector<T> oX(m_iNumRows, T{}); // Indexed by pivot step
+
+                updateSingularPivots(oA);
+                for (iStep = 0; iStep < m_iNumRows; ++iStep) {
+                    for (iEntryIndex = oAColumnPointers[m_oQ.uncheckedAt(iStep)]; iEntryIndex < oAColumnPointers[m_oQ.uncheckedAt(iStep) + 1]; ++iEntryIndex) {
+                        oX[m_oPivotOfRow[oARowIndices[iEntryIndex]]] = oAValues[iEntryIndex];
+                    }
+
+                    for (iEntryIndex = oUColumnPointers[iStep]; iEntryIndex < oUColumnPointers[iStep + 1] - 1; ++iEntryIndex) {
+                        iPivotStep = oURowIndices[iEntryIndex];
+                        oUValues[iEntryIndex] = oX[iPivotStep];
+                        for (iLEntryIndex = oLColumnPointers[iPivotStep] + 1; iLEntryIndex < oLColumnPointers[iPivotStep + 1]; ++iLEntryIndex) {
+                            oX[oLRowIndices[iLEntryIndex]] -= oLValues[iLEntryIndex] * oX[iPivotStep];
+                        }
+                        oX[iPivotStep] = T{};
+                    }
+
+                    uPivot = oX[iStep];
+                    oX[iStep] = T{};
+                    dMaxValue = 0;
+                    for (iLEntryIndex = oLColumnPointers[iStep] + 1; iLEntryIndex < oLColumnPointers[iStep + 1]; ++iLEntryIndex) {
+                        dMaxValue = std::max<double>(dMaxValue, std::abs(oX[oLRowIndices[iLEntryIndex]]));
+                    }
+                    // A pivot that is too small (or zero) falls back to a new pivot search, which throws if the matrix is singular
+                    if (std::abs(uPivot) <= m_oSingularPivots[m_oQ.uncheckedAt(iStep)] || std::abs(uPivot) < m_dPivotTolerance * dMaxValue)
+                        return false;
+
+                    oUValues[oUColumnPointers[iStep + 1] - 1] = uPivot;
+                    for (iLEntryIndex = oLColumnPointers[iStep] + 1; iLEntryIndex < oLColumnPointers[iStep + 1]; ++iLEntryIndex) {
+                        oLValues[iLEntryIndex] = oX[oLRowIndices[iLEntryIndex]] / uPivot;
+                        oX[oLRowIndices[iLEntryIndex]] = T{};
+                    }
+                }
+
+                return true;
+            }
+
+            // Depth first search over the graph of L from the nonzeros of A(:, iColumn). Fills oReach[iTop..n) with the reached rows
+            // in topological order, so each row is final before it is used to update the rows below it.
+            size_t computeReach(const SparseMatrix<T>& oA, const size_t iColumn, const size_t iStep, const std::vector<size_t>& oLColumnPointers,
+                                const std::vector<size_t>& oLRowIndices, const std::vector<size_t>& oPivotOfRow, std::vector<size_t>& oReach,
+                                std::vector<size_t>& oStack, std::vector<size_t>& oStackPosition, std::vector<size_t>& oVisited) const {
+                size_t iTop = m_iNumRows;
+                size_t iEntryIndex;
+                size_t iStackTop;
+                size_t iRow;
+                size_t iPivot;
+                size_t iEnd;
+                bool bDone;
+                const std::vector<size_t>& oAColumnPointers = oA.getColumnPointers();
+                const std::vector<size_t>& oARowIndices = oA.getRowIndices();
+
+                for (iEntryIndex = oAColumnPointers[iColumn]; iEntryIndex < oAColumnPointers[iColumn + 1]; ++iEntryIndex) {
+                    if (oVisited[oARowIndices[iEntryIndex]] == iStep)
+                        continue;
+
+                    iStackTop = 0;
+                    oStack[0] = oARowIndices[iEntryIndex];
+                    while (iStackTop != iUNASSIGNED) {
+                        iRow = oStack[iStackTop];
+                        iPivot = oPivotOfRow[iRow];
+                        if (oVisited[iRow] != iStep) {
+                            oVisited[iRow] = iStep;
+                            oStackPosition[iStackTop] = (iPivot == iUNASSIGNED) ? 0 : oLColumnPointers[iPivot] + 1;
+                        }
+                        bDone = true;
+                        iEnd = (iPivot == iUNASSIGNED) ? 0 : oLColumnPointers[iPivot + 1];
+                        while (oStackPosition[iStackTop] < iEnd) {
+                            iRow = oLRowIndices[oStackPosition[iStackTop]++];
+                            if (oVisited[iRow] != iStep) {
+                                oStack[++iStackTop] = iRow;
+                                bDone = false;
+                                break;
+                            }
+                        }
+                        if (bDone) {
+                            oReach[--iTop] = oStack[iStackTop];
+                            iStackTop = (iStackTop == 0) ? iUNASSIGNED : iStackTop - 1;
+                        }
+                    }
+                }
+
+                return iTop;
+            }
+
+            #pragma endregion
+    };
+
+}
@@ -0,0 +1,330 @@
+#pragma once
+
+#include "Matrix.h"
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace SimulationEngine {
+
+    // Row order of compressed arrays handed to SparseMatrix. Unsorted columns are only meant for factor matrices that keep
+    // the elimination order of their rows (e.g. the topological order of a sparse LU), lookups fall back to a linear scan.
+    enum class SparseRowOrder {
+        Sorted,
+        Unsorted
+    };
+
+    // Compressed sparse column (CSC) matrix. Entries can be stamped through operator() at any time; entries that are
+    // not yet part of the compressed pattern are held in per-column pending lists until compress() merges them in.
+    // References returned by operator() are invalidated by any later insertion or call to compress().
+    template<Numeric T>
+    class SparseMatrix final {
+
+        public:
+
+            #pragma region Constructors and Destructors
+
+            SparseMatrix(const size_t iNumRows = 1, const size_t iNumColumns = 1) :
+                m_iNumRows(iNumRows),
+                m_iNumColumns(iNumColumns),
+                m_iNumPendingEntries(0),
+                m_bSortedRows(true),
+                m_oColumnPointers(iNumColumns + 1, 0),
+                m_oPendingEntries(iNumColumns)
+            {
+                if (iNumRows == 0 || iNumColumns == 0)
+                    throw std::invalid_argument("Matrix dimensions must be positive and non-zero!");
+            }
+
+            // Build directly from compressed arrays, row indices within each column must be unique and (unless eRowOrder is
+            // Unsorted) sorted. Both are checked, the uniqueness of unsorted columns is left to the caller.
+            SparseMatrix(const size_t iNumRows, const size_t iNumColumns, std::vector<size_t>&& oColumnPointers, std::vector<size_t>&& oRowIndices, std::vector<T>&& oValues, const SparseRowOrder eRowOrder = SparseRowOrder::Sorted) :
+                m_iNumRows(iNumRows),
+                m_iNumColumns(iNumColumns),
+                m_iNumPendingEntries(0),
+                m_bSortedRows(eRowOrder == SparseRowOrder::Sorted),
+                m_oColumnPointers(std::move(oColumnPointers)),
+                m_oRowIndices(std::move(oRowIndices)),
+                m_oValues(std::move(oValues)),
+                m_oPendingEntries(iNumColumns)
+            {
+                if (iNumRows == 0 || iNumColumns == 0)
+                    throw std::invalid_argument("Matrix dimensions must be positive and non-zero!");
+                if (m_oColumnPointers.size() != m_iNumColumns + 1 || m_oRowIndices.size() != m_oValues.size() || m_oColumnPointers[m_iNumColumns] != m_oValues.size())
+                    throw std::invalid_argument("Compressed matrix arrays are inconsistent!");
+                checkCompressedPattern();
+            }
+
+            SparseMatrix(const SparseMatrix&) = default;
+            SparseMatrix(SparseMatrix&&) = default;
+            ~SparseMatrix() = default;
+
+            #pragma endregion
+
+            #pragma region Modifiers
+
+            // Merge all pending entries into the compressed pattern
+            void compress() {
+                size_t iColumnIndex;
+                size_t iEntryIndex;
+                size_t iNumEntries = 0;
+                std::vector<size_t> oColumnPointers(m_iNumColumns + 1, 0);
+                std::vector<size_t> oRowIndices;
+                std::vector<T> oValues;
+                std::vector<std::pair<size_t, T>> oColumn;
+
+                if (m_iNumPendingEntries == 0)
+                    return;
+
+                oRowIndices.reserve(m_oValues.size() + m_iNumPendingEntries);
+                oValues.reserve(m_oValues.size() + m_iNumPendingEntries);
+
+                for (iColumnIndex = 0; iColumnIndex < m_iNumColumns; ++iColumnIndex) {
+                    oColumnPointers[iColumnIndex] = iNumEntries;
+                    oColumn.clear();
+                    for (iEntryIndex = m_oColumnPointers[iColumnIndex]; iEntryIndex < m_oColumnPointers[iColumnIndex + 1]; ++iEntryIndex) {
+                        oColumn.emplace_back(m_oRowIndices[iEntryIndex], m_oValues[iEntryIndex]);
+                    }
+                    oColumn.insert(oColumn.end(), m_oPendingEntries[iColumnIndex].begin(), m_oPendingEntries[iColumnIndex].end());
+                    std::sort(oColumn.begin(), oColumn.end(), [](const std::pair<size_t, T>& oLeft, const std::pair<size_t, T>& oRight) { return oLeft.first < oRight.first; });
+                    for (iEntryIndex = 0; iEntryIndex < oColumn.size(); ++iEntryIndex) {
+                        oRowIndices.push_back(oColumn[iEntryIndex].first);
+                        oValues.push_back(oColumn[iEntryIndex].second);
+                    }
+                    iNumEntries += oColumn.size();
+                    m_oPendingEntries[iColumnIndex].clear();
+                }
+                oColumnPointers[m_iNumColumns] = iNumEntries;
+
+                m_oColumnPointers = std::move(oColumnPointers);
+                m_oRowIndices = std::move(oRowIndices);
+                m_oValues = std::move(oValues);
+                m_iNumPendingEntries = 0;
+                m_bSortedRows = true;
+            }
+
+            // Zero all values, the sparsity pattern is kept
+            void clear() {
+                size_t iColumnIndex;
+
+                std::fill(m_oValues.begin(), m_oValues.end(), T{});
+                for (iColumnIndex = 0; iColumnIndex < m_iNumColumns; ++iColumnIndex) {
+                    for (std::pair<size_t, T>& oEntry : m_oPendingEntries[iColumnIndex]) {
+                        oEntry.second = T{};
+                    }
+                }
+            }
+
+            Matrix<T> toDense() const {
+                size_t iColumnIndex;
+                size_t iEntryIndex;
+                Matrix<T> oDense(m_iNumRows, m_iNumColumns);
+
+                for (iColumnIndex = 0; iColumnIndex < m_iNumColumns; ++iColumnIndex) {
+                    for (iEntryIndex = m_oColumnPointers[iColumnIndex]; iEntryIndex < m_oColumnPointers[iColumnIndex + 1]; ++iEntryIndex) {
+                        oDense(m_oRowIndices[iEntryIndex], iColumnIndex) = m_oValues[iEntryIndex];
+                    }
+                    for (const std::pair<size_t, T>& oEntry : m_oPendingEntries[iColumnIndex]) {
+                        oDense(oEntry.first, iColumnIndex) = oEntry.second;
+                    }
+                }
+
+                return oDense;
+            }
+
+            std::string getMatrixString() const {
+                return toDense().getMatrixString();
+            }
+
+            #pragma endregion
+
+            #pragma region Observers
+
+            size_t getNumRows() const {
+                return m_iNumRows;
+            }
+
+            size_t getNumColumns() const {
+                return m_iNumColumns;
+            }
+
+            size_t getNumNonZeros() const {
+                return m_oValues.size() + m_iNumPendingEntries;
+            }
+
+            // FNV-1a hash of the dimensions and the compressed pattern, values are ignored
+            std::uint64_t getPatternHash() const {
+                std::uint64_t iHash = 14695981039346656037ull;
+
+                auto hashValue = [&iHash](const size_t iValue) {
+                    iHash = (iHash ^ static_cast<std::uint64_t>(iValue)) * 1099511628211ull;
+                };
+                hashValue(m_iNumRows);
+                hashValue(m_iNumColumns);
+                for (size_t iColumnPointer : m_oColumnPointers) {
+                    hashValue(iColumnPointer);
+                }
+                for (size_t iRowIndex : m_oRowIndices) {
+                    hashValue(iRowIndex);
+                }
+
+                return iHash;
+            }
+
+            // Top left iSize x iSize block of a compressed matrix, the pattern keeps the order of the full matrix
+            SparseMatrix<T> getLeadingBlock(const size_t iSize) const {
+                size_t iColumnIndex;
+                size_t iEntryIndex;
+                std::vector<size_t> oColumnPointers(iSize + 1, 0);
+                std::vector<size_t> oRowIndices;
+                std::vector<T> oValues;
+
+                if (iSize > m_iNumRows || iSize > m_iNumColumns)
+                    throw std::invalid_argument("Block is larger than the matrix!");
+                if (isCompressed() == false)
+                    throw std::invalid_argument("Matrix must be compressed!");
+
+                oRowIndices.reserve(m_oRowIndices.size());
+                oValues.reserve(m_oValues.size());
+                for (iColumnIndex = 0; iColumnIndex < iSize; ++iColumnIndex) {
+                    oColumnPointers[iColumnIndex] = oRowIndices.size();
+                    // With sorted rows the block's rows are the start of the column
+                    for (iEntryIndex = m_oColumnPointers[iColumnIndex]; iEntryIndex < m_oColumnPointers[iColumnIndex + 1]; ++iEntryIndex) {
+                        if (m_oRowIndices[iEntryIndex] < iSize) {
+                            oRowIndices.push_back(m_oRowIndices[iEntryIndex]);
+                            oValues.push_back(m_oValues[iEntryIndex]);
+                        } else if (m_bSortedRows) {
+                            break;
+                        }
+                    }
+                }
+                oColumnPointers[iSize] = oRowIndices.size();
+
+                return SparseMatrix<T>(iSize, iSize, std::move(oColumnPointers), std::move(oRowIndices), std::move(oValues), m_bSortedRows ? SparseRowOrder::Sorted : SparseRowOrder::Unsorted);
+            }
+
+            bool isCompressed() const {
+                return m_iNumPendingEntries == 0;
+            }
+
+            bool hasSortedRows() const {
+                return m_bSortedRows;
+            }
+
+            const std::vector<size_t>& getColumnPointers() const {
+                return m_oColumnPointers;
+            }
+
+            const std::vector<size_t>& getRowIndices() const {
+                return m_oRowIndices;
+            }
+
+            const std::vector<T>& getValues() const {
+                return m_oValues;
+            }
+
+            std::vector<T>& getValues() {
+                return m_oValues;
+            }
+
+            #pragma endregion
+
+            #pragma region Operators
+
+            #pragma region Modifiers
+
+            // Returns the stored entry, inserting an explicit zero into the pattern if it does not exist yet
+            T& operator()(const size_t iRow = 0, const size_t iColumn = 0) {
+                T* pValue;
+
+                checkBounds(iRow, iColumn);
+                pValue = findEntry(iRow, iColumn);
+                if (pValue != nullptr)
+                    return *pValue;
+
+                m_oPendingEntries[iColumn].emplace_back(iRow, T{});
+                m_iNumPendingEntries++;
+                return m_oPendingEntries[iColumn].back().second;
+            }
+
+            SparseMatrix& operator=(const SparseMatrix&) = default;
+            SparseMatrix& operator=(SparseMatrix&&) = default;
+
+            #pragma endregion
+
+            #pragma region Observers
+
+            const T& operator()(const size_t iRow = 0, const size_t iColumn = 0) const {
+                static const T uZERO{};
+                const T* pValue;
+
+                checkBounds(iRow, iColumn);
+                pValue = const_cast<SparseMatrix*>(this)->findEntry(iRow, iColumn);
+                return (pValue != nullptr) ? *pValue : uZERO;
+            }
+
+            #pragma endregion
+
+            #pragma endregion
+
+        private:
+
+            #pragma region Members
+
+            size_t m_iNumRows;
+            size_t m_iNumColumns;
+            size_t m_iNumPendingEntries;
+            bool m_bSortedRows; // False only for compressed arrays built with SparseRowOrder::Unsorted, compress() sorts them
+            std::vector<size_t> m_oColumnPointers; // Start of each column in the row index/value arrays, plus one past the end
+            std::vector<size_t> m_oRowIndices; // Sorted within each column unless m_bSortedRows is false
+            std::vector<T> m_oValues;
+            std::vector<std::vector<std::pair<size_t, T>>> m_oPendingEntries; // Per column (row, value) entries not yet compressed
+
+            #pragma endregion
+
+            #pragma region Observers
+
+            inline void checkBounds(size_t iRow, size_t iColumn) const {
+                if (iRow >= m_iNumRows || iColumn >= m_iNumColumns) {
+                    throw std::invalid_argument("Location beyond dimensions of matrix!");
+                }
+            }
+
+            // Column pointers must not decrease and rows must be in range, sorted columns must also be strictly increasing
+            void checkCompressedPattern() const {
+                size_t iColumnIndex;
+                size_t iEntryIndex;
+
+                for (iColumnIndex = 0; iColumnIndex < m_iNumColumns; ++iColumnIndex) {
+                    if (m_oColumnPointers[iColumnIndex] > m_oColumnPointers[iColumnIndex + 1])
+                        throw std::invalid_argument("Compressed matrix arrays are inconsistent!");
+                    for (iEntryIndex = m_oColumnPointers[iColumnIndex]; iEntryIndex < m_oColumnPointers[iColumnIndex + 1]; ++iEntryIndex) {
+                        if (m_oRowIndices[iEntryIndex] >= m_iNumRows)
+                            throw std::invalid_argument("Location beyond dimensions of matrix!");
+                        if (m_bSortedRows && iEntryIndex > m_oColumnPointers[iColumnIndex] && m_oRowIndices[iEntryIndex] <= m_oRowIndices[iEntryIndex - 1])
+                            throw std::invalid_argument("Row indices must be sorted and unique within each column!");
+                    }
+                }
+            }
+
+            T* findEntry(const size_t iRow, const size_t iColumn) {
+                std::vector<size_t>::const_iterator oBegin = m_oRowIndices.begin() + m_oColumnPointers[iColumn];
+                std::vector<size_t>::const_iterator oEnd = m_oRowIndices.begin() + m_oColumnPointers[iColumn + 1];
+                std::vector<size_t>::const_iterator oFound = m_bSortedRows ? std::lower_bound(oBegin, oEnd, iRow) : std::find(oBegin, oEnd, iRow);
+
+                if (oFound != oEnd && *oFound == iRow)
+                    return &m_oValues[oFound - m_oRowIndices.begin()];
+
+                for (std::pair<size_t, T>& oEntry : m_oPendingEntries[iColumn]) {
+                    if (oEntry.first == iRow)
+                        return &oEntry.second;
+                }
+
+                return nullptr;
+            }
+
+            #pragma endregion
+    };
+
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Component.h"
+#include "SourceWaveform.h"
+
+namespace SimulationEngine {
+
+    // Ideal voltage source, the current is a branch unknown of the simulation (modified nodal analysis)
+    class VoltageSource : public LinearCircuitSimComponent {
+
+        public:
+
+            VoltageSource(const size_t iNodeS, const size_t iNodeD, const double dVoltage); // iNodeS is (-), iNodeD is (+)
+            void setVoltage(const double dVoltage); // Takes effect on the next initalize
+            void setVoltageWaveform(std::shared_ptr<const SourceWaveform> pWaveform); // Replaces the constant voltage, takes effect on the next initalize
+
+            void LNS_initalize(SparseMatrix<double>& oSimulationMatrix, const double dTimeStep);
+            void LNS_step(Matrix<double>& oThroughVector, const double dTime);
+            void LNS_postStep(Matrix<double>& oAcrossVector);
+            bool LNS_isDynamic() const;
+            void LNS_initalizeDC(SparseMatrix<double>& oSimulationMatrix);
+            void LNS_stepDC(Matrix<double>& oThroughVector);
+            void renumberNodes(const std::unordered_map<size_t, size_t>& oNodeIndices);
+            void applySimulationMatrixStamp(SparseMatrix<double>& oSimulationMatrix, const double dTimeStep);
+            void applyThroughVectorMatrixStamp(Matrix<double>& oThroughVector);
+
+        private:
+
+            size_t m_iNodeS;
+            size_t m_iNodeD;
+            SourceValue m_oVoltage;
+    };
+
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+// Streams probe values of a running simulation to a sink without keeping the whole run in memory. Samples are written
+// into fixed size columnar chunks (a time column and one column per channel). Full chunks are handed to a background
+// thread that writes them to the sink while the simulation fills the next one. Only a fixed number of chunks exist,
+// so a sink that cannot keep up slows the simulation down instead of growing memory.
+
+namespace SimulationEngine {
+
+    class WaveformChunk final {
+
+        public:
+
+            #pragma region Constructors
+
+            WaveformChunk(const size_t iNumChannels, const size_t iCapacity);
+
+            #pragma endregion
+
+            #pragma region Observers
+
+            size_t getNumRows() const;
+            size_t getNumChannels() const; // Not counting the time column
+            size_t getCapacity() const;
+            bool isFull() const;
+            std::span<const double> getTimes() const;
+            std::span<const double> getChannel(const size_t iChannel) const;
+
+            #pragma endregion
+
+            #pragma region Modifiers
+
+            void append(const double dTime, std::span<const double> oValues);
+            void clear();
+
+            #pragma endregion
+
+        private:
+
+            #pragma region Members
+
+            size_t m_iNumChannels;
+            size_t m_iCapacity;
+            size_t m_iNumRows;
+            std::vector<double> m_oData; // Column major, column 0 is the time
+
+            #pragma endregion
+    };
+
+    // Sink functions are called by one thread at a time, writeChunk by the recorder's background thread
+    class WaveformSink {
+
+        public:
+
+            virtual ~WaveformSink() = default;
+
+            virtual void beginRun(const std::vector<std::string>& oChannelNames) = 0;
+            virtual void writeChunk(const WaveformChunk& oChunk) = 0;
+            virtual void endRun() = 0;
+    };
+
+    // Time,<channel names> header line, then one line per sample
+    class CsvWaveformSink final : public WaveformSink {
+
+        public:
+
+            CsvWaveformSink(const std::string& sPath);
+
+            virtual void beginRun(const std::vector<std::string>& oChannelNames);
+            virtual void writeChunk(const WaveformChunk& oChunk);
+            virtual void endRun();
+
+        private:
+
+            std::ofstream m_oStream;
+            std::string m_sBuffer;
+    };
+
+    // Little endian, every run is:
+    //     "ECSWAVE" and a 0, uint32 version, uint32 channel count, then per channel a uint32 length and the name
+    //     Chunks: uint64 row count, then the time column and each channel column as row count doubles
+    //     uint64 0 ends the run
+    class BinaryWaveformSink final : public WaveformSink {
+
+        public:
+
+            static constexpr std::uint32_t VERSION = 1;
+
+            BinaryWaveformSink(const std::string& sPath);
+
+            virtual void beginRun(const std::vector<std::string>& oChannelNames);
+            virtual void writeChunk(const WaveformChunk& oChunk);
+            virtual void endRun();
+
+        private:
+
+            std::ofstream m_oStream;
+    };
+
+    class WaveformRecorder final {
+
+        public:
+
+            static constexpr size_t DEFAULT_CHUNK_ROWS = 4096;
+            static constexpr size_t DEFAULT_NUM_CHUNKS = 4;
+
+            #pragma region Constructors
+
+            WaveformRecorder(std::unique_ptr<WaveformSink> pSink, const size_t iChunkRows = DEFAULT_CHUNK_ROWS, const size_t iNumChunks = DEFAULT_NUM_CHUNKS);
+            WaveformRecorder(const WaveformRecorder&) = delete;
+            WaveformRecorder& operator=(const WaveformRecorder&) = delete;
+            ~WaveformRecorder(); // Ends an open run and stops the background thread
+
+            #pragma endregion
+
+            #pragma region Observers
+
+            bool isRecording() const;
+            size_t getNumChannels() const;
+            size_t getNumRecordedRows() const; // In the current or last run
+
+            #pragma endregion
+
+            #pragma region Modifiers
+
+            // Starts a run, an open run is ended first
+            void beginRun(const std::vector<std::string>& oChannelNames);
+            // One value per channel
+            void record(const double dTime, std::span<const double> oValues);
+            // Writes the last partial chunk and waits until the sink has everything. Errors from the sink are rethrown
+            // here or by the next record call.
+            void endRun();
+
+            #pragma endregion
+
+        private:
+
+            struct Writer; // Thread, queues and the chunk pool, kept out of the header
+
+            #pragma region Private Modifiers
+
+            void submitChunk();
+
+            #pragma endregion
+
+            #pragma region Members
+
+            std::unique_ptr<WaveformSink> m_pSink;
+            std::unique_ptr<Writer> m_pWriter;
+            WaveformChunk* m_pCurrentChunk; // Filled by record, owned by the writer's pool
+            size_t m_iChunkRows;
+            size_t m_iNumChannels;
+            size_t m_iNumRecordedRows;
+            bool m_bRecording;
+
+            #pragma endregion
+    };
+
+}
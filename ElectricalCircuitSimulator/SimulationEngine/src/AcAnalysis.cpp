@@ -0,0 +1,387 @@
+// Every matrix entry is G + j(wC - (1/L)/w), so the three real parts are stamped once into matrices with one shared
+// pattern and every frequency only fills the complex values from them. The first frequency is solved on the calling
+// thread, which finds the ordering and pivot order and throws for bad circuits there. Each worker copies that
+// factorization and gets a contiguous block of the remaining frequencies, they all cost the same.
+
+#include "AcAnalysis.h"
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <numbers>
+#include <thread>
+
+using std::cout;
+using std::endl;
+using std::invalid_argument;
+
+namespace SimulationEngine {
+
+    namespace {
+
+        void stampEntries(SparseMatrix<double>& oMatrix, const size_t iNodeS, const size_t iNodeD, const size_t iNoNode, const double dValue) {
+            if (iNodeS != iNoNode) {
+                oMatrix(iNodeS, iNodeS) = oMatrix(iNodeS, iNodeS) + dValue;
+            }
+            if (iNodeD != iNoNode) {
+                oMatrix(iNodeD, iNodeD) = oMatrix(iNodeD, iNodeD) + dValue;
+            }
+            if (iNodeS != iNoNode && iNodeD != iNoNode) {
+                oMatrix(iNodeS, iNodeD) = oMatrix(iNodeS, iNodeD) - dValue;
+                oMatrix(iNodeD, iNodeS) = oMatrix(iNodeD, iNodeS) - dValue;
+            }
+        }
+
+        // The same entries are stamped into all three matrices, so they end up with the same pattern
+        void stampAdmittance(SparseMatrix<double>& oConductance, SparseMatrix<double>& oCapacitance, SparseMatrix<double>& oInverseInductance,
+                             const size_t iNodeS, const size_t iNodeD, const size_t iNoNode, const double dG, const double dC, const double dInverseL) {
+            stampEntries(oConductance, iNodeS, iNodeD, iNoNode, dG);
+            stampEntries(oCapacitance, iNodeS, iNodeD, iNoNode, dC);
+            stampEntries(oInverseInductance, iNodeS, iNodeD, iNoNode, dInverseL);
+        }
+
+    }
+
+    #pragma region Constructors
+
+    AcAnalysis::AcAnalysis(const CircuitDescription& oCircuit) :
+        m_oCircuit(oCircuit),
+        m_iNumThreads(0),
+        m_bHasRun(false),
+        m_iGroundNode(0) { ; }
+
+    #pragma endregion
+
+    #pragma region Observers
+
+    size_t AcAnalysis::getNumFrequencies() const {
+        return m_oFrequencies.size();
+    }
+
+    size_t AcAnalysis::getNumProbes() const {
+        return m_oProbes.size();
+    }
+
+    size_t AcAnalysis::getNumThreads() const {
+        return (m_iNumThreads == 0) ? std::max<size_t>(1, std::thread::hardware_concurrency()) : m_iNumThreads;
+    }
+
+    double AcAnalysis::getFrequency(const size_t iFrequencyIndex) const {
+        if (iFrequencyIndex >= m_oFrequencies.size()) {
+            cout << "Requested frequency does not exist!" << endl;
+            throw invalid_argument("Requested frequency does not exist!");
+        }
+
+        return m_oFrequencies[iFrequencyIndex];
+    }
+
+    std::complex<double> AcAnalysis::getResult(const size_t iFrequencyIndex, const size_t iProbeIndex) const {
+        checkResult(iFrequencyIndex, iProbeIndex);
+
+        return m_oResults[iFrequencyIndex * m_oProbes.size() + iProbeIndex];
+    }
+
+    double AcAnalysis::getMagnitude(const size_t iFrequencyIndex, const size_t iProbeIndex) const {
+        return std::abs(getResult(iFrequencyIndex, iProbeIndex));
+    }
+
+    double AcAnalysis::getPhase(const size_t iFrequencyIndex, const size_t iProbeIndex) const {
+        return std::arg(getResult(iFrequencyIndex, iProbeIndex));
+    }
+
+    std::span<const std::complex<double>> AcAnalysis::getResults() const {
+        return std::span<const std::complex<double>>(m_oResults);
+    }
+
+    #pragma endregion
+
+    #pragma region Modifiers
+
+    void AcAnalysis::addFrequency(const double dFrequency) {
+        addFrequencyChecked(dFrequency);
+    }
+
+    void AcAnalysis::addLinearFrequencies(const double dStart, const double dStop, const size_t iNumPoints) {
+        size_t iPoint;
+
+        if (iNumPoints == 0 || dStart <= 0 || dStop < dStart) {
+            cout << "Frequency range must be positive, increasing and have at least one point!" << endl;
+            throw invalid_argument("Frequency range must be positive, increasing and have at least one point!");
+        }
+        for (iPoint = 0; iPoint < iNumPoints; iPoint++) {
+            addFrequencyChecked(iNumPoints == 1 ? dStart : dStart + (dStop - dStart) * static_cast<double>(iPoint) / static_cast<double>(iNumPoints - 1));
+        }
+    }
+
+    void AcAnalysis::addLogFrequencies(const double dStart, const double dStop, const size_t iNumPoints) {
+        size_t iPoint;
+
+        if (iNumPoints == 0 || dStart <= 0 || dStop < dStart) {
+            cout << "Frequency range must be positive, increasing and have at least one point!" << endl;
+            throw invalid_argument("Frequency range must be positive, increasing and have at least one point!");
+        }
+        for (iPoint = 0; iPoint < iNumPoints; iPoint++) {
+            addFrequencyChecked(iNumPoints == 1 ? dStart : dStart * std::pow(dStop / dStart, static_cast<double>(iPoint) / static_cast<double>(iNumPoints - 1)));
+        }
+    }
+
+    void AcAnalysis::clearFrequencies() {
+        m_oFrequencies.clear();
+        m_bHasRun = false;
+    }
+
+    size_t AcAnalysis::addVoltageProbe(const size_t iNode) {
+        m_oProbes.push_back({ true, iNode });
+        m_bHasRun = false;
+
+        return m_oProbes.size() - 1;
+    }
+
+    size_t AcAnalysis::addCurrentProbe(const size_t iComponentIndex) {
+        if (iComponentIndex >= m_oCircuit.getNumComponents()) {
+            cout << "Requested component does not exist!" << endl;
+            throw invalid_argument("Requested component does not exist!");
+        }
+        m_oProbes.push_back({ false, iComponentIndex });
+        m_bHasRun = false;
+
+        return m_oProbes.size() - 1;
+    }
+
+    void AcAnalysis::setNumThreads(const size_t iNumThreads) {
+        m_iNumThreads = iNumThreads;
+    }
+
+    void AcAnalysis::run() {
+        size_t iNumFrequencies = m_oFrequencies.size();
+        size_t iNumThreads;
+        size_t iThread;
+        std::vector<std::thread> oWorkers;
+        std::vector<std::exception_ptr> oErrors;
+        AcWorkspace oFirstWorkspace;
+
+        m_bHasRun = false;
+        buildSystem();
+        m_oResults.assign(iNumFrequencies * m_oProbes.size(), std::complex<double>());
+        if (iNumFrequencies == 0) {
+            m_bHasRun = true;
+            return;
+        }
+
+        oFirstWorkspace.oAdmittanceMatrix = SparseMatrix<std::complex<double>>(m_oSourceVector.getNumRows(), m_oSourceVector.getNumRows(),
+                                                                                std::vector<size_t>(m_oConductance.getColumnPointers()),
+                                                                                std::vector<size_t>(m_oConductance.getRowIndices()),
+                                                                                std::vector<std::complex<double>>(m_oConductance.getNumNonZeros()));
+        oFirstWorkspace.oSolution = Matrix<std::complex<double>>(m_oSourceVector.getNumRows(), 1);
+        oFirstWorkspace.oScratch = Matrix<std::complex<double>>(m_oSourceVector.getNumRows(), 1);
+        solveFrequency(oFirstWorkspace, 0);
+
+        iNumThreads = std::min(getNumThreads(), iNumFrequencies - 1);
+        oErrors.resize(iNumThreads);
+        oWorkers.reserve(iNumThreads);
+        for (iThread = 0; iThread < iNumThreads; iThread++) {
+            oWorkers.emplace_back([this, &oFirstWorkspace, &oErrors, iThread, iNumThreads, iNumFrequencies]() {
+                size_t iFrequency;
+                size_t iBegin = 1 + (iNumFrequencies - 1) * iThread / iNumThreads;
+                size_t iEnd = 1 + (iNumFrequencies - 1) * (iThread + 1) / iNumThreads;
+
+                try {
+                    AcWorkspace oWorkspace = oFirstWorkspace; // Keeps the symbolic part of the factorization
+
+                    for (iFrequency = iBegin; iFrequency < iEnd; iFrequency++) {
+                        solveFrequency(oWorkspace, iFrequency);
+                    }
+                } catch (...) {
+                    oErrors[iThread] = std::current_exception();
+                }
+            });
+        }
+        for (std::thread& oWorker : oWorkers) {
+            oWorker.join();
+        }
+        for (std::exception_ptr& pError : oErrors) {
+            if (pError) {
+                std::rethrow_exception(pError);
+            }
+        }
+
+        m_bHasRun = true;
+    }
+
+    #pragma endregion
+
+    #pragma region Private Modifiers
+
+    void AcAnalysis::addFrequencyChecked(const double dFrequency) {
+        if (!(dFrequency > 0) || std::isinf(dFrequency)) {
+            cout << "Frequency must be greater than 0!" << endl;
+            throw invalid_argument("Frequency must be greater than 0!");
+        }
+        m_oFrequencies.push_back(dFrequency);
+        m_bHasRun = false;
+    }
+
+    void AcAnalysis::buildSystem() {
+        size_t iNumNodes;
+        size_t iNodeS;
+        size_t iNodeD;
+        bool bHasGround = false;
+
+        // The voltage sources define the ground
+        for (const ComponentDescription& oComponent : m_oCircuit.getComponents()) {
+            if (oComponent.eKind == CircuitComponentKind::GroundedVoltageSource) {
+                if (oComponent.dSourceResistance <= 0) {
+                    cout << "Resistance value must be greater than 0!" << endl;
+                    throw invalid_argument("Resistance value must be greater than 0!");
+                }
+                if (bHasGround && oComponent.iNodeS != m_iGroundNode) {
+                    cout << "Voltage sources must share one ground node!" << endl;
+                    throw invalid_argument("Voltage sources must share one ground node!");
+                }
+                bHasGround = true;
+                m_iGroundNode = oComponent.iNodeS;
+            } else if (oComponent.dValue <= 0) {
+                cout << "Component value must be greater than 0!" << endl;
+                throw invalid_argument("Component value must be greater than 0!");
+            }
+        }
+        if (bHasGround == false) {
+            cout << "There is no ground node in the circuit!" << endl;
+            throw std::exception("There is no ground node in the circuit!");
+        }
+
+        m_oSystemNodes.clear();
+        for (const ComponentDescription& oComponent : m_oCircuit.getComponents()) {
+            for (size_t iNode : { oComponent.iNodeS, oComponent.iNodeD }) {
+                if (iNode != m_iGroundNode) {
+                    m_oSystemNodes.try_emplace(iNode, m_oSystemNodes.size());
+                }
+            }
+        }
+        if (m_oSystemNodes.empty()) {
+            cout << "There are no nodes besides the ground in the circuit!" << endl;
+            throw std::exception("There are no nodes besides the ground in the circuit!");
+        }
+        for (const AcProbe& oProbe : m_oProbes) {
+            if (oProbe.bVoltage && oProbe.iIndex != m_iGroundNode) {
+                getSystemNode(oProbe.iIndex);
+            }
+        }
+
+        iNumNodes = m_oSystemNodes.size();
+        m_oConductance = SparseMatrix<double>(iNumNodes, iNumNodes);
+        m_oCapacitance = SparseMatrix<double>(iNumNodes, iNumNodes);
+        m_oInverseInductance = SparseMatrix<double>(iNumNodes, iNumNodes);
+        m_oSourceVector = Matrix<std::complex<double>>(iNumNodes, 1);
+        m_oComponentNodes.clear();
+        for (const ComponentDescription& oComponent : m_oCircuit.getComponents()) {
+            iNodeS = getSystemNode(oComponent.iNodeS);
+            iNodeD = getSystemNode(oComponent.iNodeD);
+            m_oComponentNodes.push_back(iNodeS);
+            m_oComponentNodes.push_back(iNodeD);
+
+            switch (oComponent.eKind) {
+                case CircuitComponentKind::Resistor:
+                    stampAdmittance(m_oConductance, m_oCapacitance, m_oInverseInductance, iNodeS, iNodeD, NO_NODE, 1.0 / oComponent.dValue, 0, 0);
+                    break;
+                case CircuitComponentKind::Capacitor:
+                    stampAdmittance(m_oConductance, m_oCapacitance, m_oInverseInductance, iNodeS, iNodeD, NO_NODE, 0, oComponent.dValue, 0);
+                    break;
+                case CircuitComponentKind::Inductor:
+                    stampAdmittance(m_oConductance, m_oCapacitance, m_oInverseInductance, iNodeS, iNodeD, NO_NODE, 0, 0, 1.0 / oComponent.dValue);
+                    break;
+                case CircuitComponentKind::GroundedVoltageSource:
+                    stampAdmittance(m_oConductance, m_oCapacitance, m_oInverseInductance, iNodeS, iNodeD, NO_NODE, 1.0 / oComponent.dSourceResistance, 0, 0);
+                    if (iNodeD != NO_NODE) {
+                        m_oSourceVector(iNodeD, 0) += oComponent.dValue / oComponent.dSourceResistance;
+                    }
+                    break;
+            }
+        }
+        m_oConductance.compress();
+        m_oCapacitance.compress();
+        m_oInverseInductance.compress();
+    }
+
+    void AcAnalysis::solveFrequency(AcWorkspace& oWorkspace, const size_t iFrequencyIndex) {
+        size_t iEntry;
+        size_t iProbe;
+        size_t iComponentIndex;
+        double dOmega = 2.0 * std::numbers::pi * m_oFrequencies[iFrequencyIndex];
+        std::complex<double> oVoltageDelta;
+        std::complex<double>* pResults = m_oResults.data() + iFrequencyIndex * m_oProbes.size();
+        std::vector<std::complex<double>>& oValues = oWorkspace.oAdmittanceMatrix.getValues();
+        const std::vector<double>& oConductance = m_oConductance.getValues();
+        const std::vector<double>& oCapacitance = m_oCapacitance.getValues();
+        const std::vector<double>& oInverseInductance = m_oInverseInductance.getValues();
+
+        for (iEntry = 0; iEntry < oValues.size(); iEntry++) {
+            oValues[iEntry] = std::complex<double>(oConductance[iEntry], dOmega * oCapacitance[iEntry] - oInverseInductance[iEntry] / dOmega);
+        }
+        oWorkspace.oFactorization.refactor(oWorkspace.oAdmittanceMatrix); // Numeric only once the pattern is known
+        oWorkspace.oFactorization.solveInto(m_oSourceVector, oWorkspace.oSolution, oWorkspace.oScratch);
+
+        for (iProbe = 0; iProbe < m_oProbes.size(); iProbe++) {
+            if (m_oProbes[iProbe].bVoltage) {
+                pResults[iProbe] = getNodeVoltage(oWorkspace.oSolution, getSystemNode(m_oProbes[iProbe].iIndex));
+                continue;
+            }
+
+            iComponentIndex = m_oProbes[iProbe].iIndex;
+            const ComponentDescription& oComponent = m_oCircuit.getComponents()[iComponentIndex];
+            oVoltageDelta = getNodeVoltage(oWorkspace.oSolution, m_oComponentNodes[2 * iComponentIndex]) -
+                            getNodeVoltage(oWorkspace.oSolution, m_oComponentNodes[2 * iComponentIndex + 1]);
+            switch (oComponent.eKind) {
+                case CircuitComponentKind::Resistor:
+                    pResults[iProbe] = oVoltageDelta / oComponent.dValue;
+                    break;
+                case CircuitComponentKind::Capacitor:
+                    pResults[iProbe] = std::complex<double>(0, dOmega * oComponent.dValue) * oVoltageDelta;
+                    break;
+                case CircuitComponentKind::Inductor:
+                    pResults[iProbe] = oVoltageDelta / std::complex<double>(0, dOmega * oComponent.dValue);
+                    break;
+                case CircuitComponentKind::GroundedVoltageSource: // Same sign as the transient, (V - (v(D) - v(S))) / R
+                    pResults[iProbe] = (oComponent.dValue + oVoltageDelta) / oComponent.dSourceResistance;
+                    break;
+            }
+        }
+    }
+
+    #pragma endregion
+
+    #pragma region Private Observers
+
+    size_t AcAnalysis::getSystemNode(const size_t iNode) const {
+        std::unordered_map<size_t, size_t>::const_iterator oFound;
+
+        if (iNode == m_iGroundNode) {
+            return NO_NODE;
+        }
+        oFound = m_oSystemNodes.find(iNode);
+        if (oFound == m_oSystemNodes.end()) {
+            cout << "Requested node does not exist!" << endl;
+            throw invalid_argument("Requested node does not exist!");
+        }
+
+        return oFound->second;
+    }
+
+    std::complex<double> AcAnalysis::getNodeVoltage(const Matrix<std::complex<double>>& oSolution, const size_t iSystemNode) const {
+        return (iSystemNode == NO_NODE) ? std::complex<double>() : oSolution.uncheckedAt(iSystemNode);
+    }
+
+    void AcAnalysis::checkResult(const size_t iFrequencyIndex, const size_t iProbeIndex) const {
+        if (m_bHasRun == false) {
+            cout << "Cannot read results from an analysis that has not been run!" << endl;
+            throw std::exception("Cannot read results from an analysis that has not been run!");
+        }
+        if (iFrequencyIndex >= m_oFrequencies.size() || iProbeIndex >= m_oProbes.size()) {
+            cout << "Requested analysis value does not exist!" << endl;
+            throw invalid_argument("Requested analysis value does not exist!");
+        }
+    }
+
+    #pragma endregion
+
+}
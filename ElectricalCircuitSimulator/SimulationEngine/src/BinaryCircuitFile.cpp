@@ -0,0 +1,216 @@
+#include "BinaryCircuitFile.h"
+#include <array>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <unordered_set>
+#include <vector>
+
+using std::cout;
+using std::endl;
+
+namespace SimulationEngine {
+
+    namespace {
+
+        constexpr char MAGIC[8] = { 'E', 'C', 'S', 'C', 'I', 'R', 'C', '\0' };
+        constexpr size_t WRITE_BLOCK_RECORDS = 4096;
+
+        static_assert(std::endian::native == std::endian::little, "The binary circuit format is little endian only");
+        static_assert(sizeof(BinaryCircuitHeader) == 80 && sizeof(BinaryComponentRecord) == 40, "Binary circuit layout changed");
+        static_assert(static_cast<int>(CircuitComponentKind::Resistor) == 0 && static_cast<int>(CircuitComponentKind::Capacitor) == 1 &&
+                      static_cast<int>(CircuitComponentKind::Inductor) == 2 && static_cast<int>(CircuitComponentKind::GroundedVoltageSource) == 3,
+                      "Stored component kinds changed");
+
+        size_t alignToRecord(const size_t iSize) {
+            return (iSize + 7) & ~static_cast<size_t>(7);
+        }
+
+        void fail(const std::string& sPath, const char* sMessage) {
+            cout << sMessage << " (" << sPath << ")" << endl;
+            throw std::exception(sMessage);
+        }
+
+    }
+
+    #pragma region Constructors
+
+    BinaryCircuitFile::BinaryCircuitFile(const std::string& sPath) :
+        m_oFile(sPath),
+        m_pHeader(nullptr)
+    {
+        size_t iRecordBytes;
+
+        if (m_oFile.getSize() < sizeof(BinaryCircuitHeader)) {
+            fail(sPath, "Binary circuit file is too small for its header!");
+        }
+        m_pHeader = reinterpret_cast<const BinaryCircuitHeader*>(m_oFile.getData());
+        if (std::memcmp(m_pHeader->acMagic, MAGIC, sizeof(MAGIC)) != 0) {
+            fail(sPath, "File is not a binary circuit file!");
+        }
+        if (m_pHeader->iVersion != VERSION) {
+            fail(sPath, "Unsupported binary circuit file version!");
+        }
+        if (m_pHeader->iHeaderSize < sizeof(BinaryCircuitHeader) || m_pHeader->iTitleSize > m_oFile.getSize() || m_pHeader->iComponentOffset % alignof(BinaryComponentRecord) != 0 ||
+            m_pHeader->iComponentOffset < m_pHeader->iHeaderSize + m_pHeader->iTitleSize || m_pHeader->iComponentOffset > m_oFile.getSize()) {
+            fail(sPath, "Binary circuit file has a broken layout!");
+        }
+        iRecordBytes = m_oFile.getSize() - m_pHeader->iComponentOffset;
+        if (m_pHeader->iNumComponents > iRecordBytes / sizeof(BinaryComponentRecord)) {
+            fail(sPath, "Binary circuit file is truncated!");
+        }
+
+        m_oComponents = std::span<const BinaryComponentRecord>(reinterpret_cast<const BinaryComponentRecord*>(m_oFile.getData() + m_pHeader->iComponentOffset),
+                                                                m_pHeader->iNumComponents);
+        for (const BinaryComponentRecord& oRecord : m_oComponents) {
+            if (oRecord.iKind > static_cast<std::uint32_t>(CircuitComponentKind::GroundedVoltageSource)) {
+                fail(sPath, "Binary circuit file has an unknown component type!");
+            }
+        }
+    }
+
+    #pragma endregion
+
+    #pragma region Observers
+
+    const BinaryCircuitHeader& BinaryCircuitFile::getHeader() const {
+        return *m_pHeader;
+    }
+
+    std::string_view BinaryCircuitFile::getTitle() const {
+        return std::string_view(m_oFile.getData() + m_pHeader->iHeaderSize, m_pHeader->iTitleSize);
+    }
+
+    std::span<const BinaryComponentRecord> BinaryCircuitFile::getComponents() const {
+        return m_oComponents;
+    }
+
+    void BinaryCircuitFile::buildSimulation(PartitionedCircuitSimulation& oSimulation) const {
+        std::array<size_t, 4> oKindCounts = {};
+        size_t iKind;
+
+        for (const BinaryComponentRecord& oRecord : m_oComponents) {
+            oKindCounts[oRecord.iKind]++;
+        }
+        for (iKind = 0; iKind < oKindCounts.size(); iKind++) {
+            oSimulation.reserve(static_cast<CircuitComponentKind>(iKind), oKindCounts[iKind]);
+        }
+        oSimulation.reserveNodes(m_pHeader->iNumNodes);
+
+        for (const BinaryComponentRecord& oRecord : m_oComponents) {
+            switch (static_cast<CircuitComponentKind>(oRecord.iKind)) {
+                case CircuitComponentKind::Resistor:
+                    oSimulation.addResistor(oRecord.iNodeS, oRecord.iNodeD, oRecord.dValue);
+                    break;
+                case CircuitComponentKind::Capacitor:
+                    oSimulation.addCapacitor(oRecord.iNodeS, oRecord.iNodeD, oRecord.dValue);
+                    break;
+                case CircuitComponentKind::Inductor:
+                    oSimulation.addInductor(oRecord.iNodeS, oRecord.iNodeD, oRecord.dValue);
+                    break;
+                case CircuitComponentKind::GroundedVoltageSource:
+                    oSimulation.addGroundedVoltageSource(oRecord.iNodeS, oRecord.iNodeD, oRecord.dValue, oRecord.dSourceResistance);
+                    break;
+            }
+        }
+        oSimulation.setTimeStep(m_pHeader->dTimeStep);
+        oSimulation.setStopTime(m_pHeader->dStopTime);
+    }
+
+    CircuitDescription BinaryCircuitFile::toCircuitDescription() const {
+        CircuitDescription oCircuit;
+
+        oCircuit.reserve(m_oComponents.size());
+        for (const BinaryComponentRecord& oRecord : m_oComponents) {
+            switch (static_cast<CircuitComponentKind>(oRecord.iKind)) {
+                case CircuitComponentKind::Resistor:
+                    oCircuit.addResistor(oRecord.iNodeS, oRecord.iNodeD, oRecord.dValue);
+                    break;
+                case CircuitComponentKind::Capacitor:
+                    oCircuit.addCapacitor(oRecord.iNodeS, oRecord.iNodeD, oRecord.dValue);
+                    break;
+                case CircuitComponentKind::Inductor:
+                    oCircuit.addInductor(oRecord.iNodeS, oRecord.iNodeD, oRecord.dValue);
+                    break;
+                case CircuitComponentKind::GroundedVoltageSource:
+                    oCircuit.addGroundedVoltageSource(oRecord.iNodeS, oRecord.iNodeD, oRecord.dValue, oRecord.dSourceResistance);
+                    break;
+            }
+        }
+
+        return oCircuit;
+    }
+
+    Netlist BinaryCircuitFile::toNetlist() const {
+        Netlist oNetlist;
+
+        oNetlist.sTitle = getTitle();
+        oNetlist.oCircuit = toCircuitDescription();
+        oNetlist.iVoltageScopeNode = m_pHeader->iVoltageScopeNode;
+        oNetlist.iCurrentScopeComponent = m_pHeader->iCurrentScopeComponent;
+        oNetlist.dTimeStep = m_pHeader->dTimeStep;
+        oNetlist.dStopTime = m_pHeader->dStopTime;
+
+        return oNetlist;
+    }
+
+    #pragma endregion
+
+    #pragma region Static Functions
+
+    void BinaryCircuitFile::write(const Netlist& oNetlist, const std::string& sPath) {
+        BinaryCircuitHeader oHeader = {};
+        std::unordered_set<size_t> oNodes;
+        std::vector<BinaryComponentRecord> oBlock;
+        std::ofstream oStream(sPath, std::ios::binary | std::ios::trunc);
+        const char acPadding[8] = {};
+
+        if (!oStream) {
+            fail(sPath, "Could not create binary circuit file!");
+        }
+
+        for (const ComponentDescription& oComponent : oNetlist.oCircuit.getComponents()) {
+            oNodes.insert(oComponent.iNodeS);
+            oNodes.insert(oComponent.iNodeD);
+        }
+
+        std::memcpy(oHeader.acMagic, MAGIC, sizeof(MAGIC));
+        oHeader.iVersion = VERSION;
+        oHeader.iHeaderSize = sizeof(BinaryCircuitHeader);
+        oHeader.iNumNodes = oNodes.size();
+        oHeader.iNumComponents = oNetlist.oCircuit.getNumComponents();
+        oHeader.iTitleSize = oNetlist.sTitle.size();
+        oHeader.iComponentOffset = alignToRecord(sizeof(BinaryCircuitHeader) + oNetlist.sTitle.size());
+        oHeader.iVoltageScopeNode = oNetlist.iVoltageScopeNode;
+        oHeader.iCurrentScopeComponent = oNetlist.iCurrentScopeComponent;
+        oHeader.dTimeStep = oNetlist.dTimeStep;
+        oHeader.dStopTime = oNetlist.dStopTime;
+
+        oStream.write(reinterpret_cast<const char*>(&oHeader), sizeof(oHeader));
+        oStream.write(oNetlist.sTitle.data(), oNetlist.sTitle.size());
+        oStream.write(acPadding, oHeader.iComponentOffset - sizeof(BinaryCircuitHeader) - oNetlist.sTitle.size());
+
+        // Records go out in blocks, one write per record is slow for large circuits
+        oBlock.reserve(WRITE_BLOCK_RECORDS);
+        for (const ComponentDescription& oComponent : oNetlist.oCircuit.getComponents()) {
+            oBlock.push_back({ static_cast<std::uint32_t>(oComponent.eKind), 0, oComponent.iNodeS, oComponent.iNodeD, oComponent.dValue, oComponent.dSourceResistance });
+            if (oBlock.size() == WRITE_BLOCK_RECORDS) {
+                oStream.write(reinterpret_cast<const char*>(oBlock.data()), oBlock.size() * sizeof(BinaryComponentRecord));
+                oBlock.clear();
+            }
+        }
+        oStream.write(reinterpret_cast<const char*>(oBlock.data()), oBlock.size() * sizeof(BinaryComponentRecord));
+
+        if (!oStream) {
+            fail(sPath, "Could not write binary circuit file!");
+        }
+    }
+
+    void BinaryCircuitFile::convertNetlist(const std::string& sTextPath, const std::string& sBinaryPath) {
+        write(NetlistParser::parseFile(sTextPath), sBinaryPath);
+    }
+
+    #pragma endregion
+
+}
@@ -17,6 +17,7 @@
 // Through = Current (A)
 
 #include "Capacitor.h"
+#include <cmath>
 #include <iostream>
 
 using std::cout;
@@ -26,33 +27,40 @@ using std::invalid_argument;
 namespace SimulationEngine {
 
     Capacitor::Capacitor(const size_t iNodeS, const size_t iNodeD, const double dCapacitance) :
-        LinearCircuitSimComponent(0, false, iNodeS),
+        LinearCircuitSimComponent({ iNodeS, iNodeD }, false, iNodeS),
         m_iNodeS(iNodeS),
         m_iNodeD(iNodeD),
         m_dCapacitance(dCapacitance),
-        m_dVoltageDelta(0)
+        m_dVoltageDelta(0),
+        m_dTimeStep(0),
+        m_dPreviousVoltageDelta(0),
+        m_dPreviousThrough(0)
     {
-        size_t iNodeList = 0;
-
         if (dCapacitance <= 0) {
             cout << "Capacitance value must be greater than 0!" << endl;
             throw invalid_argument("Capacitance value must be greater than 0!");
         }
+    }
 
-        iNodeList += (m_iNodeS << (0 * BITS_PER_NODE));
-        iNodeList += (m_iNodeD << (1 * BITS_PER_NODE));
-        setNodeList(iNodeList);
+    void Capacitor::setCapacitance(const double dCapacitance) {
+        if (dCapacitance <= 0) {
+            cout << "Capacitance value must be greater than 0!" << endl;
+            throw invalid_argument("Capacitance value must be greater than 0!");
+        }
+        m_dCapacitance = dCapacitance;
     }
 
-    void Capacitor::LNS_initalize(Matrix<double>& oConductanceMatrix, const double dTimeStep) {
+    void Capacitor::LNS_initalize(SparseMatrix<double>& oConductanceMatrix, const double dTimeStep) {
         m_dThrough = 0;
         m_dVoltageDelta = 0;
+        m_oErrorEstimator.reset(0);
         applySimulationMatrixStamp(oConductanceMatrix, dTimeStep);
     }
 
-    void Capacitor::applySimulationMatrixStamp(Matrix<double>& oConductanceMatrix, const double dTimeStep) {
+    void Capacitor::applySimulationMatrixStamp(SparseMatrix<double>& oConductanceMatrix, const double dTimeStep) {
         double dResistance;
 
+        m_dTimeStep = dTimeStep;
         m_dComponentSimulationMatrixStamp = (2.0 * m_dCapacitance) / dTimeStep;
 
         dResistance = oConductanceMatrix(m_iNodeS, m_iNodeS);
@@ -80,13 +88,46 @@ namespace SimulationEngine {
         oSourceVector(m_iNodeD, 0) = dCurrent - m_dThrough;
     };
 
-    void Capacitor::LNS_step(Matrix<double>& oSourceVector) { // Trapezoidal integration
+    void Capacitor::LNS_step(Matrix<double>& oSourceVector, const double dTime) { // Trapezoidal integration
+        m_dPreviousVoltageDelta = m_dVoltageDelta;
+        m_dPreviousThrough = m_dThrough;
         applyThroughVectorMatrixStamp(oSourceVector);
     }
 
+    void Capacitor::renumberNodes(const std::unordered_map<size_t, size_t>& oNodeIndices) {
+        LinearCircuitSimComponent::renumberNodes(oNodeIndices);
+        m_iNodeS = getNode(0);
+        m_iNodeD = getNode(1);
+    }
+
     void Capacitor::LNS_postStep(Matrix<double>& oVoltageMatrix) {
         m_dVoltageDelta = (oVoltageMatrix(m_iNodeS, 0) - oVoltageMatrix(m_iNodeD, 0));
         m_dThrough = m_dComponentSimulationMatrixStamp * (m_dVoltageDelta) -m_dThrough; // i(t) = 2C/dt*v(t) - 2C/dt*v(t-1) - i(t-1), m_dThrough = 2C/dt*v(t-1) + i(t-1)
+        m_oErrorEstimator.addSample(m_dVoltageDelta, m_dTimeStep);
+    }
+
+    double Capacitor::LNS_getTruncationError(const double dRelativeTolerance, const double dAbsoluteTolerance) const {
+        return m_oErrorEstimator.getError() / (dRelativeTolerance * std::abs(m_dVoltageDelta) + dAbsoluteTolerance);
+    }
+
+    void Capacitor::LNS_rejectStep() {
+        m_dVoltageDelta = m_dPreviousVoltageDelta;
+        m_dThrough = m_dPreviousThrough;
+        m_oErrorEstimator.removeSample();
+    }
+
+    void Capacitor::LNS_initalizeDC(SparseMatrix<double>& oConductanceMatrix) { // Open circuit
+        stampConductance(oConductanceMatrix, m_iNodeS, m_iNodeD, m_dCapacitance / dDC_OPEN_TIME_CONSTANT);
+    }
+
+    void Capacitor::LNS_stepDC(Matrix<double>& oSourceVector) {
+        ; // No source in DC
+    }
+
+    void Capacitor::LNS_postStepDC(Matrix<double>& oVoltageMatrix) {
+        m_dVoltageDelta = (oVoltageMatrix(m_iNodeS, 0) - oVoltageMatrix(m_iNodeD, 0));
+        m_dThrough = 0; // A transient started from here begins with v(t-1) = DC voltage and i(t-1) = 0
+        m_oErrorEstimator.reset(m_dVoltageDelta);
     }
 
 }
\ No newline at end of file
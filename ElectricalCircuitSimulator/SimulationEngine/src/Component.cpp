@@ -1,4 +1,5 @@
 #include "Component.h"
+#include <cmath>
 #include <iostream>
 
 using std::cout;
@@ -7,58 +8,162 @@ using std::invalid_argument;
 
 namespace SimulationEngine {
 
-    NodeSimComponent::NodeSimComponent(const size_t iNodeList) :
-        m_iNodeList(iNodeList)
+    TrapezoidalErrorEstimator::TrapezoidalErrorEstimator() :
+        m_iNumSamples(0),
+        m_oValues{},
+        m_oTimeSteps{} { ; }
+
+    void TrapezoidalErrorEstimator::reset(const double dValue) {
+        m_iNumSamples = 1;
+        m_oValues[0] = dValue;
+        m_oTimeSteps[0] = 0;
+    }
+
+    void TrapezoidalErrorEstimator::addSample(const double dValue, const double dTimeStep) {
+        size_t iIndex;
+
+        for (iIndex = NUM_SAMPLES - 1; iIndex > 0; iIndex--) {
+            m_oValues[iIndex] = m_oValues[iIndex - 1];
+            m_oTimeSteps[iIndex] = m_oTimeSteps[iIndex - 1];
+        }
+        m_oValues[0] = dValue;
+        m_oTimeSteps[0] = dTimeStep;
+        if (m_iNumSamples < NUM_SAMPLES) {
+            m_iNumSamples++;
+        }
+    }
+
+    void TrapezoidalErrorEstimator::removeSample() {
+        size_t iIndex;
+
+        if (m_iNumSamples == 0) {
+            return;
+        }
+        for (iIndex = 0; iIndex < NUM_SAMPLES - 1; iIndex++) {
+            m_oValues[iIndex] = m_oValues[iIndex + 1];
+            m_oTimeSteps[iIndex] = m_oTimeSteps[iIndex + 1];
+        }
+        m_iNumSamples--;
+    }
+
+    double TrapezoidalErrorEstimator::getError() const {
+        double dDifference1A;
+        double dDifference1B;
+        double dDifference1C;
+        double dDifference2A;
+        double dDifference2B;
+        double dDifference3;
+
+        if (m_iNumSamples < 4) {
+            return 0;
+        }
+
+        dDifference1A = (m_oValues[0] - m_oValues[1]) / m_oTimeSteps[0];
+        dDifference1B = (m_oValues[1] - m_oValues[2]) / m_oTimeSteps[1];
+        dDifference1C = (m_oValues[2] - m_oValues[3]) / m_oTimeSteps[2];
+        dDifference2A = (dDifference1A - dDifference1B) / (m_oTimeSteps[0] + m_oTimeSteps[1]);
+        dDifference2B = (dDifference1B - dDifference1C) / (m_oTimeSteps[1] + m_oTimeSteps[2]);
+        dDifference3 = (dDifference2A - dDifference2B) / (m_oTimeSteps[0] + m_oTimeSteps[1] + m_oTimeSteps[2]);
+
+        return std::abs(m_oTimeSteps[0] * m_oTimeSteps[0] * m_oTimeSteps[0] * dDifference3) / 2.0; // h^3/12 * 6 * DD3
+    }
+
+    NodeSimComponent::NodeSimComponent(std::initializer_list<size_t> oNodes) :
+        m_iNumNodes(0),
+        m_oInlineNodes{}
     {
+        setNodes(std::span<const size_t>(oNodes.begin(), oNodes.size()));
+    }
+
+    void NodeSimComponent::setNodes(std::span<const size_t> oNodes) {
         size_t iNodeIndex1;
         size_t iNodeIndex2;
-        size_t iNumNodes = getNumNodes();
 
-        for (iNodeIndex1 = 0; iNodeIndex1 < iNumNodes; iNodeIndex1++) {
-            for (iNodeIndex2 = iNodeIndex1 + 1; iNodeIndex2 < iNumNodes; iNodeIndex2++) {
-                if (getNode(iNodeIndex1) == getNode(iNodeIndex2)) {
+        for (iNodeIndex1 = 0; iNodeIndex1 < oNodes.size(); iNodeIndex1++) {
+            for (iNodeIndex2 = iNodeIndex1 + 1; iNodeIndex2 < oNodes.size(); iNodeIndex2++) {
+                if (oNodes[iNodeIndex1] == oNodes[iNodeIndex2]) {
                     cout << "Two node values must not be the same!" << endl;
                     throw invalid_argument("Two node values must not be the same!");
                 }
             }
         }
+
+        m_iNumNodes = oNodes.size();
+        m_oOverflowNodes.clear();
+        for (iNodeIndex1 = 0; iNodeIndex1 < m_iNumNodes; iNodeIndex1++) {
+            if (iNodeIndex1 < INLINE_NODES) {
+                m_oInlineNodes[iNodeIndex1] = oNodes[iNodeIndex1];
+            } else {
+                m_oOverflowNodes.push_back(oNodes[iNodeIndex1]);
+            }
+        }
     }
 
     // If the component has an across reference node, iNodeS is assumed to be that node
-    LinearNaturalSimComponent::LinearNaturalSimComponent(const size_t iNodeList, const bool bHasAcrossReferenceNode, const size_t iAcrossReferenceNode) :
-        NodeSimComponent::NodeSimComponent(iNodeList),
+    LinearNaturalSimComponent::LinearNaturalSimComponent(std::initializer_list<size_t> oNodes, const bool bHasAcrossReferenceNode, const size_t iAcrossReferenceNode) :
+        NodeSimComponent::NodeSimComponent(oNodes),
         m_bHasAcrossReferenceNode(bHasAcrossReferenceNode),
         m_iAcrossReferenceNode(iAcrossReferenceNode),
         m_dComponentSimulationMatrixStamp(0.0),
         m_dThrough(0.0) { ; }
 
-    size_t NodeSimComponent::getNumNodes() const {
-        size_t iNumNodes = 1; // The zero node always exists somewhere
-        size_t iNode;
+    void NodeSimComponent::renumberNodes(const std::unordered_map<size_t, size_t>& oNodeIndices) {
+        size_t iNodeIndex;
 
-        for (iNode = 0; iNode < MAX_NODES; iNode++) {
-            if (((m_iNodeList >> (BITS_PER_NODE * iNode)) & NODE_BITMASK) != 0) {
-                iNumNodes++;
+        for (iNodeIndex = 0; iNodeIndex < m_iNumNodes; iNodeIndex++) {
+            if (iNodeIndex < INLINE_NODES) {
+                m_oInlineNodes[iNodeIndex] = oNodeIndices.at(m_oInlineNodes[iNodeIndex]);
+            } else {
+                m_oOverflowNodes[iNodeIndex - INLINE_NODES] = oNodeIndices.at(m_oOverflowNodes[iNodeIndex - INLINE_NODES]);
             }
         }
+    }
 
-        return iNumNodes;
+    void LinearNaturalSimComponent::renumberNodes(const std::unordered_map<size_t, size_t>& oNodeIndices) {
+        NodeSimComponent::renumberNodes(oNodeIndices);
+        if (m_bHasAcrossReferenceNode) {
+            m_iAcrossReferenceNode = oNodeIndices.at(m_iAcrossReferenceNode);
+        }
+        // Branches are only set after the first renumbering (user nodes), later renumberings move them with the nodes
+        for (size_t& iBranch : m_oBranches) {
+            if (iBranch != NO_BRANCH) {
+                iBranch = oNodeIndices.at(iBranch);
+            }
+        }
+    }
+
+    size_t LinearNaturalSimComponent::LNS_getBranch(const size_t iBranchIndex) const {
+        if (iBranchIndex >= m_oBranches.size()) {
+            cout << "Index is out of bounds!" << endl;
+            throw invalid_argument("Index is out of bounds!");
+        }
+
+        return m_oBranches[iBranchIndex];
+    }
+
+    void LinearNaturalSimComponent::LNS_setBranch(const size_t iBranchIndex, const size_t iIndex) {
+        if (iBranchIndex >= m_oBranches.size()) {
+            cout << "Index is out of bounds!" << endl;
+            throw invalid_argument("Index is out of bounds!");
+        }
+
+        m_oBranches[iBranchIndex] = iIndex;
     }
 
     size_t NodeSimComponent::getNode(const size_t iNodeIndex) const {
-        if ((iNodeIndex >= getNumNodes()) || (iNodeIndex >= MAX_NODES)) {
+        if (iNodeIndex >= m_iNumNodes) {
             cout << "Index is out of bounds!" << endl;
             throw invalid_argument("Index is out of bounds!");
         }
 
-        return (m_iNodeList >> (BITS_PER_NODE * iNodeIndex)) & NODE_BITMASK;
+        return (iNodeIndex < INLINE_NODES) ? m_oInlineNodes[iNodeIndex] : m_oOverflowNodes[iNodeIndex - INLINE_NODES];
     }
 
     void DiscreteEventTimeDomainSimComponent::DETDS_initalize(const double dTimeStep) {
         ;
     }
 
-    void LinearNaturalSimComponent::LNS_initalize(Matrix<double>& oSimulationMatrix, const double dTimeStep) {
+    void LinearNaturalSimComponent::LNS_initalize(SparseMatrix<double>& oSimulationMatrix, const double dTimeStep) {
         ;
     }
 
@@ -66,7 +171,7 @@ namespace SimulationEngine {
         ;
     }
 
-    void LinearNaturalSimComponent::LNS_step(Matrix<double>& oThroughVector) {
+    void LinearNaturalSimComponent::LNS_step(Matrix<double>& oThroughVector, const double dTime) {
         ;
     }
 
@@ -74,7 +179,49 @@ namespace SimulationEngine {
         ;
     }
 
-    void LinearNaturalSimComponent::applySimulationMatrixStamp(Matrix<double>& oConoSimulationMatrixductanceMatrix, const double dTimeStep) {
+    bool LinearNaturalSimComponent::LNS_isDynamic() const {
+        return true; // Safe default, the component is restamped every step
+    }
+
+    void LinearNaturalSimComponent::LNS_restamp(SparseMatrix<double>& oSimulationMatrix, const double dTimeStep) {
+        applySimulationMatrixStamp(oSimulationMatrix, dTimeStep);
+    }
+
+    double LinearNaturalSimComponent::LNS_getTruncationError(const double dRelativeTolerance, const double dAbsoluteTolerance) const {
+        return 0; // No history state, nothing to integrate
+    }
+
+    void LinearNaturalSimComponent::LNS_rejectStep() {
+        ;
+    }
+
+    void LinearNaturalSimComponent::LNS_initalizeDC(SparseMatrix<double>& oSimulationMatrix) {
+        applySimulationMatrixStamp(oSimulationMatrix, 0); // Time step independent
+    }
+
+    void LinearNaturalSimComponent::LNS_stepDC(Matrix<double>& oThroughVector) {
+        LNS_step(oThroughVector, 0); // The operating point is at time 0
+    }
+
+    void LinearNaturalSimComponent::LNS_postStepDC(Matrix<double>& oAcrossVector) {
+        LNS_postStep(oAcrossVector);
+    }
+
+    void LinearNaturalSimComponent::stampConductance(SparseMatrix<double>& oSimulationMatrix, const size_t iNodeS, const size_t iNodeD, const double dConductance) {
+        oSimulationMatrix(iNodeS, iNodeS) = oSimulationMatrix(iNodeS, iNodeS) + dConductance;
+        oSimulationMatrix(iNodeS, iNodeD) = oSimulationMatrix(iNodeS, iNodeD) - dConductance;
+        oSimulationMatrix(iNodeD, iNodeS) = oSimulationMatrix(iNodeD, iNodeS) - dConductance;
+        oSimulationMatrix(iNodeD, iNodeD) = oSimulationMatrix(iNodeD, iNodeD) + dConductance;
+    }
+
+    void LinearNaturalSimComponent::stampBranch(SparseMatrix<double>& oSimulationMatrix, const size_t iNodeS, const size_t iNodeD, const size_t iBranch) {
+        oSimulationMatrix(iNodeS, iBranch) = oSimulationMatrix(iNodeS, iBranch) + 1.0;
+        oSimulationMatrix(iNodeD, iBranch) = oSimulationMatrix(iNodeD, iBranch) - 1.0;
+        oSimulationMatrix(iBranch, iNodeD) = oSimulationMatrix(iBranch, iNodeD) + 1.0;
+        oSimulationMatrix(iBranch, iNodeS) = oSimulationMatrix(iBranch, iNodeS) - 1.0;
+    }
+
+    void LinearNaturalSimComponent::applySimulationMatrixStamp(SparseMatrix<double>& oConoSimulationMatrixductanceMatrix, const double dTimeStep) {
         ;
     }
 
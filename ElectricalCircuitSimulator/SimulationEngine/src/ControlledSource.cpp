@@ -0,0 +1,153 @@
+// These components are based on the equations:
+//     VCVS: v(t) = A * vc(t)
+//     VCCS: i(t) = G * vc(t)
+//     CCCS: i(t) = B * ic(t)
+//     CCVS: v(t) = R * ic(t)
+//     i(t) is the output current going from - to + inside the source.
+//     v(t) is the output voltage potential from - to +.
+//     vc(t) is the control voltage potential from control - to control +.
+//     ic(t) is the control current going from control - to control + through a zero volt sense branch.
+// Output currents of voltage outputs and every ic(t) are branch unknowns solved together with the node voltages.
+// Matrix stamp adds the branch currents to the current sums of their nodes, the branch rows (v(+) - v(-) minus the
+// controlling term) and for the VCCS the transconductance terms. Nothing is stamped in the source vector.
+// Post step calculates i(t) for the current step.
+// iNodeS and iControlNodeS are (-), iNodeD and iControlNodeD are (+).
+
+// AcrossReferenceNode = Circuit Ground
+// ComponentSimulationMatrixStamp = Gain
+// applyThroughVectorMatrixStamp = Unused
+// Across = Voltage (V)
+// Through = Current (A)
+
+#include "ControlledSource.h"
+#include <algorithm>
+#include <iostream>
+
+using std::cout;
+using std::endl;
+using std::invalid_argument;
+
+namespace SimulationEngine {
+
+    ControlledSource::ControlledSource(const size_t iNodeS, const size_t iNodeD, const size_t iControlNodeS, const size_t iControlNodeD, const double dGain, const size_t iNumBranches) :
+        LinearCircuitSimComponent({}, false, iNodeS),
+        m_iNodeS(iNodeS),
+        m_iNodeD(iNodeD),
+        m_iControlNodeS(iControlNodeS),
+        m_iControlNodeD(iControlNodeD),
+        m_dGain(dGain),
+        m_oTerminalNodeIndices{}
+    {
+        size_t iTerminalIndex;
+        std::array<size_t, 4> oTerminals = { iNodeS, iNodeD, iControlNodeS, iControlNodeD };
+        std::vector<size_t> oNodes;
+
+        if (iNodeS == iNodeD || iControlNodeS == iControlNodeD) {
+            cout << "Two node values must not be the same!" << endl;
+            throw invalid_argument("Two node values must not be the same!");
+        }
+
+        for (iTerminalIndex = 0; iTerminalIndex < oTerminals.size(); iTerminalIndex++) {
+            m_oTerminalNodeIndices[iTerminalIndex] = std::find(oNodes.begin(), oNodes.end(), oTerminals[iTerminalIndex]) - oNodes.begin();
+            if (m_oTerminalNodeIndices[iTerminalIndex] == oNodes.size()) {
+                oNodes.push_back(oTerminals[iTerminalIndex]);
+            }
+        }
+        setNodes(oNodes);
+        m_oBranches.assign(iNumBranches, NO_BRANCH);
+    }
+
+    void ControlledSource::setGain(const double dGain) {
+        m_dGain = dGain;
+    }
+
+    void ControlledSource::LNS_initalize(SparseMatrix<double>& oSimulationMatrix, const double dTimeStep) {
+        m_dThrough = 0;
+        applySimulationMatrixStamp(oSimulationMatrix, dTimeStep);
+    }
+
+    bool ControlledSource::LNS_isDynamic() const {
+        return false;
+    }
+
+    void ControlledSource::renumberNodes(const std::unordered_map<size_t, size_t>& oNodeIndices) {
+        LinearCircuitSimComponent::renumberNodes(oNodeIndices);
+        updateTerminalNodes();
+    }
+
+    void ControlledSource::updateTerminalNodes() {
+        m_iNodeS = getNode(m_oTerminalNodeIndices[0]);
+        m_iNodeD = getNode(m_oTerminalNodeIndices[1]);
+        m_iControlNodeS = getNode(m_oTerminalNodeIndices[2]);
+        m_iControlNodeD = getNode(m_oTerminalNodeIndices[3]);
+    }
+
+    VoltageControlledVoltageSource::VoltageControlledVoltageSource(const size_t iNodeS, const size_t iNodeD, const size_t iControlNodeS, const size_t iControlNodeD, const double dGain) :
+        ControlledSource(iNodeS, iNodeD, iControlNodeS, iControlNodeD, dGain, 1) { ; }
+
+    void VoltageControlledVoltageSource::applySimulationMatrixStamp(SparseMatrix<double>& oSimulationMatrix, const double dTimeStep) {
+        size_t iBranch = m_oBranches[0];
+
+        m_dComponentSimulationMatrixStamp = m_dGain;
+
+        stampBranch(oSimulationMatrix, m_iNodeS, m_iNodeD, iBranch);
+        oSimulationMatrix(iBranch, m_iControlNodeD) = oSimulationMatrix(iBranch, m_iControlNodeD) - m_dComponentSimulationMatrixStamp;
+        oSimulationMatrix(iBranch, m_iControlNodeS) = oSimulationMatrix(iBranch, m_iControlNodeS) + m_dComponentSimulationMatrixStamp;
+    }
+
+    void VoltageControlledVoltageSource::LNS_postStep(Matrix<double>& oAcrossVector) {
+        m_dThrough = oAcrossVector(m_oBranches[0], 0);
+    }
+
+    VoltageControlledCurrentSource::VoltageControlledCurrentSource(const size_t iNodeS, const size_t iNodeD, const size_t iControlNodeS, const size_t iControlNodeD, const double dTransconductance) :
+        ControlledSource(iNodeS, iNodeD, iControlNodeS, iControlNodeD, dTransconductance, 0) { ; }
+
+    void VoltageControlledCurrentSource::applySimulationMatrixStamp(SparseMatrix<double>& oSimulationMatrix, const double dTimeStep) {
+        m_dComponentSimulationMatrixStamp = m_dGain;
+
+        oSimulationMatrix(m_iNodeS, m_iControlNodeD) = oSimulationMatrix(m_iNodeS, m_iControlNodeD) + m_dComponentSimulationMatrixStamp;
+        oSimulationMatrix(m_iNodeS, m_iControlNodeS) = oSimulationMatrix(m_iNodeS, m_iControlNodeS) - m_dComponentSimulationMatrixStamp;
+        oSimulationMatrix(m_iNodeD, m_iControlNodeD) = oSimulationMatrix(m_iNodeD, m_iControlNodeD) - m_dComponentSimulationMatrixStamp;
+        oSimulationMatrix(m_iNodeD, m_iControlNodeS) = oSimulationMatrix(m_iNodeD, m_iControlNodeS) + m_dComponentSimulationMatrixStamp;
+    }
+
+    void VoltageControlledCurrentSource::LNS_postStep(Matrix<double>& oAcrossVector) {
+        m_dThrough = m_dGain * (oAcrossVector(m_iControlNodeD, 0) - oAcrossVector(m_iControlNodeS, 0));
+    }
+
+    CurrentControlledCurrentSource::CurrentControlledCurrentSource(const size_t iNodeS, const size_t iNodeD, const size_t iControlNodeS, const size_t iControlNodeD, const double dGain) :
+        ControlledSource(iNodeS, iNodeD, iControlNodeS, iControlNodeD, dGain, 1) { ; }
+
+    void CurrentControlledCurrentSource::applySimulationMatrixStamp(SparseMatrix<double>& oSimulationMatrix, const double dTimeStep) {
+        size_t iSenseBranch = m_oBranches[0];
+
+        m_dComponentSimulationMatrixStamp = m_dGain;
+
+        stampBranch(oSimulationMatrix, m_iControlNodeS, m_iControlNodeD, iSenseBranch);
+        oSimulationMatrix(m_iNodeS, iSenseBranch) = oSimulationMatrix(m_iNodeS, iSenseBranch) + m_dComponentSimulationMatrixStamp;
+        oSimulationMatrix(m_iNodeD, iSenseBranch) = oSimulationMatrix(m_iNodeD, iSenseBranch) - m_dComponentSimulationMatrixStamp;
+    }
+
+    void CurrentControlledCurrentSource::LNS_postStep(Matrix<double>& oAcrossVector) {
+        m_dThrough = m_dGain * oAcrossVector(m_oBranches[0], 0);
+    }
+
+    CurrentControlledVoltageSource::CurrentControlledVoltageSource(const size_t iNodeS, const size_t iNodeD, const size_t iControlNodeS, const size_t iControlNodeD, const double dTransresistance) :
+        ControlledSource(iNodeS, iNodeD, iControlNodeS, iControlNodeD, dTransresistance, 2) { ; }
+
+    void CurrentControlledVoltageSource::applySimulationMatrixStamp(SparseMatrix<double>& oSimulationMatrix, const double dTimeStep) {
+        size_t iSenseBranch = m_oBranches[0];
+        size_t iBranch = m_oBranches[1];
+
+        m_dComponentSimulationMatrixStamp = m_dGain;
+
+        stampBranch(oSimulationMatrix, m_iControlNodeS, m_iControlNodeD, iSenseBranch);
+        stampBranch(oSimulationMatrix, m_iNodeS, m_iNodeD, iBranch);
+        oSimulationMatrix(iBranch, iSenseBranch) = oSimulationMatrix(iBranch, iSenseBranch) - m_dComponentSimulationMatrixStamp;
+    }
+
+    void CurrentControlledVoltageSource::LNS_postStep(Matrix<double>& oAcrossVector) {
+        m_dThrough = oAcrossVector(m_oBranches[1], 0);
+    }
+
+}
@@ -0,0 +1,75 @@
+// This component is based on the equation: i(t) = I
+//     i(t) is the component current going from - to + inside the source.
+//     I is the source current, constant or a waveform of the simulation time evaluated at the end of the step.
+// There is no matrix stamp, the source vector stamp injects I into (+) and draws it from (-).
+// Post step sets i(t) for the current step.
+// iNodeS is (-), iNodeD is (+).
+
+// AcrossReferenceNode = Circuit Ground
+// ComponentSimulationMatrixStamp = Unused
+// applyThroughVectorMatrixStamp = Component Current Vector Stamp
+// Across = Voltage (V)
+// Through = Current (A)
+
+#include "CurrentSource.h"
+
+namespace SimulationEngine {
+
+    CurrentSource::CurrentSource(const size_t iNodeS, const size_t iNodeD, const double dCurrent) :
+        LinearCircuitSimComponent({ iNodeS, iNodeD }, false, iNodeS),
+        m_iNodeS(iNodeS),
+        m_iNodeD(iNodeD),
+        m_oCurrent(dCurrent) { ; }
+
+    void CurrentSource::setCurrent(const double dCurrent) {
+        m_oCurrent.setValue(dCurrent);
+    }
+
+    void CurrentSource::setCurrentWaveform(std::shared_ptr<const SourceWaveform> pWaveform) {
+        m_oCurrent.setWaveform(std::move(pWaveform));
+    }
+
+    void CurrentSource::LNS_initalize(SparseMatrix<double>& oSimulationMatrix, const double dTimeStep) {
+        m_dThrough = 0;
+        m_oCurrent.update(0);
+    }
+
+    void CurrentSource::applyThroughVectorMatrixStamp(Matrix<double>& oThroughVector) {
+        double dCurrent;
+
+        dCurrent = oThroughVector(m_iNodeS, 0);
+        oThroughVector(m_iNodeS, 0) = dCurrent - m_oCurrent.getValue();
+
+        dCurrent = oThroughVector(m_iNodeD, 0);
+        oThroughVector(m_iNodeD, 0) = dCurrent + m_oCurrent.getValue();
+    };
+
+    void CurrentSource::LNS_step(Matrix<double>& oThroughVector, const double dTime) {
+        m_oCurrent.update(dTime);
+        applyThroughVectorMatrixStamp(oThroughVector);
+    }
+
+    void CurrentSource::LNS_initalizeDC(SparseMatrix<double>& oSimulationMatrix) {
+        ; // An ideal current source has no conductance, its current is stamped by LNS_stepDC
+    }
+
+    void CurrentSource::LNS_stepDC(Matrix<double>& oThroughVector) {
+        m_oCurrent.update(0); // The operating point is at time 0
+        applyThroughVectorMatrixStamp(oThroughVector);
+    }
+
+    void CurrentSource::renumberNodes(const std::unordered_map<size_t, size_t>& oNodeIndices) {
+        LinearCircuitSimComponent::renumberNodes(oNodeIndices);
+        m_iNodeS = getNode(0);
+        m_iNodeD = getNode(1);
+    }
+
+    bool CurrentSource::LNS_isDynamic() const {
+        return m_oCurrent.isTimeVarying();
+    }
+
+    void CurrentSource::LNS_postStep(Matrix<double>& oAcrossVector) {
+        m_dThrough = m_oCurrent.getValue();
+    }
+
+}
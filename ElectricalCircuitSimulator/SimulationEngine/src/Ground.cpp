@@ -0,0 +1,19 @@
+// This component has no equation, it only sets the across reference node of its island to 0 V.
+// There is no matrix or source vector stamp and the current is always 0.
+
+// AcrossReferenceNode = Circuit Ground
+// Across = Voltage (V)
+// Through = Current (A)
+
+#include "Ground.h"
+
+namespace SimulationEngine {
+
+    Ground::Ground(const size_t iNode) :
+        LinearCircuitSimComponent({ iNode }, true, iNode) { ; }
+
+    bool Ground::LNS_isDynamic() const {
+        return false;
+    }
+
+}
@@ -1,13 +1,14 @@
 // This component is based on the equation: i(t) = 1/R * v(t) - I
 //     i(t) is the component current going from + to -.
 //     v(t) is the voltage potential from - to +.
-//     I is the internal source current going from - to +.
+//     I is the internal source current going from - to +, I = V/R.
+//     V is the source voltage, constant or a waveform of the simulation time evaluated at the end of the step.
 //     R is the internal source resistance.
 // Matrix stamp is based on the i(t) equation for the current time step. i(t) = (Conductance Matrix Stamp) * v(t) - ((+)Node Source Vector Stamp)
 // Conductance matrix stamp uses the 1/R term (internal resistance).
 // Source vector stamp uses the I term (internal current source).
 // Post step calculates i(t) for the current step.
-// iNodeS is assumed to be ground (-), iNodeD is assumed to be (+).
+// iNodeS is (-) and the across reference node of its island, iNodeD is (+). The voltage may have either sign.
 
 // AcrossReferenceNode = Circuit Ground
 // ComponentSimulationMatrixStamp = Component Resistance Matrix Stamp
@@ -25,34 +26,41 @@ using std::invalid_argument;
 namespace SimulationEngine {
 
     GroundedVoltageSource::GroundedVoltageSource(const size_t iNodeS, const size_t iNodeD, const double dVoltage, const double dResistance) :
-        LinearCircuitSimComponent(0, true, iNodeS),
+        LinearCircuitSimComponent({ iNodeS, iNodeD }, true, iNodeS),
         m_iNodeS(iNodeS),
         m_iNodeD(iNodeD),
-        m_dVoltage(dVoltage),
+        m_oVoltage(dVoltage),
         m_dResistance(dResistance)
     {
-        size_t iNodeList = 0;
-
         if (dResistance <= 0) {
             cout << "Resistance value must be greater than 0!" << endl;
             throw invalid_argument("Resistance value must be greater than 0!");
         }
-        if (dVoltage <= 0) {
-            cout << "Voltage value must be greater than 0!" << endl;
-            throw invalid_argument("Voltage value must be greater than 0!");
-        }
+    }
+
+    void GroundedVoltageSource::setVoltage(const double dVoltage) {
+        m_oVoltage.setValue(dVoltage);
+    }
 
-        iNodeList += (m_iNodeS << (0 * BITS_PER_NODE));
-        iNodeList += (m_iNodeD << (1 * BITS_PER_NODE));
-        setNodeList(iNodeList);
+    void GroundedVoltageSource::setVoltageWaveform(std::shared_ptr<const SourceWaveform> pWaveform) {
+        m_oVoltage.setWaveform(std::move(pWaveform));
+    }
+
+    void GroundedVoltageSource::setResistance(const double dResistance) {
+        if (dResistance <= 0) {
+            cout << "Resistance value must be greater than 0!" << endl;
+            throw invalid_argument("Resistance value must be greater than 0!");
+        }
+        m_dResistance = dResistance;
     }
 
-    void GroundedVoltageSource::LNS_initalize(Matrix<double>& oConductanceMatrix, const double dTimeStep) {
+    void GroundedVoltageSource::LNS_initalize(SparseMatrix<double>& oConductanceMatrix, const double dTimeStep) {
         m_dThrough = 0;
+        m_oVoltage.update(0);
         applySimulationMatrixStamp(oConductanceMatrix, dTimeStep);
     }
 
-    void GroundedVoltageSource::applySimulationMatrixStamp(Matrix<double>& oConductanceMatrix, const double dTimeStep) {
+    void GroundedVoltageSource::applySimulationMatrixStamp(SparseMatrix<double>& oConductanceMatrix, const double dTimeStep) {
         double dResistance;
 
         m_dComponentSimulationMatrixStamp = 1.0 / m_dResistance;
@@ -74,7 +82,7 @@ namespace SimulationEngine {
         double dCurrent;
         double dComponentCurrentStamp;
 
-        dComponentCurrentStamp = m_dVoltage / m_dResistance;
+        dComponentCurrentStamp = m_oVoltage.getValue() / m_dResistance;
 
         dCurrent = oSourceVector(m_iNodeS, 0);
         oSourceVector(m_iNodeS, 0) = dCurrent - dComponentCurrentStamp;
@@ -83,12 +91,32 @@ namespace SimulationEngine {
         oSourceVector(m_iNodeD, 0) = dCurrent + dComponentCurrentStamp;
     };
 
-    void GroundedVoltageSource::LNS_step(Matrix<double>& oSourceVector) {
+    void GroundedVoltageSource::LNS_step(Matrix<double>& oSourceVector, const double dTime) {
+        m_oVoltage.update(dTime);
+        applyThroughVectorMatrixStamp(oSourceVector);
+    }
+
+    void GroundedVoltageSource::LNS_initalizeDC(SparseMatrix<double>& oConductanceMatrix) {
+        stampConductance(oConductanceMatrix, m_iNodeS, m_iNodeD, 1.0 / m_dResistance); // Source resistance, the same in DC as in the transient
+    }
+
+    void GroundedVoltageSource::LNS_stepDC(Matrix<double>& oSourceVector) {
+        m_oVoltage.update(0); // The operating point is at time 0
         applyThroughVectorMatrixStamp(oSourceVector);
     }
 
+    void GroundedVoltageSource::renumberNodes(const std::unordered_map<size_t, size_t>& oNodeIndices) {
+        LinearCircuitSimComponent::renumberNodes(oNodeIndices);
+        m_iNodeS = getNode(0);
+        m_iNodeD = getNode(1);
+    }
+
+    bool GroundedVoltageSource::LNS_isDynamic() const {
+        return m_oVoltage.isTimeVarying();
+    }
+
     void GroundedVoltageSource::LNS_postStep(Matrix<double>& oVoltageMatrix) {
-        m_dThrough = (m_dVoltage - (oVoltageMatrix(m_iNodeD, 0) - oVoltageMatrix(m_iNodeS, 0))) / m_dResistance;
+        m_dThrough = (m_oVoltage.getValue() - (oVoltageMatrix(m_iNodeD, 0) - oVoltageMatrix(m_iNodeS, 0))) / m_dResistance;
     }
 
 }
@@ -17,6 +17,7 @@
 // Through = Current (A)
 
 #include "Inductor.h"
+#include <cmath>
 #include <iostream>
 
 using std::cout;
@@ -26,34 +27,40 @@ using std::invalid_argument;
 namespace SimulationEngine {
 
     Inductor::Inductor(const size_t iNodeS, const size_t iNodeD, const double dInductance) :
-        LinearCircuitSimComponent(0, false, iNodeS),
+        LinearCircuitSimComponent({ iNodeS, iNodeD }, false, iNodeS),
         m_iNodeS(iNodeS),
         m_iNodeD(iNodeD),
         m_dInductance(dInductance),
-        m_dVoltageDelta(0)
+        m_dVoltageDelta(0),
+        m_dTimeStep(0),
+        m_dPreviousVoltageDelta(0),
+        m_dPreviousThrough(0)
     {
-        size_t iNodeList = 0;
-
         if (dInductance <= 0) {
             cout << "Inductance value must be greater than 0!" << endl;
             throw invalid_argument("Inductance value must be greater than 0!");
         }
+    }
 
-        iNodeList += (m_iNodeS << (0 * BITS_PER_NODE));
-        iNodeList += (m_iNodeD << (1 * BITS_PER_NODE));
-        setNodeList(iNodeList);
-        LinearCircuitSimComponent(iNodeList, false, m_iNodeS);
+    void Inductor::setInductance(const double dInductance) {
+        if (dInductance <= 0) {
+            cout << "Inductance value must be greater than 0!" << endl;
+            throw invalid_argument("Inductance value must be greater than 0!");
+        }
+        m_dInductance = dInductance;
     }
 
-    void Inductor::LNS_initalize(Matrix<double>& oConductanceMatrix, const double dTimeStep) {
+    void Inductor::LNS_initalize(SparseMatrix<double>& oConductanceMatrix, const double dTimeStep) {
         m_dThrough = 0;
         m_dVoltageDelta = 0;
+        m_oErrorEstimator.reset(0);
         applySimulationMatrixStamp(oConductanceMatrix, dTimeStep);
     }
 
-    void Inductor::applySimulationMatrixStamp(Matrix<double>& oConductanceMatrix, const double dTimeStep) {
+    void Inductor::applySimulationMatrixStamp(SparseMatrix<double>& oConductanceMatrix, const double dTimeStep) {
         double dResistance;
 
+        m_dTimeStep = dTimeStep;
         m_dComponentSimulationMatrixStamp = dTimeStep / (2.0 * m_dInductance);
 
         dResistance = oConductanceMatrix(m_iNodeS, m_iNodeS);
@@ -81,13 +88,46 @@ namespace SimulationEngine {
         oSourceVector(m_iNodeD, 0) = dCurrent + m_dThrough;
     };
 
-    void Inductor::LNS_step(Matrix<double>& oSourceVector) { // Trapezoidal integration
+    void Inductor::LNS_step(Matrix<double>& oSourceVector, const double dTime) { // Trapezoidal integration
+        m_dPreviousVoltageDelta = m_dVoltageDelta;
+        m_dPreviousThrough = m_dThrough;
         applyThroughVectorMatrixStamp(oSourceVector);
     }
 
+    void Inductor::renumberNodes(const std::unordered_map<size_t, size_t>& oNodeIndices) {
+        LinearCircuitSimComponent::renumberNodes(oNodeIndices);
+        m_iNodeS = getNode(0);
+        m_iNodeD = getNode(1);
+    }
+
     void Inductor::LNS_postStep(Matrix<double>& oVoltageMatrix) {
         m_dVoltageDelta = (oVoltageMatrix(m_iNodeS, 0) - oVoltageMatrix(m_iNodeD, 0));
         m_dThrough = m_dComponentSimulationMatrixStamp * m_dVoltageDelta + m_dThrough; // i(t) = dt/2L*v(t) + dt/2L*v(t-1) + i(t-1), m_dThrough = dt/2L*v(t-1) + i(t-1)
+        m_oErrorEstimator.addSample(m_dThrough, m_dTimeStep);
+    }
+
+    double Inductor::LNS_getTruncationError(const double dRelativeTolerance, const double dAbsoluteTolerance) const {
+        return m_oErrorEstimator.getError() / (dRelativeTolerance * std::abs(m_dThrough) + dAbsoluteTolerance);
+    }
+
+    void Inductor::LNS_rejectStep() {
+        m_dVoltageDelta = m_dPreviousVoltageDelta;
+        m_dThrough = m_dPreviousThrough;
+        m_oErrorEstimator.removeSample();
+    }
+
+    void Inductor::LNS_initalizeDC(SparseMatrix<double>& oConductanceMatrix) { // Short circuit
+        stampConductance(oConductanceMatrix, m_iNodeS, m_iNodeD, dDC_SHORT_CONDUCTANCE);
+    }
+
+    void Inductor::LNS_stepDC(Matrix<double>& oSourceVector) {
+        ; // No source in DC
+    }
+
+    void Inductor::LNS_postStepDC(Matrix<double>& oVoltageMatrix) {
+        m_dVoltageDelta = (oVoltageMatrix(m_iNodeS, 0) - oVoltageMatrix(m_iNodeD, 0));
+        m_dThrough = dDC_SHORT_CONDUCTANCE * m_dVoltageDelta; // A transient started from here begins with i(t-1) = DC current
+        m_oErrorEstimator.reset(m_dThrough);
     }
 
 }
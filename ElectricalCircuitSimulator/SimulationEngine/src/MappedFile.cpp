@@ -0,0 +1,144 @@
+#include "MappedFile.h"
+#include <iostream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using std::cout;
+using std::endl;
+
+namespace SimulationEngine {
+
+    #pragma region Constructors
+
+#ifdef _WIN32
+
+    MappedFile::MappedFile(const std::string& sPath) :
+        m_sPath(sPath),
+        m_pData(nullptr),
+        m_iSize(0),
+        m_hFile(INVALID_HANDLE_VALUE),
+        m_hMapping(nullptr)
+    {
+        LARGE_INTEGER iFileSize;
+
+        m_hFile = CreateFileA(sPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (m_hFile == INVALID_HANDLE_VALUE) {
+            cout << "Could not open file " << sPath << "!" << endl;
+            throw std::exception("Could not open file!");
+        }
+        if (GetFileSizeEx(m_hFile, &iFileSize) == FALSE) {
+            CloseHandle(m_hFile);
+            cout << "Could not read the size of file " << sPath << "!" << endl;
+            throw std::exception("Could not read the size of file!");
+        }
+        m_iSize = static_cast<size_t>(iFileSize.QuadPart);
+        if (m_iSize == 0) {
+            return; // Empty files cannot be mapped
+        }
+
+        m_hMapping = CreateFileMappingA(m_hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (m_hMapping != nullptr) {
+            m_pData = static_cast<const char*>(MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0));
+        }
+        if (m_pData == nullptr) {
+            if (m_hMapping != nullptr) {
+                CloseHandle(m_hMapping);
+            }
+            CloseHandle(m_hFile);
+            cout << "Could not map file " << sPath << "!" << endl;
+            throw std::exception("Could not map file!");
+        }
+    }
+
+    MappedFile::~MappedFile() {
+        if (m_pData != nullptr) {
+            UnmapViewOfFile(m_pData);
+        }
+        if (m_hMapping != nullptr) {
+            CloseHandle(m_hMapping);
+        }
+        if (m_hFile != INVALID_HANDLE_VALUE) {
+            CloseHandle(m_hFile);
+        }
+    }
+
+#else
+
+    MappedFile::MappedFile(const std::string& sPath) :
+        m_sPath(sPath),
+        m_pData(nullptr),
+        m_iSize(0),
+        m_iFileDescriptor(-1)
+    {
+        struct stat oFileStatus;
+        void* pMapping;
+
+        m_iFileDescriptor = open(sPath.c_str(), O_RDONLY);
+        if (m_iFileDescriptor < 0) {
+            cout << "Could not open file " << sPath << "!" << endl;
+            throw std::runtime_error("Could not open file!");
+        }
+        if (fstat(m_iFileDescriptor, &oFileStatus) != 0) {
+            close(m_iFileDescriptor);
+            cout << "Could not read the size of file " << sPath << "!" << endl;
+            throw std::runtime_error("Could not read the size of file!");
+        }
+        m_iSize = static_cast<size_t>(oFileStatus.st_size);
+        if (m_iSize == 0) {
+            return; // Empty files cannot be mapped
+        }
+
+        pMapping = mmap(nullptr, m_iSize, PROT_READ, MAP_PRIVATE, m_iFileDescriptor, 0);
+        if (pMapping == MAP_FAILED) {
+            close(m_iFileDescriptor);
+            cout << "Could not map file " << sPath << "!" << endl;
+            throw std::runtime_error("Could not map file!");
+        }
+        madvise(pMapping, m_iSize, MADV_SEQUENTIAL);
+        m_pData = static_cast<const char*>(pMapping);
+    }
+
+    MappedFile::~MappedFile() {
+        if (m_pData != nullptr) {
+            munmap(const_cast<char*>(m_pData), m_iSize);
+        }
+        if (m_iFileDescriptor >= 0) {
+            close(m_iFileDescriptor);
+        }
+    }
+
+#endif
+
+    #pragma endregion
+
+    #pragma region Observers
+
+    const char* MappedFile::getData() const {
+        return m_pData;
+    }
+
+    size_t MappedFile::getSize() const {
+        return m_iSize;
+    }
+
+    std::string_view MappedFile::getText() const {
+        return (m_pData == nullptr) ? std::string_view() : std::string_view(m_pData, m_iSize);
+    }
+
+    const std::string& MappedFile::getPath() const {
+        return m_sPath;
+    }
+
+    #pragma endregion
+
+}
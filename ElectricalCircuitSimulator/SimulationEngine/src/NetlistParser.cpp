@@ -0,0 +1,309 @@
+// The cursor walks the text once. Names are compared as string_views into the text and numbers are read with
+// std::from_chars straight from the text, so nothing is copied except the title.
+
+#include "NetlistParser.h"
+#include "MappedFile.h"
+#include <charconv>
+#include <iostream>
+
+using std::cout;
+using std::endl;
+
+namespace SimulationEngine {
+
+    namespace {
+
+        class NetlistCursor final {
+
+            public:
+
+                NetlistCursor(const std::string_view sText) :
+                    m_sText(sText),
+                    m_iPosition(0),
+                    m_iLine(1),
+                    m_iLineStart(0) { ; }
+
+                bool atEnd() const {
+                    return m_iPosition >= m_sText.size();
+                }
+
+                size_t getPosition() const {
+                    return m_iPosition;
+                }
+
+                void skipSpaces() {
+                    while (!atEnd() && (m_sText[m_iPosition] == ' ' || m_sText[m_iPosition] == '\t')) {
+                        m_iPosition++;
+                    }
+                }
+
+                // Skips whitespace including line breaks
+                void skipBlankLines() {
+                    while (!atEnd()) {
+                        if (m_sText[m_iPosition] == '\n') {
+                            newLine();
+                        } else if (m_sText[m_iPosition] == ' ' || m_sText[m_iPosition] == '\t' || m_sText[m_iPosition] == '\r') {
+                            m_iPosition++;
+                        } else {
+                            break;
+                        }
+                    }
+                }
+
+                // Rest of the line without the line break
+                std::string_view readLine() {
+                    size_t iStart = m_iPosition;
+                    size_t iEnd = m_sText.find('\n', m_iPosition);
+
+                    if (iEnd == std::string_view::npos) {
+                        iEnd = m_sText.size();
+                    }
+                    m_iPosition = iEnd;
+                    if (!atEnd()) {
+                        newLine();
+                    }
+                    if (iEnd > iStart && m_sText[iEnd - 1] == '\r') {
+                        iEnd--;
+                    }
+
+                    return m_sText.substr(iStart, iEnd - iStart);
+                }
+
+                std::string_view readName() {
+                    size_t iStart = m_iPosition;
+
+                    while (!atEnd() && ((m_sText[m_iPosition] >= 'A' && m_sText[m_iPosition] <= 'Z') || (m_sText[m_iPosition] >= 'a' && m_sText[m_iPosition] <= 'z'))) {
+                        m_iPosition++;
+                    }
+                    if (m_iPosition == iStart) {
+                        fail("Expected a component or setting name", iStart);
+                    }
+
+                    return m_sText.substr(iStart, m_iPosition - iStart);
+                }
+
+                void expect(const char cToken, const char* sMessage) {
+                    skipSpaces();
+                    if (atEnd() || m_sText[m_iPosition] != cToken) {
+                        fail(sMessage, m_iPosition);
+                    }
+                    m_iPosition++;
+                }
+
+                size_t readIndex() {
+                    size_t iValue = 0;
+                    std::from_chars_result oResult;
+
+                    skipSpaces();
+                    oResult = std::from_chars(m_sText.data() + m_iPosition, m_sText.data() + m_sText.size(), iValue);
+                    if (oResult.ec == std::errc::result_out_of_range) {
+                        fail("Index is out of range", m_iPosition);
+                    }
+                    if (oResult.ec != std::errc()) {
+                        fail("Expected a node or component index", m_iPosition);
+                    }
+                    m_iPosition = oResult.ptr - m_sText.data();
+
+                    return iValue;
+                }
+
+                double readNumber() {
+                    double dValue = 0;
+                    std::from_chars_result oResult;
+
+                    skipSpaces();
+                    oResult = std::from_chars(m_sText.data() + m_iPosition, m_sText.data() + m_sText.size(), dValue);
+                    if (oResult.ec == std::errc::result_out_of_range) {
+                        fail("Number is out of range", m_iPosition);
+                    }
+                    if (oResult.ec != std::errc()) {
+                        fail("Expected a number", m_iPosition);
+                    }
+                    m_iPosition = oResult.ptr - m_sText.data();
+
+                    return dValue;
+                }
+
+                double readPositiveNumber(const char* sMessage) {
+                    size_t iStart;
+                    double dValue;
+
+                    skipSpaces();
+                    iStart = m_iPosition;
+                    dValue = readNumber();
+                    if (dValue <= 0) {
+                        fail(sMessage, iStart);
+                    }
+
+                    return dValue;
+                }
+
+                // Only spaces and an optional ';' may follow the closing bracket on a line
+                void endLine() {
+                    skipSpaces();
+                    if (!atEnd() && m_sText[m_iPosition] == ';') {
+                        m_iPosition++;
+                        skipSpaces();
+                    }
+                    if (!atEnd() && m_sText[m_iPosition] == '\r') {
+                        m_iPosition++;
+                    }
+                    if (atEnd()) {
+                        return;
+                    }
+                    if (m_sText[m_iPosition] != '\n') {
+                        fail("Unexpected text after ')'", m_iPosition);
+                    }
+                    newLine();
+                }
+
+                [[noreturn]] void fail(const char* sMessage, const size_t iPosition) const {
+                    size_t iColumn = iPosition - m_iLineStart + 1;
+                    std::string sLocatedMessage = "Line " + std::to_string(m_iLine) + ", column " + std::to_string(iColumn) + ": " + sMessage + "!";
+
+                    cout << sLocatedMessage << endl;
+                    throw NetlistParseError(sLocatedMessage, m_iLine, iColumn);
+                }
+
+            private:
+
+                void newLine() {
+                    m_iPosition++;
+                    m_iLine++;
+                    m_iLineStart = m_iPosition;
+                }
+
+                std::string_view m_sText;
+                size_t m_iPosition;
+                size_t m_iLine;
+                size_t m_iLineStart;
+        };
+
+        // Name(Value) line of one of the settings at the end of the file
+        void readSettingName(NetlistCursor& oCursor, const std::string_view sExpectedName, const char* sMessage) {
+            size_t iStart;
+
+            oCursor.skipBlankLines();
+            iStart = oCursor.getPosition();
+            if (oCursor.atEnd() || oCursor.readName() != sExpectedName) {
+                oCursor.fail(sMessage, iStart);
+            }
+            oCursor.expect('(', "Expected '('");
+        }
+
+    }
+
+    #pragma region NetlistParseError
+
+    NetlistParseError::NetlistParseError(const std::string& sMessage, const size_t iLine, const size_t iColumn) :
+        std::invalid_argument(sMessage),
+        m_iLine(iLine),
+        m_iColumn(iColumn) { ; }
+
+    size_t NetlistParseError::getLine() const {
+        return m_iLine;
+    }
+
+    size_t NetlistParseError::getColumn() const {
+        return m_iColumn;
+    }
+
+    #pragma endregion
+
+    #pragma region NetlistParser
+
+    Netlist NetlistParser::parse(const std::string_view sText) {
+        NetlistCursor oCursor(sText);
+        Netlist oNetlist;
+        std::string_view sName;
+        size_t iStart;
+        size_t iNodeS;
+        size_t iNodeD;
+        double dValue;
+
+        if (sText.empty()) {
+            oCursor.fail("Missing the title line", 0);
+        }
+        oNetlist.sTitle = oCursor.readLine();
+
+        // Components, until the first setting
+        while (true) {
+            oCursor.skipBlankLines();
+            if (oCursor.atEnd()) {
+                oCursor.fail("Expected 'ScopeV'", oCursor.getPosition());
+            }
+            iStart = oCursor.getPosition();
+            sName = oCursor.readName();
+            if (sName == "ScopeV") {
+                break;
+            }
+            if (sName != "Resistor" && sName != "Capacitor" && sName != "Inductor" && sName != "GroundedVoltageSource") {
+                oCursor.fail("Unknown circuit component type", iStart);
+            }
+
+            oCursor.expect('(', "Expected '('");
+            iNodeS = oCursor.readIndex();
+            oCursor.expect(',', "Expected ','");
+            iNodeD = oCursor.readIndex();
+            oCursor.expect(',', "Expected ','");
+            if (sName == "GroundedVoltageSource") {
+                dValue = oCursor.readNumber();
+                oCursor.expect(',', "Expected ','");
+                oNetlist.oCircuit.addGroundedVoltageSource(iNodeS, iNodeD, dValue, oCursor.readPositiveNumber("Source resistance must be greater than 0"));
+            } else {
+                dValue = oCursor.readPositiveNumber("Component value must be greater than 0");
+                if (sName == "Resistor") {
+                    oNetlist.oCircuit.addResistor(iNodeS, iNodeD, dValue);
+                } else if (sName == "Capacitor") {
+                    oNetlist.oCircuit.addCapacitor(iNodeS, iNodeD, dValue);
+                } else {
+                    oNetlist.oCircuit.addInductor(iNodeS, iNodeD, dValue);
+                }
+            }
+            oCursor.expect(')', "Expected ')'");
+            oCursor.endLine();
+        }
+
+        // Settings, ScopeV( was read by the component loop
+        oCursor.expect('(', "Expected '('");
+        oNetlist.iVoltageScopeNode = oCursor.readIndex();
+        oCursor.expect(')', "Expected ')'");
+        oCursor.endLine();
+
+        readSettingName(oCursor, "ScopeI", "Expected 'ScopeI'");
+        oCursor.skipSpaces();
+        iStart = oCursor.getPosition();
+        oNetlist.iCurrentScopeComponent = oCursor.readIndex();
+        if (oNetlist.iCurrentScopeComponent >= oNetlist.oCircuit.getNumComponents()) {
+            oCursor.fail("Current scope component does not exist", iStart);
+        }
+        oCursor.expect(')', "Expected ')'");
+        oCursor.endLine();
+
+        readSettingName(oCursor, "TimeStep", "Expected 'TimeStep'");
+        oNetlist.dTimeStep = oCursor.readPositiveNumber("Time step must be greater than 0");
+        oCursor.expect(')', "Expected ')'");
+        oCursor.endLine();
+
+        readSettingName(oCursor, "StopTime", "Expected 'StopTime'");
+        oNetlist.dStopTime = oCursor.readPositiveNumber("Stop time must be greater than 0");
+        oCursor.expect(')', "Expected ')'");
+        oCursor.endLine();
+
+        oCursor.skipBlankLines();
+        if (!oCursor.atEnd()) {
+            oCursor.fail("Unexpected text after 'StopTime'", oCursor.getPosition());
+        }
+
+        return oNetlist;
+    }
+
+    Netlist NetlistParser::parseFile(const std::string& sPath) {
+        MappedFile oFile(sPath);
+
+        return parse(oFile.getText());
+    }
+
+    #pragma endregion
+
+}
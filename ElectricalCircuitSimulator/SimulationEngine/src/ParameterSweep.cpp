@@ -0,0 +1,368 @@
+// Work is split between the worker threads as contiguous variant ranges. A worker takes variants from the front of its
+// own range, and once that is empty it steals the back half of the largest remaining range of another worker, so
+// threads that got slow variants (more refactoring, failed variants) are balanced out without a central queue.
+
+#include "ParameterSweep.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <numbers>
+#include <thread>
+
+using std::cout;
+using std::endl;
+using std::invalid_argument;
+
+namespace SimulationEngine {
+
+    namespace {
+
+        struct WorkerRange {
+            std::mutex oMutex;
+            size_t iBegin = 0;
+            size_t iEnd = 0;
+        };
+
+        // SplitMix64 finalizer, a cheap well mixed hash so random values can be derived from (seed, variant, parameter)
+        std::uint64_t mixBits(std::uint64_t iValue) {
+            iValue += 0x9E3779B97F4A7C15ull;
+            iValue = (iValue ^ (iValue >> 30)) * 0xBF58476D1CE4E5B9ull;
+            iValue = (iValue ^ (iValue >> 27)) * 0x94D049BB133111EBull;
+            return iValue ^ (iValue >> 31);
+        }
+
+        // Uniform in (0, 1), never 0 so it can be passed to log
+        double uniformValue(const std::uint64_t iSeed, const size_t iVariant, const size_t iStream) {
+            std::uint64_t iBits = mixBits(iSeed ^ mixBits((static_cast<std::uint64_t>(iVariant) << 16) ^ iStream));
+
+            return (static_cast<double>(iBits >> 11) + 0.5) / 9007199254740992.0; // 2^53
+        }
+
+        bool takeVariant(std::vector<WorkerRange>& oRanges, const size_t iWorker, size_t& iVariant) {
+            size_t iVictim;
+            size_t iLargestVictim;
+            size_t iLargestSize;
+            size_t iMiddle;
+
+            while (true) {
+                {
+                    std::lock_guard<std::mutex> oLock(oRanges[iWorker].oMutex);
+
+                    if (oRanges[iWorker].iBegin < oRanges[iWorker].iEnd) {
+                        iVariant = oRanges[iWorker].iBegin++;
+                        return true;
+                    }
+                }
+
+                // Own range is empty, find the largest range left and steal its back half
+                iLargestVictim = iWorker;
+                iLargestSize = 0;
+                for (iVictim = 0; iVictim < oRanges.size(); iVictim++) {
+                    std::lock_guard<std::mutex> oLock(oRanges[iVictim].oMutex);
+
+                    if (iVictim != iWorker && oRanges[iVictim].iEnd - oRanges[iVictim].iBegin > iLargestSize) {
+                        iLargestVictim = iVictim;
+                        iLargestSize = oRanges[iVictim].iEnd - oRanges[iVictim].iBegin;
+                    }
+                }
+                if (iLargestSize == 0) {
+                    return false; // Everything is taken
+                }
+
+                {
+                    std::scoped_lock oLock(oRanges[iWorker].oMutex, oRanges[iLargestVictim].oMutex);
+                    WorkerRange& oVictim = oRanges[iLargestVictim];
+
+                    if (oVictim.iBegin < oVictim.iEnd) { // May have shrunk since it was measured
+                        iMiddle = oVictim.iBegin + (oVictim.iEnd - oVictim.iBegin) / 2;
+                        oRanges[iWorker].iBegin = iMiddle;
+                        oRanges[iWorker].iEnd = oVictim.iEnd;
+                        oVictim.iEnd = iMiddle;
+                    }
+                }
+            }
+        }
+
+    }
+
+    #pragma region Constructors
+
+    ParameterSweep::ParameterSweep(const CircuitDescription& oCircuit, const double dStopTime, const double dTimeStep) :
+        m_oCircuit(oCircuit),
+        m_dStopTime(dStopTime),
+        m_dTimeStep(dTimeStep),
+        m_iNumSamples(1),
+        m_iSeed(0),
+        m_iNumThreads(0),
+        m_iNumFailedVariants(0),
+        m_bHasRun(false)
+    {
+        if (dStopTime <= 0 || dTimeStep <= 0) {
+            cout << "Stop time and time step must be greater than 0!" << endl;
+            throw invalid_argument("Stop time and time step must be greater than 0!");
+        }
+    }
+
+    #pragma endregion
+
+    #pragma region Observers
+
+    size_t ParameterSweep::getNumVariants() const {
+        return getNumGridPoints() * m_iNumSamples;
+    }
+
+    size_t ParameterSweep::getNumProbes() const {
+        return m_oProbes.size();
+    }
+
+    size_t ParameterSweep::getNumFailedVariants() const {
+        return m_iNumFailedVariants;
+    }
+
+    size_t ParameterSweep::getNumThreads() const {
+        return (m_iNumThreads == 0) ? std::max<size_t>(1, std::thread::hardware_concurrency()) : m_iNumThreads;
+    }
+
+    double ParameterSweep::getParameterValue(const size_t iVariant, const size_t iParameterIndex) const {
+        if (iVariant >= getNumVariants() || iParameterIndex >= m_oParameters.size()) {
+            cout << "Requested sweep value does not exist!" << endl;
+            throw invalid_argument("Requested sweep value does not exist!");
+        }
+
+        return sampleParameter(iVariant, iParameterIndex);
+    }
+
+    double ParameterSweep::getResult(const size_t iVariant, const size_t iProbeIndex) const {
+        if (m_bHasRun == false) {
+            cout << "Cannot read results from a sweep that has not been run!" << endl;
+            throw std::exception("Cannot read results from a sweep that has not been run!");
+        }
+        if (iVariant >= getNumVariants() || iProbeIndex >= m_oProbes.size()) {
+            cout << "Requested sweep value does not exist!" << endl;
+            throw invalid_argument("Requested sweep value does not exist!");
+        }
+
+        return m_oResults[iVariant * m_oProbes.size() + iProbeIndex];
+    }
+
+    std::span<const double> ParameterSweep::getResults() const {
+        return std::span<const double>(m_oResults);
+    }
+
+    #pragma endregion
+
+    #pragma region Modifiers
+
+    size_t ParameterSweep::addGridParameter(const size_t iComponentIndex, const double dStart, const double dStop, const size_t iNumPoints) {
+        if (iNumPoints == 0) {
+            cout << "A grid parameter needs at least one point!" << endl;
+            throw invalid_argument("A grid parameter needs at least one point!");
+        }
+
+        return addParameter({ iComponentIndex, SweepDistribution::Grid, dStart, dStop, iNumPoints });
+    }
+
+    size_t ParameterSweep::addUniformParameter(const size_t iComponentIndex, const double dMin, const double dMax) {
+        if (dMax < dMin) {
+            cout << "Maximum must not be smaller than the minimum!" << endl;
+            throw invalid_argument("Maximum must not be smaller than the minimum!");
+        }
+
+        return addParameter({ iComponentIndex, SweepDistribution::Uniform, dMin, dMax, 1 });
+    }
+
+    size_t ParameterSweep::addNormalParameter(const size_t iComponentIndex, const double dMean, const double dStandardDeviation) {
+        if (dStandardDeviation < 0) {
+            cout << "Standard deviation must not be negative!" << endl;
+            throw invalid_argument("Standard deviation must not be negative!");
+        }
+
+        return addParameter({ iComponentIndex, SweepDistribution::Normal, dMean, dStandardDeviation, 1 });
+    }
+
+    size_t ParameterSweep::addVoltageProbe(const size_t iNode) {
+        m_oProbes.push_back({ true, iNode });
+        m_bHasRun = false;
+
+        return m_oProbes.size() - 1;
+    }
+
+    size_t ParameterSweep::addCurrentProbe(const size_t iComponentIndex) {
+        if (iComponentIndex >= m_oCircuit.getNumComponents()) {
+            cout << "Requested component does not exist!" << endl;
+            throw invalid_argument("Requested component does not exist!");
+        }
+        m_oProbes.push_back({ false, iComponentIndex });
+        m_bHasRun = false;
+
+        return m_oProbes.size() - 1;
+    }
+
+    void ParameterSweep::setNumSamples(const size_t iNumSamples) {
+        if (iNumSamples == 0) {
+            cout << "A sweep needs at least one sample!" << endl;
+            throw invalid_argument("A sweep needs at least one sample!");
+        }
+        m_iNumSamples = iNumSamples;
+        m_bHasRun = false;
+    }
+
+    void ParameterSweep::setSeed(const std::uint64_t iSeed) {
+        m_iSeed = iSeed;
+        m_bHasRun = false;
+    }
+
+    void ParameterSweep::setNumThreads(const size_t iNumThreads) {
+        m_iNumThreads = iNumThreads;
+    }
+
+    void ParameterSweep::run() {
+        size_t iNumVariants = getNumVariants();
+        size_t iNumThreads = std::min(getNumThreads(), iNumVariants);
+        size_t iThread;
+        size_t iProbe;
+        std::vector<WorkerRange> oRanges(iNumThreads);
+        std::vector<std::thread> oWorkers;
+        PartitionedCircuitSimulation oCheckSimulation;
+
+        // Build and step the unchanged circuit once here, so bad circuits and probes throw on the calling thread
+        m_oCircuit.buildSimulation(oCheckSimulation);
+        oCheckSimulation.setStopTime(m_dStopTime);
+        oCheckSimulation.setTimeStep(m_dTimeStep);
+        oCheckSimulation.initalize();
+        oCheckSimulation.step();
+        for (iProbe = 0; iProbe < m_oProbes.size(); iProbe++) {
+            if (m_oProbes[iProbe].bVoltage) {
+                oCheckSimulation.getVoltage(m_oProbes[iProbe].iIndex);
+            }
+        }
+
+        m_oParameterValues.assign(iNumVariants * m_oParameters.size(), 0);
+        m_oResults.assign(iNumVariants * m_oProbes.size(), std::numeric_limits<double>::quiet_NaN());
+        m_oFailed.assign(iNumVariants, 0);
+
+        for (iThread = 0; iThread < iNumThreads; iThread++) {
+            oRanges[iThread].iBegin = iNumVariants * iThread / iNumThreads;
+            oRanges[iThread].iEnd = iNumVariants * (iThread + 1) / iNumThreads;
+        }
+
+        oWorkers.reserve(iNumThreads);
+        for (iThread = 0; iThread < iNumThreads; iThread++) {
+            oWorkers.emplace_back([this, &oRanges, iThread]() {
+                size_t iVariant;
+                PartitionedCircuitSimulation oSimulation; // One per thread, only the values change between variants
+
+                m_oCircuit.buildSimulation(oSimulation);
+                oSimulation.setStopTime(m_dStopTime);
+                oSimulation.setTimeStep(m_dTimeStep);
+                while (takeVariant(oRanges, iThread, iVariant)) {
+                    runVariant(oSimulation, iVariant);
+                }
+            });
+        }
+        for (std::thread& oWorker : oWorkers) {
+            oWorker.join();
+        }
+
+        m_iNumFailedVariants = 0;
+        for (unsigned char bFailed : m_oFailed) {
+            m_iNumFailedVariants += bFailed;
+        }
+        m_bHasRun = true;
+    }
+
+    #pragma endregion
+
+    #pragma region Private Modifiers
+
+    size_t ParameterSweep::addParameter(const SweepParameter& oParameter) {
+        if (oParameter.iComponentIndex >= m_oCircuit.getNumComponents()) {
+            cout << "Requested component does not exist!" << endl;
+            throw invalid_argument("Requested component does not exist!");
+        }
+        m_oParameters.push_back(oParameter);
+        m_bHasRun = false;
+
+        return m_oParameters.size() - 1;
+    }
+
+    void ParameterSweep::runVariant(PartitionedCircuitSimulation& oSimulation, const size_t iVariant) {
+        size_t iParameter;
+        size_t iProbe;
+        double dValue;
+        double* pResults = m_oResults.data() + iVariant * m_oProbes.size();
+
+        try {
+            // Every variant sets the same components, values that are not swept keep the ones from the description
+            for (iParameter = 0; iParameter < m_oParameters.size(); iParameter++) {
+                dValue = sampleParameter(iVariant, iParameter);
+                m_oParameterValues[iVariant * m_oParameters.size() + iParameter] = dValue;
+                oSimulation.setComponentValue(m_oParameters[iParameter].iComponentIndex, dValue);
+            }
+
+            oSimulation.initalize();
+            while (oSimulation.step() == false);
+
+            for (iProbe = 0; iProbe < m_oProbes.size(); iProbe++) {
+                pResults[iProbe] = m_oProbes[iProbe].bVoltage ? oSimulation.getVoltage(m_oProbes[iProbe].iIndex) : oSimulation.getCurrent(m_oProbes[iProbe].iIndex);
+            }
+        } catch (std::exception&) {
+            m_oFailed[iVariant] = 1;
+            for (iProbe = 0; iProbe < m_oProbes.size(); iProbe++) {
+                pResults[iProbe] = std::numeric_limits<double>::quiet_NaN();
+            }
+        }
+    }
+
+    #pragma endregion
+
+    #pragma region Private Observers
+
+    size_t ParameterSweep::getNumGridPoints() const {
+        size_t iNumGridPoints = 1;
+
+        for (const SweepParameter& oParameter : m_oParameters) {
+            if (oParameter.eDistribution == SweepDistribution::Grid) {
+                iNumGridPoints *= oParameter.iNumPoints;
+            }
+        }
+
+        return iNumGridPoints;
+    }
+
+    double ParameterSweep::sampleParameter(const size_t iVariant, const size_t iParameterIndex) const {
+        size_t iGridPoint = iVariant / m_iNumSamples;
+        size_t iIndex;
+        size_t iPoint = 0;
+        const SweepParameter& oParameter = m_oParameters[iParameterIndex];
+
+        switch (oParameter.eDistribution) {
+            case SweepDistribution::Grid:
+                // The last grid parameter changes fastest
+                for (iIndex = m_oParameters.size(); iIndex-- > 0;) {
+                    if (m_oParameters[iIndex].eDistribution != SweepDistribution::Grid) {
+                        continue;
+                    }
+                    iPoint = iGridPoint % m_oParameters[iIndex].iNumPoints;
+                    iGridPoint /= m_oParameters[iIndex].iNumPoints;
+                    if (iIndex == iParameterIndex) {
+                        break;
+                    }
+                }
+                if (oParameter.iNumPoints == 1) {
+                    return oParameter.dA;
+                }
+                return oParameter.dA + (oParameter.dB - oParameter.dA) * static_cast<double>(iPoint) / static_cast<double>(oParameter.iNumPoints - 1);
+            case SweepDistribution::Uniform:
+                return oParameter.dA + (oParameter.dB - oParameter.dA) * uniformValue(m_iSeed, iVariant, 2 * iParameterIndex);
+            default: // Box-Muller
+                return oParameter.dA + oParameter.dB * std::sqrt(-2.0 * std::log(uniformValue(m_iSeed, iVariant, 2 * iParameterIndex))) *
+                                                      std::cos(2.0 * std::numbers::pi * uniformValue(m_iSeed, iVariant, 2 * iParameterIndex + 1));
+        }
+    }
+
+    #pragma endregion
+
+}
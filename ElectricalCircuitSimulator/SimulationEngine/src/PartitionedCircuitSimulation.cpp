@@ -0,0 +1,485 @@
+// Each component kind uses the same companion model as its component class:
+//     Resistor:              i(t) = 1/R * v(t)
+//     Capacitor:             i(t) = 2C/dt*v(t) - (2C/dt*v(t-1) + i(t-1))
+//     Inductor:              i(t) = dt/2L*v(t) - (-dt/2L*v(t-1) - i(t-1))
+//     GroundedVoltageSource: i(t) = 1/R * v(t) - V/R
+// m_oConductance holds the simulation matrix stamp and m_oSource the through vector stamp of every component.
+// Step first updates the history terms of a whole group (a plain loop over arrays), then scatters them into the
+// through vector. Post step gathers the node voltages and updates the currents the same way.
+// As in LinearNaturalSimulation, the reference node is ordered last and only the leading block without its row and
+// column is factored, so the system is nonsingular and the reference node stays at 0 without a normalization pass.
+
+// AcrossReferenceNode = Circuit Ground
+// Across = Voltage (V)
+// Through = Current (A)
+
+#include "PartitionedCircuitSimulation.h"
+#include <algorithm>
+#include <iostream>
+
+using std::cout;
+using std::endl;
+using std::invalid_argument;
+
+namespace SimulationEngine {
+
+    #pragma region Component Group
+
+    void PartitionedCircuitSimulation::ComponentGroup::reserve(const size_t iNumComponents) {
+        m_oNodeS.reserve(iNumComponents);
+        m_oNodeD.reserve(iNumComponents);
+        m_oValue.reserve(iNumComponents);
+        m_oConductance.reserve(iNumComponents);
+        m_oSource.reserve(iNumComponents);
+        m_oVoltageDelta.reserve(iNumComponents);
+        m_oThrough.reserve(iNumComponents);
+        m_oSourceResistance.reserve(iNumComponents);
+    }
+
+    void PartitionedCircuitSimulation::ComponentGroup::add(const size_t iNodeS, const size_t iNodeD, const double dValue) {
+        m_oNodeS.push_back(iNodeS);
+        m_oNodeD.push_back(iNodeD);
+        m_oValue.push_back(dValue);
+        m_oConductance.push_back(0);
+        m_oSource.push_back(0);
+        m_oVoltageDelta.push_back(0);
+        m_oThrough.push_back(0);
+    }
+
+    size_t PartitionedCircuitSimulation::ComponentGroup::size() const {
+        return m_oNodeS.size();
+    }
+
+    #pragma endregion
+
+    #pragma region Constructors
+
+    PartitionedCircuitSimulation::PartitionedCircuitSimulation() :
+        m_dStopTime(0),
+        m_dTime(0),
+        m_dTimeStep(0),
+        m_bInitSim(false),
+        m_bRunSim(false),
+        m_iAcrossReferenceNode(0),
+        m_bHasAcrossReferenceNode(false),
+        m_eMatrixSolverType(MatrixSolverType::Auto),
+        m_bUseSparseSolver(false),
+        m_bReuseFactorization(false) { ; }
+
+    #pragma endregion
+
+    #pragma region Observers
+
+    double PartitionedCircuitSimulation::getTime() const {
+        return m_dTime;
+    }
+
+    size_t PartitionedCircuitSimulation::getNumComponents() const {
+        return m_oComponentKinds.size();
+    }
+
+    double PartitionedCircuitSimulation::getVoltage(const size_t iNode) const {
+        size_t iNodeIndex = getNodeIndex(iNode);
+
+        if (m_bRunSim == false) {
+            cout << "Cannot read across values from a simulation that has not been simulated!" << endl;
+            throw std::exception("Cannot read across values from a simulation that has not been simulated!");
+        }
+
+        return m_oAcrossVector.data()[iNodeIndex];
+    }
+
+    double PartitionedCircuitSimulation::getCurrent(const size_t iComponentIndex) const {
+        if (iComponentIndex >= m_oComponentKinds.size()) {
+            cout << "Requested component does not exist!" << endl;
+            throw invalid_argument("Requested component does not exist!");
+        }
+        if (m_bRunSim == false) {
+            cout << "Cannot read through values from a simulation that has not been simulated!" << endl;
+            throw std::exception("Cannot read through values from a simulation that has not been simulated!");
+        }
+
+        return getGroup(m_oComponentKinds[iComponentIndex]).m_oThrough[m_oGroupIndices[iComponentIndex]];
+    }
+
+    CircuitComponentKind PartitionedCircuitSimulation::getComponentKind(const size_t iComponentIndex) const {
+        if (iComponentIndex >= m_oComponentKinds.size()) {
+            cout << "Requested component does not exist!" << endl;
+            throw invalid_argument("Requested component does not exist!");
+        }
+
+        return m_oComponentKinds[iComponentIndex];
+    }
+
+    MatrixSolverType PartitionedCircuitSimulation::getMatrixSolverType() const {
+        return m_eMatrixSolverType;
+    }
+
+    #pragma endregion
+
+    #pragma region Modifiers
+
+    void PartitionedCircuitSimulation::reserve(const CircuitComponentKind eKind, const size_t iNumComponents) {
+        getGroup(eKind).reserve(iNumComponents);
+        m_oComponentKinds.reserve(getNumComponents() + iNumComponents);
+        m_oGroupIndices.reserve(getNumComponents() + iNumComponents);
+    }
+
+    void PartitionedCircuitSimulation::reserveNodes(const size_t iNumNodes) {
+        m_oNodeIndices.reserve(iNumNodes);
+    }
+
+    size_t PartitionedCircuitSimulation::addResistor(const size_t iNodeS, const size_t iNodeD, const double dResistance) {
+        if (dResistance <= 0) {
+            cout << "Resistance value must be greater than 0!" << endl;
+            throw invalid_argument("Resistance value must be greater than 0!");
+        }
+
+        return addTwoTerminal(CircuitComponentKind::Resistor, iNodeS, iNodeD, dResistance);
+    }
+
+    size_t PartitionedCircuitSimulation::addCapacitor(const size_t iNodeS, const size_t iNodeD, const double dCapacitance) {
+        if (dCapacitance <= 0) {
+            cout << "Capacitance value must be greater than 0!" << endl;
+            throw invalid_argument("Capacitance value must be greater than 0!");
+        }
+
+        return addTwoTerminal(CircuitComponentKind::Capacitor, iNodeS, iNodeD, dCapacitance);
+    }
+
+    size_t PartitionedCircuitSimulation::addInductor(const size_t iNodeS, const size_t iNodeD, const double dInductance) {
+        if (dInductance <= 0) {
+            cout << "Inductance value must be greater than 0!" << endl;
+            throw invalid_argument("Inductance value must be greater than 0!");
+        }
+
+        return addTwoTerminal(CircuitComponentKind::Inductor, iNodeS, iNodeD, dInductance);
+    }
+
+    size_t PartitionedCircuitSimulation::addGroundedVoltageSource(const size_t iNodeS, const size_t iNodeD, const double dVoltage, const double dResistance) {
+        size_t iComponentIndex;
+
+        if (dResistance <= 0) {
+            cout << "Resistance value must be greater than 0!" << endl;
+            throw invalid_argument("Resistance value must be greater than 0!");
+        }
+        if (m_bHasAcrossReferenceNode == true) {
+            cout << "Simulation already has an across reference node, cannot add another one!" << endl;
+            throw std::exception("Simulation already has an across reference node, cannot add another one!");
+        }
+
+        iComponentIndex = addTwoTerminal(CircuitComponentKind::GroundedVoltageSource, iNodeS, iNodeD, dVoltage);
+        m_oSources.m_oSourceResistance.push_back(dResistance);
+        m_bHasAcrossReferenceNode = true;
+        m_iAcrossReferenceNode = m_oSources.m_oNodeS.back(); // Already a dense index
+
+        return iComponentIndex;
+    }
+
+    void PartitionedCircuitSimulation::setComponentValue(const size_t iComponentIndex, const double dValue) {
+        if (iComponentIndex >= m_oComponentKinds.size()) {
+            cout << "Requested component does not exist!" << endl;
+            throw invalid_argument("Requested component does not exist!");
+        }
+        if (dValue <= 0 && m_oComponentKinds[iComponentIndex] != CircuitComponentKind::GroundedVoltageSource) { // Source voltages may have either sign
+            cout << "Component value must be greater than 0!" << endl;
+            throw invalid_argument("Component value must be greater than 0!");
+        }
+
+        getGroup(m_oComponentKinds[iComponentIndex]).m_oValue[m_oGroupIndices[iComponentIndex]] = dValue;
+        m_bInitSim = false; // Topology is unchanged, initalize only refactors
+        m_bRunSim = false;
+    }
+
+    void PartitionedCircuitSimulation::setStopTime(const double dStopTime) {
+        if (dStopTime <= 0) {
+            cout << "Stop time must be greater than 0!" << endl;
+            throw invalid_argument("Stop time must be greater than 0!");
+        }
+        m_dStopTime = dStopTime;
+    }
+
+    void PartitionedCircuitSimulation::setTimeStep(const double dTimeStep) {
+        if (dTimeStep <= 0) {
+            cout << "Time step must be greater than 0!" << endl;
+            throw invalid_argument("Time step must be greater than 0!");
+        }
+        m_dTimeStep = dTimeStep;
+    }
+
+    void PartitionedCircuitSimulation::setMatrixSolverType(const MatrixSolverType eMatrixSolverType) {
+        m_eMatrixSolverType = eMatrixSolverType;
+        m_bReuseFactorization = false;
+        m_bInitSim = false;
+        m_bRunSim = false;
+    }
+
+    void PartitionedCircuitSimulation::initalize() {
+        size_t iIndex;
+        size_t iNumNodes = m_oNodeIndices.size();
+        SparseMatrix<double> oSystemMatrix;
+
+        if (m_dStopTime < m_dTimeStep) {
+            cout << "Stop time cannot be smaller than time step!" << endl;
+            throw std::exception("Stop time cannot be smaller than time step!");
+        }
+        if (m_oComponentKinds.empty()) {
+            cout << "There are no components in the Simulation!" << endl;
+            throw std::exception("There are no components in the Simulation!");
+        }
+        if (m_bHasAcrossReferenceNode == false) {
+            cout << "There is no across reference node in the simulation!" << endl;
+            throw std::exception("There is no across reference node in the simulation!");
+        }
+
+        m_dTime = 0;
+
+        // Companion model conductances, the history terms start from rest
+        for (iIndex = 0; iIndex < m_oResistors.size(); iIndex++) {
+            m_oResistors.m_oConductance[iIndex] = 1.0 / m_oResistors.m_oValue[iIndex];
+        }
+        for (iIndex = 0; iIndex < m_oCapacitors.size(); iIndex++) {
+            m_oCapacitors.m_oConductance[iIndex] = (2.0 * m_oCapacitors.m_oValue[iIndex]) / m_dTimeStep;
+        }
+        for (iIndex = 0; iIndex < m_oInductors.size(); iIndex++) {
+            m_oInductors.m_oConductance[iIndex] = m_dTimeStep / (2.0 * m_oInductors.m_oValue[iIndex]);
+        }
+        for (iIndex = 0; iIndex < m_oSources.size(); iIndex++) {
+            m_oSources.m_oConductance[iIndex] = 1.0 / m_oSources.m_oSourceResistance[iIndex];
+            m_oSources.m_oSource[iIndex] = m_oSources.m_oValue[iIndex] / m_oSources.m_oSourceResistance[iIndex];
+        }
+        for (ComponentGroup* pGroup : { &m_oResistors, &m_oCapacitors, &m_oInductors }) {
+            std::fill(pGroup->m_oSource.begin(), pGroup->m_oSource.end(), 0.0);
+        }
+        for (ComponentGroup* pGroup : { &m_oResistors, &m_oCapacitors, &m_oInductors, &m_oSources }) {
+            std::fill(pGroup->m_oVoltageDelta.begin(), pGroup->m_oVoltageDelta.end(), 0.0);
+            std::fill(pGroup->m_oThrough.begin(), pGroup->m_oThrough.end(), 0.0);
+        }
+
+        // Build the simulation matrix, the sparsity pattern is kept while the topology is unchanged
+        if (m_bReuseFactorization) {
+            m_oSimulationMatrix.clear();
+        } else {
+            orderAcrossReferenceNodeLast();
+            m_oSimulationMatrix = SparseMatrix<double>(iNumNodes, iNumNodes);
+        }
+        stampGroup(m_oResistors);
+        stampGroup(m_oCapacitors);
+        stampGroup(m_oInductors);
+        stampGroup(m_oSources);
+        m_oSimulationMatrix.compress();
+
+        m_oThroughVector = Matrix<double>(iNumNodes, 1);
+        m_oThroughBaseline = Matrix<double>(iNumNodes, 1);
+        m_oAcrossVector = Matrix<double>(iNumNodes, 1);
+        m_oSolveWorkspace = Matrix<double>(iNumNodes, 1);
+
+        // Resistors and sources are static, only the reactive groups are restamped every step
+        for (iIndex = 0; iIndex < m_oSources.size(); iIndex++) {
+            m_oThroughBaseline.data()[m_oSources.m_oNodeS[iIndex]] -= m_oSources.m_oSource[iIndex];
+            m_oThroughBaseline.data()[m_oSources.m_oNodeD[iIndex]] += m_oSources.m_oSource[iIndex];
+        }
+
+        // The system matrix is the leading block, the reference node's row and column are left out
+        if (m_bReuseFactorization == false) {
+            m_bUseSparseSolver = (m_eMatrixSolverType == MatrixSolverType::Sparse) ||
+                                 (m_eMatrixSolverType == MatrixSolverType::Auto && iNumNodes - 1 >= SPARSE_SOLVER_NODE_THRESHOLD);
+        }
+        oSystemMatrix = m_oSimulationMatrix.getLeadingBlock(iNumNodes - 1);
+        if (m_bUseSparseSolver) {
+            if (m_bReuseFactorization) {
+                m_oSparseLU.refactor(oSystemMatrix);
+            } else {
+                m_oSparseLU = SparseLU_Factorization<double>(oSystemMatrix);
+            }
+        } else {
+            if (m_bReuseFactorization) {
+                m_oPLU.refactor(oSystemMatrix.toDense());
+            } else {
+                m_oPLU = PLU_Factorization<double>(oSystemMatrix.toDense());
+            }
+        }
+        m_bReuseFactorization = true;
+        m_bInitSim = true;
+    }
+
+    bool PartitionedCircuitSimulation::step() {
+        size_t iIndex;
+        size_t iNumNodes = m_oNodeIndices.size();
+        double* pThrough;
+        const double* pAcross;
+
+        if (m_bInitSim == false) {
+            cout << "Simulation has not been initalized!" << endl;
+            throw std::exception("Simulation has not been initalized!");
+        }
+
+        // History terms, 2C/dt*v(t-1) + i(t-1) and dt/2L*v(t-1) + i(t-1)
+        for (ComponentGroup* pGroup : { &m_oCapacitors, &m_oInductors }) {
+            const size_t iCount = pGroup->size();
+            const double* pConductance = pGroup->m_oConductance.data();
+            const double* pVoltageDelta = pGroup->m_oVoltageDelta.data();
+            const double* pGroupThrough = pGroup->m_oThrough.data();
+            double* pSource = pGroup->m_oSource.data();
+
+            for (iIndex = 0; iIndex < iCount; iIndex++) {
+                pSource[iIndex] = pConductance[iIndex] * pVoltageDelta[iIndex] + pGroupThrough[iIndex];
+            }
+        }
+
+        // Scatter the history terms over the static baseline, inductors push current from - to +
+        std::copy_n(m_oThroughBaseline.data(), iNumNodes, m_oThroughVector.data());
+        pThrough = m_oThroughVector.data();
+        for (iIndex = 0; iIndex < m_oCapacitors.size(); iIndex++) {
+            pThrough[m_oCapacitors.m_oNodeS[iIndex]] += m_oCapacitors.m_oSource[iIndex];
+            pThrough[m_oCapacitors.m_oNodeD[iIndex]] -= m_oCapacitors.m_oSource[iIndex];
+        }
+        for (iIndex = 0; iIndex < m_oInductors.size(); iIndex++) {
+            pThrough[m_oInductors.m_oNodeS[iIndex]] -= m_oInductors.m_oSource[iIndex];
+            pThrough[m_oInductors.m_oNodeD[iIndex]] += m_oInductors.m_oSource[iIndex];
+        }
+
+        // Find the new across vector, the reference node is the last entry and stays at 0
+        if (m_bUseSparseSolver) {
+            m_oSparseLU.solveInto(m_oThroughVector.data(), m_oAcrossVector.data(), m_oSolveWorkspace.data());
+        } else {
+            m_oPLU.solveInto(m_oThroughVector.data(), m_oAcrossVector.data(), m_oSolveWorkspace.data());
+        }
+
+        // Gather the voltage across every component, then update the currents
+        pAcross = m_oAcrossVector.data();
+        for (ComponentGroup* pGroup : { &m_oResistors, &m_oCapacitors, &m_oInductors, &m_oSources }) {
+            for (iIndex = 0; iIndex < pGroup->size(); iIndex++) {
+                pGroup->m_oVoltageDelta[iIndex] = pAcross[pGroup->m_oNodeS[iIndex]] - pAcross[pGroup->m_oNodeD[iIndex]];
+            }
+        }
+        for (iIndex = 0; iIndex < m_oResistors.size(); iIndex++) {
+            m_oResistors.m_oThrough[iIndex] = m_oResistors.m_oConductance[iIndex] * m_oResistors.m_oVoltageDelta[iIndex];
+        }
+        for (iIndex = 0; iIndex < m_oCapacitors.size(); iIndex++) {
+            m_oCapacitors.m_oThrough[iIndex] = m_oCapacitors.m_oConductance[iIndex] * m_oCapacitors.m_oVoltageDelta[iIndex] - m_oCapacitors.m_oSource[iIndex];
+        }
+        for (iIndex = 0; iIndex < m_oInductors.size(); iIndex++) {
+            m_oInductors.m_oThrough[iIndex] = m_oInductors.m_oConductance[iIndex] * m_oInductors.m_oVoltageDelta[iIndex] + m_oInductors.m_oSource[iIndex];
+        }
+        for (iIndex = 0; iIndex < m_oSources.size(); iIndex++) { // (V - (v(D) - v(S))) / R, v(S) - v(D) is already stored
+            m_oSources.m_oThrough[iIndex] = m_oSources.m_oSource[iIndex] + m_oSources.m_oConductance[iIndex] * m_oSources.m_oVoltageDelta[iIndex];
+        }
+
+        m_dTime += m_dTimeStep;
+        m_bRunSim = true;
+
+        return m_dTime >= m_dStopTime;
+    }
+
+    #pragma endregion
+
+    #pragma region Private Modifiers
+
+    size_t PartitionedCircuitSimulation::addTwoTerminal(const CircuitComponentKind eKind, const size_t iNodeS, const size_t iNodeD, const double dValue) {
+        ComponentGroup& oGroup = getGroup(eKind);
+
+        if (iNodeS == iNodeD) {
+            cout << "Two node values must not be the same!" << endl;
+            throw invalid_argument("Two node values must not be the same!");
+        }
+
+        m_oComponentKinds.push_back(eKind);
+        m_oGroupIndices.push_back(oGroup.size());
+        oGroup.add(registerNode(iNodeS), registerNode(iNodeD), dValue);
+
+        // We are changing the simulation
+        m_bInitSim = false;
+        m_bRunSim = false;
+        m_bReuseFactorization = false;
+
+        return m_oComponentKinds.size() - 1;
+    }
+
+    size_t PartitionedCircuitSimulation::registerNode(const size_t iNode) {
+        return m_oNodeIndices.try_emplace(iNode, m_oNodeIndices.size()).first->second;
+    }
+
+    void PartitionedCircuitSimulation::stampGroup(ComponentGroup& oGroup) {
+        size_t iIndex;
+        size_t iNodeS;
+        size_t iNodeD;
+        double dConductance;
+
+        for (iIndex = 0; iIndex < oGroup.size(); iIndex++) {
+            iNodeS = oGroup.m_oNodeS[iIndex];
+            iNodeD = oGroup.m_oNodeD[iIndex];
+            dConductance = oGroup.m_oConductance[iIndex];
+
+            m_oSimulationMatrix(iNodeS, iNodeS) += dConductance;
+            m_oSimulationMatrix(iNodeS, iNodeD) -= dConductance;
+            m_oSimulationMatrix(iNodeD, iNodeS) -= dConductance;
+            m_oSimulationMatrix(iNodeD, iNodeD) += dConductance;
+        }
+    }
+
+    // The reference node swaps dense indices with the last node, so the unknown across values are the leading block.
+    // Only called when the topology changed, nothing moves while it stays the same.
+    void PartitionedCircuitSimulation::orderAcrossReferenceNodeLast() {
+        size_t iLastNode = m_oNodeIndices.size() - 1;
+        size_t iReferenceNode = m_iAcrossReferenceNode;
+
+        if (iReferenceNode == iLastNode)
+            return;
+
+        for (std::pair<const size_t, size_t>& oNode : m_oNodeIndices) {
+            if (oNode.second == iReferenceNode) {
+                oNode.second = iLastNode;
+            } else if (oNode.second == iLastNode) {
+                oNode.second = iReferenceNode;
+            }
+        }
+        for (ComponentGroup* pGroup : { &m_oResistors, &m_oCapacitors, &m_oInductors, &m_oSources }) {
+            for (std::vector<size_t>* pNodes : { &pGroup->m_oNodeS, &pGroup->m_oNodeD }) {
+                for (size_t& iNode : *pNodes) {
+                    if (iNode == iReferenceNode) {
+                        iNode = iLastNode;
+                    } else if (iNode == iLastNode) {
+                        iNode = iReferenceNode;
+                    }
+                }
+            }
+        }
+        m_iAcrossReferenceNode = iLastNode;
+    }
+
+    #pragma endregion
+
+    #pragma region Private Observers
+
+    size_t PartitionedCircuitSimulation::getNodeIndex(const size_t iNode) const {
+        std::unordered_map<size_t, size_t>::const_iterator oIterator = m_oNodeIndices.find(iNode);
+
+        if (oIterator == m_oNodeIndices.end()) {
+            cout << "Requested node does not exist!" << endl;
+            throw invalid_argument("Requested node does not exist!");
+        }
+
+        return oIterator->second;
+    }
+
+    PartitionedCircuitSimulation::ComponentGroup& PartitionedCircuitSimulation::getGroup(const CircuitComponentKind eKind) {
+        switch (eKind) {
+            case CircuitComponentKind::Resistor:
+                return m_oResistors;
+            case CircuitComponentKind::Capacitor:
+                return m_oCapacitors;
+            case CircuitComponentKind::Inductor:
+                return m_oInductors;
+            default:
+                return m_oSources;
+        }
+    }
+
+    const PartitionedCircuitSimulation::ComponentGroup& PartitionedCircuitSimulation::getGroup(const CircuitComponentKind eKind) const {
+        return const_cast<PartitionedCircuitSimulation*>(this)->getGroup(eKind);
+    }
+
+    #pragma endregion
+
+}
@@ -22,29 +22,31 @@ using std::invalid_argument;
 namespace SimulationEngine {
 
     Resistor::Resistor(const size_t iNodeS, const size_t iNodeD, const double dResistance) :
-        LinearCircuitSimComponent(0, false, iNodeS),
+        LinearCircuitSimComponent({ iNodeS, iNodeD }, false, iNodeS),
         m_iNodeS(iNodeS),
         m_iNodeD(iNodeD),
         m_dResistance(dResistance)
     {
-        size_t iNodeList = 0;
-
         if (dResistance <= 0) {
             cout << "Resistance value must be greater than 0!" << endl;
             throw invalid_argument("Resistance value must be greater than 0!");
         }
+    }
 
-        iNodeList += (m_iNodeS << (0 * BITS_PER_NODE));
-        iNodeList += (m_iNodeD << (1 * BITS_PER_NODE));
-        setNodeList(iNodeList);
+    void Resistor::setResistance(const double dResistance) {
+        if (dResistance <= 0) {
+            cout << "Resistance value must be greater than 0!" << endl;
+            throw invalid_argument("Resistance value must be greater than 0!");
+        }
+        m_dResistance = dResistance;
     }
 
-    void Resistor::LNS_initalize(Matrix<double>& oConductanceMatrix, const double dTimeStep) {
+    void Resistor::LNS_initalize(SparseMatrix<double>& oConductanceMatrix, const double dTimeStep) {
         m_dThrough = 0;
         applySimulationMatrixStamp(oConductanceMatrix, dTimeStep);
     }
 
-    void Resistor::applySimulationMatrixStamp(Matrix<double>& oConductanceMatrix, const double dTimeStep) {
+    void Resistor::applySimulationMatrixStamp(SparseMatrix<double>& oConductanceMatrix, const double dTimeStep) {
         double dResistance;
 
         m_dComponentSimulationMatrixStamp = 1.0 / m_dResistance;
@@ -62,6 +64,16 @@ namespace SimulationEngine {
         oConductanceMatrix(m_iNodeD, m_iNodeD) = dResistance + m_dComponentSimulationMatrixStamp;
     };
 
+    void Resistor::renumberNodes(const std::unordered_map<size_t, size_t>& oNodeIndices) {
+        LinearCircuitSimComponent::renumberNodes(oNodeIndices);
+        m_iNodeS = getNode(0);
+        m_iNodeD = getNode(1);
+    }
+
+    bool Resistor::LNS_isDynamic() const {
+        return false;
+    }
+
     void Resistor::LNS_postStep(Matrix<double>& oVoltageMatrix) {
         m_dThrough = (oVoltageMatrix(m_iNodeS, 0) - oVoltageMatrix(m_iNodeD, 0)) / m_dResistance;
     }
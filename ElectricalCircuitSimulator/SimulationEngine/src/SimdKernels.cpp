@@ -0,0 +1,283 @@
+// Runtime dispatched SIMD kernels. The AVX2 and AVX-512 kernels are only compiled for x64 and are only called once the
+// CPU (and OS register saving) support has been confirmed with cpuid, so the rest of the build does not need /arch flags.
+// Vector kernels sum in a different order than the scalar reference, so dot products match it within rounding, not bit for bit.
+
+#include "SimdKernels.h"
+#include <atomic>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define SIMD_X64
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(SIMD_X64) && !defined(SIMD_DISABLE_AVX2)
+#define SIMD_HAS_AVX2
+#if !defined(SIMD_DISABLE_AVX512)
+#define SIMD_HAS_AVX512
+#endif
+#endif
+
+// GCC and Clang need the instruction set enabled per function, MSVC allows the intrinsics anywhere
+#if defined(__GNUC__) || defined(__clang__)
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define SIMD_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define SIMD_TARGET_AVX2
+#define SIMD_TARGET_AVX512
+#endif
+
+namespace SimulationEngine {
+
+    namespace SimdKernels {
+
+        namespace {
+
+            #pragma region CPU Detection
+
+            SimdLevel detectSimdLevel() {
+#if defined(SIMD_HAS_AVX2)
+#ifdef _MSC_VER
+                int oRegisters[4];
+                unsigned long long iEnabledState;
+                bool bAVX2;
+                bool bAVX512 = false;
+
+                __cpuid(oRegisters, 0);
+                if (oRegisters[0] < 7)
+                    return SimdLevel::Scalar;
+
+                // OSXSAVE, AVX and FMA, then the OS must save the YMM registers
+                __cpuid(oRegisters, 1);
+                if ((oRegisters[2] & (1 << 27)) == 0 || (oRegisters[2] & (1 << 28)) == 0 || (oRegisters[2] & (1 << 12)) == 0)
+                    return SimdLevel::Scalar;
+                iEnabledState = _xgetbv(0);
+                if ((iEnabledState & 0x6) != 0x6)
+                    return SimdLevel::Scalar;
+
+                __cpuidex(oRegisters, 7, 0);
+                bAVX2 = (oRegisters[1] & (1 << 5)) != 0;
+                bAVX512 = (oRegisters[1] & (1 << 16)) != 0 && (iEnabledState & 0xE6) == 0xE6; // Opmask and ZMM state too
+                if (bAVX2 == false)
+                    return SimdLevel::Scalar;
+#else
+                bool bAVX512;
+
+                __builtin_cpu_init();
+                if (__builtin_cpu_supports("avx2") == 0 || __builtin_cpu_supports("fma") == 0)
+                    return SimdLevel::Scalar;
+                bAVX512 = __builtin_cpu_supports("avx512f") != 0;
+#endif
+#if defined(SIMD_HAS_AVX512)
+                if (bAVX512)
+                    return SimdLevel::AVX512;
+#else
+                (void)bAVX512;
+#endif
+                return SimdLevel::AVX2;
+#else
+                return SimdLevel::Scalar;
+#endif
+            }
+
+            #pragma endregion
+
+            #pragma region Kernels
+
+#if defined(SIMD_HAS_AVX2)
+            SIMD_TARGET_AVX2 double dotProductAVX2(const double* pA, const double* pB, const size_t iCount) {
+                size_t iIndex = 0;
+                double dSum;
+                __m256d oSum0 = _mm256_setzero_pd();
+                __m256d oSum1 = _mm256_setzero_pd();
+                __m256d oSum2 = _mm256_setzero_pd();
+                __m256d oSum3 = _mm256_setzero_pd();
+                __m128d oHalf;
+
+                // Four independent accumulators hide the FMA latency
+                for (; iIndex + 16 <= iCount; iIndex += 16) {
+                    oSum0 = _mm256_fmadd_pd(_mm256_loadu_pd(pA + iIndex), _mm256_loadu_pd(pB + iIndex), oSum0);
+                    oSum1 = _mm256_fmadd_pd(_mm256_loadu_pd(pA + iIndex + 4), _mm256_loadu_pd(pB + iIndex + 4), oSum1);
+                    oSum2 = _mm256_fmadd_pd(_mm256_loadu_pd(pA + iIndex + 8), _mm256_loadu_pd(pB + iIndex + 8), oSum2);
+                    oSum3 = _mm256_fmadd_pd(_mm256_loadu_pd(pA + iIndex + 12), _mm256_loadu_pd(pB + iIndex + 12), oSum3);
+                }
+                for (; iIndex + 4 <= iCount; iIndex += 4) {
+                    oSum0 = _mm256_fmadd_pd(_mm256_loadu_pd(pA + iIndex), _mm256_loadu_pd(pB + iIndex), oSum0);
+                }
+
+                oSum0 = _mm256_add_pd(_mm256_add_pd(oSum0, oSum1), _mm256_add_pd(oSum2, oSum3));
+                oHalf = _mm_add_pd(_mm256_castpd256_pd128(oSum0), _mm256_extractf128_pd(oSum0, 1));
+                dSum = _mm_cvtsd_f64(_mm_add_sd(oHalf, _mm_unpackhi_pd(oHalf, oHalf)));
+
+                for (; iIndex < iCount; ++iIndex) {
+                    dSum += pA[iIndex] * pB[iIndex];
+                }
+
+                return dSum;
+            }
+
+            SIMD_TARGET_AVX2 void subtractScaledAVX2(double* pValues, const double* pOther, const double dScale, const size_t iCount) {
+                size_t iIndex = 0;
+                __m256d oScale = _mm256_set1_pd(dScale);
+
+                for (; iIndex + 4 <= iCount; iIndex += 4) {
+                    _mm256_storeu_pd(pValues + iIndex, _mm256_fnmadd_pd(oScale, _mm256_loadu_pd(pOther + iIndex), _mm256_loadu_pd(pValues + iIndex)));
+                }
+                for (; iIndex < iCount; ++iIndex) {
+                    pValues[iIndex] -= dScale * pOther[iIndex];
+                }
+            }
+#endif
+
+#if defined(SIMD_HAS_AVX512)
+            SIMD_TARGET_AVX512 double dotProductAVX512(const double* pA, const double* pB, const size_t iCount) {
+                size_t iIndex = 0;
+                __m512d oSum0 = _mm512_setzero_pd();
+                __m512d oSum1 = _mm512_setzero_pd();
+                __mmask8 iMask;
+
+                for (; iIndex + 16 <= iCount; iIndex += 16) {
+                    oSum0 = _mm512_fmadd_pd(_mm512_loadu_pd(pA + iIndex), _mm512_loadu_pd(pB + iIndex), oSum0);
+                    oSum1 = _mm512_fmadd_pd(_mm512_loadu_pd(pA + iIndex + 8), _mm512_loadu_pd(pB + iIndex + 8), oSum1);
+                }
+                for (; iIndex + 8 <= iCount; iIndex += 8) {
+                    oSum0 = _mm512_fmadd_pd(_mm512_loadu_pd(pA + iIndex), _mm512_loadu_pd(pB + iIndex), oSum0);
+                }
+                // Masked loads handle the tail without reading past the end
+                if (iIndex < iCount) {
+                    iMask = static_cast<__mmask8>((1u << (iCount - iIndex)) - 1);
+                    oSum1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(iMask, pA + iIndex), _mm512_maskz_loadu_pd(iMask, pB + iIndex), oSum1);
+                }
+
+                return _mm512_reduce_add_pd(_mm512_add_pd(oSum0, oSum1));
+            }
+
+            SIMD_TARGET_AVX512 void subtractScaledAVX512(double* pValues, const double* pOther, const double dScale, const size_t iCount) {
+                size_t iIndex = 0;
+                __m512d oScale = _mm512_set1_pd(dScale);
+                __mmask8 iMask;
+
+                for (; iIndex + 8 <= iCount; iIndex += 8) {
+                    _mm512_storeu_pd(pValues + iIndex, _mm512_fnmadd_pd(oScale, _mm512_loadu_pd(pOther + iIndex), _mm512_loadu_pd(pValues + iIndex)));
+                }
+                if (iIndex < iCount) {
+                    iMask = static_cast<__mmask8>((1u << (iCount - iIndex)) - 1);
+                    _mm512_mask_storeu_pd(pValues + iIndex, iMask, _mm512_fnmadd_pd(oScale, _mm512_maskz_loadu_pd(iMask, pOther + iIndex), _mm512_maskz_loadu_pd(iMask, pValues + iIndex)));
+                }
+            }
+#endif
+
+            #pragma endregion
+
+            #pragma region Dispatch
+
+            struct KernelTable {
+                SimdLevel eSimdLevel;
+                double (*pDotProduct)(const double*, const double*, const size_t);
+                void (*pSubtractScaled)(double*, const double*, const double, const size_t);
+            };
+
+            KernelTable getKernelTable(const SimdLevel eSimdLevel) {
+                switch (eSimdLevel) {
+#if defined(SIMD_HAS_AVX512)
+                    case SimdLevel::AVX512:
+                        return { SimdLevel::AVX512, &dotProductAVX512, &subtractScaledAVX512 };
+#endif
+#if defined(SIMD_HAS_AVX2)
+                    case SimdLevel::AVX2:
+                        return { SimdLevel::AVX2, &dotProductAVX2, &subtractScaledAVX2 };
+#endif
+                    default:
+                        return { SimdLevel::Scalar, &dotProductScalar, &subtractScaledScalar };
+                }
+            }
+
+            double dotProductFirstUse(const double* pA, const double* pB, const size_t iCount);
+            void subtractScaledFirstUse(double* pValues, const double* pOther, const double dScale, const size_t iCount);
+
+            // Constant initialized to the first use stubs, so kernels called from other static initializers still dispatch
+            // correctly. The first call of any entry point runs the cpuid detection and installs the real kernels.
+            std::atomic<double (*)(const double*, const double*, const size_t)> pDotProduct{ &dotProductFirstUse };
+            std::atomic<void (*)(double*, const double*, const double, const size_t)> pSubtractScaled{ &subtractScaledFirstUse };
+            std::atomic<SimdLevel> eActiveSimdLevel{ SimdLevel::Scalar };
+
+            void storeKernelTable(const KernelTable& oKernelTable) {
+                pDotProduct.store(oKernelTable.pDotProduct, std::memory_order_relaxed);
+                pSubtractScaled.store(oKernelTable.pSubtractScaled, std::memory_order_relaxed);
+                eActiveSimdLevel.store(oKernelTable.eSimdLevel, std::memory_order_relaxed);
+            }
+
+            // Thread safe one time selection of the supported kernels (function local static initialization)
+            void selectSupportedKernels() {
+                static const bool bSelected = (storeKernelTable(getKernelTable(getSupportedSimdLevel())), true);
+                (void)bSelected;
+            }
+
+            double dotProductFirstUse(const double* pA, const double* pB, const size_t iCount) {
+                selectSupportedKernels();
+                return pDotProduct.load(std::memory_order_relaxed)(pA, pB, iCount);
+            }
+
+            void subtractScaledFirstUse(double* pValues, const double* pOther, const double dScale, const size_t iCount) {
+                selectSupportedKernels();
+                pSubtractScaled.load(std::memory_order_relaxed)(pValues, pOther, dScale, iCount);
+            }
+
+            #pragma endregion
+
+        }
+
+        SimdLevel getSupportedSimdLevel() {
+            static const SimdLevel eSupportedSimdLevel = detectSimdLevel();
+
+            return eSupportedSimdLevel;
+        }
+
+        SimdLevel getSimdLevel() {
+            selectSupportedKernels();
+            return eActiveSimdLevel.load(std::memory_order_relaxed);
+        }
+
+        SimdLevel setSimdLevel(const SimdLevel eSimdLevel) {
+            SimdLevel eSupportedSimdLevel = getSupportedSimdLevel();
+            KernelTable oKernelTable = getKernelTable(static_cast<int>(eSimdLevel) > static_cast<int>(eSupportedSimdLevel) ? eSupportedSimdLevel : eSimdLevel);
+
+            // Finish the first use selection before overriding it, so it can not overwrite this choice later
+            selectSupportedKernels();
+            storeKernelTable(oKernelTable);
+
+            return oKernelTable.eSimdLevel;
+        }
+
+        double dotProduct(const double* pA, const double* pB, const size_t iCount) {
+            return pDotProduct.load(std::memory_order_relaxed)(pA, pB, iCount);
+        }
+
+        void subtractScaled(double* pValues, const double* pOther, const double dScale, const size_t iCount) {
+            pSubtractScaled.load(std::memory_order_relaxed)(pValues, pOther, dScale, iCount);
+        }
+
+        double dotProductScalar(const double* pA, const double* pB, const size_t iCount) {
+            size_t iIndex;
+            double dSum = 0;
+
+            for (iIndex = 0; iIndex < iCount; ++iIndex) {
+                dSum += pA[iIndex] * pB[iIndex];
+            }
+
+            return dSum;
+        }
+
+        void subtractScaledScalar(double* pValues, const double* pOther, const double dScale, const size_t iCount) {
+            size_t iIndex;
+
+            for (iIndex = 0; iIndex < iCount; ++iIndex) {
+                pValues[iIndex] -= dScale * pOther[iIndex];
+            }
+        }
+
+    }
+
+}
@@ -0,0 +1,224 @@
+#include "SourceWaveform.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <numbers>
+#include <stdexcept>
+
+using std::cout;
+using std::endl;
+using std::invalid_argument;
+
+namespace SimulationEngine {
+
+    #pragma region PiecewiseLinearWaveform
+
+    PiecewiseLinearWaveform::PiecewiseLinearWaveform(std::span<const double> oTimes, std::span<const double> oValues) :
+        m_oTimes(oTimes.begin(), oTimes.end()),
+        m_oValues(oValues.begin(), oValues.end())
+    {
+        size_t iPointIndex;
+
+        if (oTimes.empty() || oTimes.size() != oValues.size()) {
+            cout << "Waveform needs the same number of times and values, at least one!" << endl;
+            throw invalid_argument("Waveform needs the same number of times and values, at least one!");
+        }
+        for (iPointIndex = 1; iPointIndex < oTimes.size(); iPointIndex++) {
+            if (oTimes[iPointIndex] <= oTimes[iPointIndex - 1]) {
+                cout << "Waveform times must be increasing!" << endl;
+                throw invalid_argument("Waveform times must be increasing!");
+            }
+        }
+    }
+
+    size_t PiecewiseLinearWaveform::getNumPoints() const {
+        return m_oTimes.size();
+    }
+
+    double PiecewiseLinearWaveform::getValue(const double dTime) const {
+        size_t iPointIndex;
+
+        if (dTime <= m_oTimes.front()) {
+            return m_oValues.front();
+        }
+        if (dTime >= m_oTimes.back()) {
+            return m_oValues.back();
+        }
+
+        iPointIndex = std::upper_bound(m_oTimes.begin(), m_oTimes.end(), dTime) - m_oTimes.begin(); // First point after dTime
+        return m_oValues[iPointIndex - 1] + (m_oValues[iPointIndex] - m_oValues[iPointIndex - 1]) * (dTime - m_oTimes[iPointIndex - 1]) / (m_oTimes[iPointIndex] - m_oTimes[iPointIndex - 1]);
+    }
+
+    #pragma endregion
+
+    #pragma region PulseWaveform
+
+    PulseWaveform::PulseWaveform(const double dInitialValue, const double dPulsedValue, const double dDelay, const double dRiseTime, const double dFallTime, const double dPulseWidth, const double dPeriod) :
+        m_dInitialValue(dInitialValue),
+        m_dPulsedValue(dPulsedValue),
+        m_dDelay(dDelay),
+        m_dRiseTime(dRiseTime),
+        m_dFallTime(dFallTime),
+        m_dPulseWidth(dPulseWidth),
+        m_dPeriod(dPeriod)
+    {
+        if (dDelay < 0 || dRiseTime < 0 || dFallTime < 0 || dPulseWidth < 0) {
+            cout << "Pulse times must not be negative!" << endl;
+            throw invalid_argument("Pulse times must not be negative!");
+        }
+        if (dPeriod <= 0 || dPeriod < dRiseTime + dPulseWidth + dFallTime) {
+            cout << "Pulse period must be greater than 0 and fit the rise, width and fall times!" << endl;
+            throw invalid_argument("Pulse period must be greater than 0 and fit the rise, width and fall times!");
+        }
+    }
+
+    double PulseWaveform::getValue(const double dTime) const {
+        double dPeriodTime;
+
+        if (dTime < m_dDelay) {
+            return m_dInitialValue;
+        }
+
+        dPeriodTime = std::fmod(dTime - m_dDelay, m_dPeriod);
+        if (dPeriodTime < m_dRiseTime) {
+            return m_dInitialValue + (m_dPulsedValue - m_dInitialValue) * dPeriodTime / m_dRiseTime;
+        }
+        dPeriodTime -= m_dRiseTime;
+        if (dPeriodTime < m_dPulseWidth) {
+            return m_dPulsedValue;
+        }
+        dPeriodTime -= m_dPulseWidth;
+        if (dPeriodTime < m_dFallTime) {
+            return m_dPulsedValue + (m_dInitialValue - m_dPulsedValue) * dPeriodTime / m_dFallTime;
+        }
+
+        return m_dInitialValue;
+    }
+
+    #pragma endregion
+
+    #pragma region SineWaveform
+
+    SineWaveform::SineWaveform(const double dOffset, const double dAmplitude, const double dFrequency, const double dDelay, const double dDamping, const double dPhase) :
+        m_dOffset(dOffset),
+        m_dAmplitude(dAmplitude),
+        m_dAngularFrequency(2 * std::numbers::pi * dFrequency),
+        m_dDelay(dDelay),
+        m_dDamping(dDamping),
+        m_dPhase(dPhase)
+    {
+        if (dFrequency < 0) {
+            cout << "Frequency must not be negative!" << endl;
+            throw invalid_argument("Frequency must not be negative!");
+        }
+        if (dDelay < 0) {
+            cout << "Delay must not be negative!" << endl;
+            throw invalid_argument("Delay must not be negative!");
+        }
+    }
+
+    double SineWaveform::getValue(const double dTime) const {
+        double dDelayedTime = std::max(dTime - m_dDelay, 0.0);
+
+        return m_dOffset + m_dAmplitude * std::exp(-m_dDamping * dDelayedTime) * std::sin(m_dAngularFrequency * dDelayedTime + m_dPhase);
+    }
+
+    #pragma endregion
+
+    #pragma region SampledWaveform
+
+    SampledWaveform::SampledWaveform(const std::string& sPath, const double dSampleTime, const double dStartTime) :
+        m_oFile(sPath),
+        m_iNumSamples(m_oFile.getSize() / sizeof(double)),
+        m_dSampleTime(dSampleTime),
+        m_dStartTime(dStartTime)
+    {
+        if (dSampleTime <= 0) {
+            cout << "Sample time must be greater than 0!" << endl;
+            throw invalid_argument("Sample time must be greater than 0!");
+        }
+        if (m_iNumSamples == 0 || m_oFile.getSize() % sizeof(double) != 0) {
+            cout << "Sample file " << sPath << " must hold a whole number of doubles, at least one!" << endl;
+            throw invalid_argument("Sample file must hold a whole number of doubles, at least one!");
+        }
+    }
+
+    size_t SampledWaveform::getNumSamples() const {
+        return m_iNumSamples;
+    }
+
+    double SampledWaveform::getSample(const size_t iSampleIndex) const {
+        if (iSampleIndex >= m_iNumSamples) {
+            cout << "Index is out of bounds!" << endl;
+            throw invalid_argument("Index is out of bounds!");
+        }
+
+        return getSampleUnchecked(iSampleIndex);
+    }
+
+    double SampledWaveform::getValue(const double dTime) const {
+        double dPosition = (dTime - m_dStartTime) / m_dSampleTime;
+        double dSampleIndex;
+        double dFraction;
+        size_t iSampleIndex;
+
+        if (dPosition <= 0) {
+            return getSampleUnchecked(0);
+        }
+        if (dPosition >= static_cast<double>(m_iNumSamples - 1)) {
+            return getSampleUnchecked(m_iNumSamples - 1);
+        }
+
+        dFraction = std::modf(dPosition, &dSampleIndex);
+        iSampleIndex = static_cast<size_t>(dSampleIndex);
+        return getSampleUnchecked(iSampleIndex) + (getSampleUnchecked(iSampleIndex + 1) - getSampleUnchecked(iSampleIndex)) * dFraction;
+    }
+
+    double SampledWaveform::getSampleUnchecked(const size_t iSampleIndex) const {
+        double dSample;
+
+        std::memcpy(&dSample, m_oFile.getData() + iSampleIndex * sizeof(double), sizeof(double)); // The mapping is not guaranteed to be aligned for double
+
+        return dSample;
+    }
+
+    #pragma endregion
+
+    #pragma region SourceValue
+
+    SourceValue::SourceValue(const double dValue) :
+        m_dConstantValue(dValue),
+        m_pWaveform(nullptr),
+        m_dValue(dValue) { ; }
+
+    bool SourceValue::isTimeVarying() const {
+        return m_pWaveform != nullptr;
+    }
+
+    double SourceValue::getValue() const {
+        return m_dValue;
+    }
+
+    void SourceValue::setValue(const double dValue) {
+        m_dConstantValue = dValue;
+        m_pWaveform = nullptr;
+        m_dValue = dValue;
+    }
+
+    void SourceValue::setWaveform(std::shared_ptr<const SourceWaveform> pWaveform) {
+        if (pWaveform == nullptr) {
+            cout << "Waveform must not be null!" << endl;
+            throw invalid_argument("Waveform must not be null!");
+        }
+        m_pWaveform = std::move(pWaveform);
+        update(0);
+    }
+
+    void SourceValue::update(const double dTime) {
+        m_dValue = (m_pWaveform == nullptr) ? m_dConstantValue : m_pWaveform->getValue(dTime);
+    }
+
+    #pragma endregion
+
+}
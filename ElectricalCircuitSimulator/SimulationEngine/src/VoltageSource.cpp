@@ -0,0 +1,83 @@
+// This component is based on the equation: v(t) = V
+//     i(t) is the component current going from - to + inside the source.
+//     v(t) is the voltage potential from - to +.
+//     V is the source voltage, constant or a waveform of the simulation time evaluated at the end of the step.
+// i(t) has no equation of its own, it is a branch unknown solved together with the node voltages.
+// Matrix stamp adds i(t) to the current sum of both nodes and the branch row v(+) - v(-).
+// Source vector stamp puts V into the branch row.
+// Post step reads i(t) for the current step from the branch.
+// iNodeS is (-), iNodeD is (+).
+
+// AcrossReferenceNode = Circuit Ground
+// ComponentSimulationMatrixStamp = Unused
+// applyThroughVectorMatrixStamp = Component Voltage Vector Stamp (branch row)
+// Across = Voltage (V)
+// Through = Current (A)
+
+#include "VoltageSource.h"
+
+namespace SimulationEngine {
+
+    VoltageSource::VoltageSource(const size_t iNodeS, const size_t iNodeD, const double dVoltage) :
+        LinearCircuitSimComponent({ iNodeS, iNodeD }, false, iNodeS),
+        m_iNodeS(iNodeS),
+        m_iNodeD(iNodeD),
+        m_oVoltage(dVoltage)
+    {
+        m_oBranches.assign(1, NO_BRANCH);
+    }
+
+    void VoltageSource::setVoltage(const double dVoltage) {
+        m_oVoltage.setValue(dVoltage);
+    }
+
+    void VoltageSource::setVoltageWaveform(std::shared_ptr<const SourceWaveform> pWaveform) {
+        m_oVoltage.setWaveform(std::move(pWaveform));
+    }
+
+    void VoltageSource::LNS_initalize(SparseMatrix<double>& oSimulationMatrix, const double dTimeStep) {
+        m_dThrough = 0;
+        m_oVoltage.update(0);
+        applySimulationMatrixStamp(oSimulationMatrix, dTimeStep);
+    }
+
+    void VoltageSource::applySimulationMatrixStamp(SparseMatrix<double>& oSimulationMatrix, const double dTimeStep) {
+        stampBranch(oSimulationMatrix, m_iNodeS, m_iNodeD, m_oBranches[0]);
+    };
+
+    void VoltageSource::applyThroughVectorMatrixStamp(Matrix<double>& oThroughVector) {
+        double dVoltage;
+
+        dVoltage = oThroughVector(m_oBranches[0], 0);
+        oThroughVector(m_oBranches[0], 0) = dVoltage + m_oVoltage.getValue();
+    };
+
+    void VoltageSource::LNS_step(Matrix<double>& oThroughVector, const double dTime) {
+        m_oVoltage.update(dTime);
+        applyThroughVectorMatrixStamp(oThroughVector);
+    }
+
+    void VoltageSource::LNS_initalizeDC(SparseMatrix<double>& oSimulationMatrix) {
+        stampBranch(oSimulationMatrix, m_iNodeS, m_iNodeD, m_oBranches[0]); // Same branch equation as in the transient
+    }
+
+    void VoltageSource::LNS_stepDC(Matrix<double>& oThroughVector) {
+        m_oVoltage.update(0); // The operating point is at time 0
+        applyThroughVectorMatrixStamp(oThroughVector);
+    }
+
+    void VoltageSource::renumberNodes(const std::unordered_map<size_t, size_t>& oNodeIndices) {
+        LinearCircuitSimComponent::renumberNodes(oNodeIndices);
+        m_iNodeS = getNode(0);
+        m_iNodeD = getNode(1);
+    }
+
+    bool VoltageSource::LNS_isDynamic() const {
+        return m_oVoltage.isTimeVarying();
+    }
+
+    void VoltageSource::LNS_postStep(Matrix<double>& oAcrossVector) {
+        m_dThrough = oAcrossVector(m_oBranches[0], 0);
+    }
+
+}
@@ -0,0 +1,393 @@
+// The recorder and its writer thread pass chunk pointers through two queues guarded by one mutex: full chunks go to the
+// writer and written chunks come back on the free list. The simulation thread only touches the mutex when a chunk is
+// full, recording a sample is a plain store into the current chunk.
+
+#include "WaveformRecorder.h"
+#include <charconv>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+using std::cout;
+using std::endl;
+using std::invalid_argument;
+
+namespace SimulationEngine {
+
+    namespace {
+
+        constexpr char WAVEFORM_MAGIC[8] = { 'E', 'C', 'S', 'W', 'A', 'V', 'E', '\0' };
+
+        void openOutput(std::ofstream& oStream, const std::string& sPath, const std::ios::openmode eMode) {
+            oStream.open(sPath, eMode | std::ios::trunc);
+            if (!oStream) {
+                cout << "Could not create waveform file " << sPath << "!" << endl;
+                throw std::exception("Could not create waveform file!");
+            }
+        }
+
+        void checkOutput(const std::ofstream& oStream) {
+            if (!oStream) {
+                cout << "Could not write waveform file!" << endl;
+                throw std::exception("Could not write waveform file!");
+            }
+        }
+
+        void appendNumber(std::string& sBuffer, const double dValue) {
+            char acDigits[32];
+            std::to_chars_result oResult = std::to_chars(acDigits, acDigits + sizeof(acDigits), dValue);
+
+            sBuffer.append(acDigits, oResult.ptr);
+        }
+
+    }
+
+    #pragma region WaveformChunk
+
+    WaveformChunk::WaveformChunk(const size_t iNumChannels, const size_t iCapacity) :
+        m_iNumChannels(iNumChannels),
+        m_iCapacity(iCapacity),
+        m_iNumRows(0),
+        m_oData((iNumChannels + 1) * iCapacity) { ; }
+
+    size_t WaveformChunk::getNumRows() const {
+        return m_iNumRows;
+    }
+
+    size_t WaveformChunk::getNumChannels() const {
+        return m_iNumChannels;
+    }
+
+    size_t WaveformChunk::getCapacity() const {
+        return m_iCapacity;
+    }
+
+    bool WaveformChunk::isFull() const {
+        return m_iNumRows == m_iCapacity;
+    }
+
+    std::span<const double> WaveformChunk::getTimes() const {
+        return std::span<const double>(m_oData.data(), m_iNumRows);
+    }
+
+    std::span<const double> WaveformChunk::getChannel(const size_t iChannel) const {
+        if (iChannel >= m_iNumChannels) {
+            cout << "Requested channel does not exist!" << endl;
+            throw invalid_argument("Requested channel does not exist!");
+        }
+
+        return std::span<const double>(m_oData.data() + (iChannel + 1) * m_iCapacity, m_iNumRows);
+    }
+
+    void WaveformChunk::append(const double dTime, std::span<const double> oValues) {
+        size_t iChannel;
+        double* pRow = m_oData.data() + m_iNumRows;
+
+        pRow[0] = dTime;
+        for (iChannel = 0; iChannel < m_iNumChannels; iChannel++) {
+            pRow[(iChannel + 1) * m_iCapacity] = oValues[iChannel];
+        }
+        m_iNumRows++;
+    }
+
+    void WaveformChunk::clear() {
+        m_iNumRows = 0;
+    }
+
+    #pragma endregion
+
+    #pragma region CsvWaveformSink
+
+    CsvWaveformSink::CsvWaveformSink(const std::string& sPath) {
+        openOutput(m_oStream, sPath, std::ios::out);
+    }
+
+    void CsvWaveformSink::beginRun(const std::vector<std::string>& oChannelNames) {
+        m_oStream << "Time";
+        for (const std::string& sName : oChannelNames) {
+            m_oStream << "," << sName;
+        }
+        m_oStream << "\n";
+        checkOutput(m_oStream);
+    }
+
+    void CsvWaveformSink::writeChunk(const WaveformChunk& oChunk) {
+        size_t iRow;
+        size_t iChannel;
+        std::span<const double> oTimes = oChunk.getTimes();
+        std::vector<std::span<const double>> oChannels;
+
+        for (iChannel = 0; iChannel < oChunk.getNumChannels(); iChannel++) {
+            oChannels.push_back(oChunk.getChannel(iChannel));
+        }
+
+        // Rows are formatted into one buffer and written at once
+        m_sBuffer.clear();
+        for (iRow = 0; iRow < oChunk.getNumRows(); iRow++) {
+            appendNumber(m_sBuffer, oTimes[iRow]);
+            for (const std::span<const double>& oChannel : oChannels) {
+                m_sBuffer.push_back(',');
+                appendNumber(m_sBuffer, oChannel[iRow]);
+            }
+            m_sBuffer.push_back('\n');
+        }
+        m_oStream.write(m_sBuffer.data(), m_sBuffer.size());
+        checkOutput(m_oStream);
+    }
+
+    void CsvWaveformSink::endRun() {
+        m_oStream.flush();
+        checkOutput(m_oStream);
+    }
+
+    #pragma endregion
+
+    #pragma region BinaryWaveformSink
+
+    BinaryWaveformSink::BinaryWaveformSink(const std::string& sPath) {
+        openOutput(m_oStream, sPath, std::ios::out | std::ios::binary);
+    }
+
+    void BinaryWaveformSink::beginRun(const std::vector<std::string>& oChannelNames) {
+        std::uint32_t iVersion = VERSION;
+        std::uint32_t iNumChannels = static_cast<std::uint32_t>(oChannelNames.size());
+        std::uint32_t iNameSize;
+
+        m_oStream.write(WAVEFORM_MAGIC, sizeof(WAVEFORM_MAGIC));
+        m_oStream.write(reinterpret_cast<const char*>(&iVersion), sizeof(iVersion));
+        m_oStream.write(reinterpret_cast<const char*>(&iNumChannels), sizeof(iNumChannels));
+        for (const std::string& sName : oChannelNames) {
+            iNameSize = static_cast<std::uint32_t>(sName.size());
+            m_oStream.write(reinterpret_cast<const char*>(&iNameSize), sizeof(iNameSize));
+            m_oStream.write(sName.data(), sName.size());
+        }
+        checkOutput(m_oStream);
+    }
+
+    void BinaryWaveformSink::writeChunk(const WaveformChunk& oChunk) {
+        size_t iChannel;
+        std::uint64_t iNumRows = oChunk.getNumRows();
+
+        m_oStream.write(reinterpret_cast<const char*>(&iNumRows), sizeof(iNumRows));
+        m_oStream.write(reinterpret_cast<const char*>(oChunk.getTimes().data()), iNumRows * sizeof(double));
+        for (iChannel = 0; iChannel < oChunk.getNumChannels(); iChannel++) {
+            m_oStream.write(reinterpret_cast<const char*>(oChunk.getChannel(iChannel).data()), iNumRows * sizeof(double));
+        }
+        checkOutput(m_oStream);
+    }
+
+    void BinaryWaveformSink::endRun() {
+        std::uint64_t iEndOfRun = 0;
+
+        m_oStream.write(reinterpret_cast<const char*>(&iEndOfRun), sizeof(iEndOfRun));
+        m_oStream.flush();
+        checkOutput(m_oStream);
+    }
+
+    #pragma endregion
+
+    #pragma region WaveformRecorder
+
+    struct WaveformRecorder::Writer {
+        std::mutex oMutex;
+        std::condition_variable oChunkReady; // Writer waits for full chunks
+        std::condition_variable oChunkFree; // Recorder waits for written chunks
+        std::vector<std::unique_ptr<WaveformChunk>> oPool;
+        std::deque<WaveformChunk*> oFullChunks;
+        std::vector<WaveformChunk*> oFreeChunks;
+        size_t iNumChunks = 0;
+        bool bWriting = false;
+        bool bStop = false;
+        std::exception_ptr pError;
+        std::thread oThread;
+
+        void run(WaveformSink& oSink) {
+            WaveformChunk* pChunk;
+            bool bFailed;
+
+            while (true) {
+                {
+                    std::unique_lock<std::mutex> oLock(oMutex);
+
+                    oChunkReady.wait(oLock, [this]() { return bStop || !oFullChunks.empty(); });
+                    if (oFullChunks.empty()) {
+                        return; // Stopping and everything is written
+                    }
+                    pChunk = oFullChunks.front();
+                    oFullChunks.pop_front();
+                    bWriting = true;
+                    bFailed = (pError != nullptr); // Chunks after an error are dropped
+                }
+
+                try {
+                    if (bFailed == false) {
+                        oSink.writeChunk(*pChunk);
+                    }
+                } catch (...) {
+                    std::lock_guard<std::mutex> oLock(oMutex);
+                    pError = std::current_exception();
+                }
+
+                {
+                    std::lock_guard<std::mutex> oLock(oMutex);
+
+                    pChunk->clear();
+                    oFreeChunks.push_back(pChunk);
+                    bWriting = false;
+                }
+                oChunkFree.notify_all();
+            }
+        }
+
+        // Caller holds oMutex, rethrows a sink error once
+        void rethrowError() {
+            std::exception_ptr pThrown = pError;
+
+            if (pThrown != nullptr) {
+                pError = nullptr;
+                std::rethrow_exception(pThrown);
+            }
+        }
+    };
+
+    WaveformRecorder::WaveformRecorder(std::unique_ptr<WaveformSink> pSink, const size_t iChunkRows, const size_t iNumChunks) :
+        m_pSink(std::move(pSink)),
+        m_pWriter(std::make_unique<Writer>()),
+        m_pCurrentChunk(nullptr),
+        m_iChunkRows(iChunkRows),
+        m_iNumChannels(0),
+        m_iNumRecordedRows(0),
+        m_bRecording(false)
+    {
+        if (m_pSink == nullptr) {
+            cout << "Waveform recorder needs a sink!" << endl;
+            throw invalid_argument("Waveform recorder needs a sink!");
+        }
+        if (iChunkRows == 0 || iNumChunks == 0) {
+            cout << "Waveform recorder needs at least one chunk with at least one row!" << endl;
+            throw invalid_argument("Waveform recorder needs at least one chunk with at least one row!");
+        }
+        m_pWriter->iNumChunks = iNumChunks;
+        m_pWriter->oThread = std::thread([this]() { m_pWriter->run(*m_pSink); });
+    }
+
+    WaveformRecorder::~WaveformRecorder() {
+        if (m_bRecording) {
+            try {
+                endRun();
+            } catch (std::exception&) {
+                // Already reported by the sink, a destructor cannot throw
+            }
+        }
+        {
+            std::lock_guard<std::mutex> oLock(m_pWriter->oMutex);
+            m_pWriter->bStop = true;
+        }
+        m_pWriter->oChunkReady.notify_one();
+        m_pWriter->oThread.join();
+    }
+
+    bool WaveformRecorder::isRecording() const {
+        return m_bRecording;
+    }
+
+    size_t WaveformRecorder::getNumChannels() const {
+        return m_iNumChannels;
+    }
+
+    size_t WaveformRecorder::getNumRecordedRows() const {
+        return m_iNumRecordedRows;
+    }
+
+    void WaveformRecorder::beginRun(const std::vector<std::string>& oChannelNames) {
+        size_t iChunk;
+
+        if (m_bRecording) {
+            endRun();
+        }
+
+        // The writer is idle here, so the pool can be rebuilt for the new channel count
+        {
+            std::lock_guard<std::mutex> oLock(m_pWriter->oMutex);
+
+            m_pWriter->rethrowError();
+            m_pWriter->oPool.clear();
+            m_pWriter->oFreeChunks.clear();
+            for (iChunk = 0; iChunk < m_pWriter->iNumChunks; iChunk++) {
+                m_pWriter->oPool.push_back(std::make_unique<WaveformChunk>(oChannelNames.size(), m_iChunkRows));
+                m_pWriter->oFreeChunks.push_back(m_pWriter->oPool.back().get());
+            }
+            m_pCurrentChunk = m_pWriter->oFreeChunks.back();
+            m_pWriter->oFreeChunks.pop_back();
+        }
+
+        m_pSink->beginRun(oChannelNames);
+        m_iNumChannels = oChannelNames.size();
+        m_iNumRecordedRows = 0;
+        m_bRecording = true;
+    }
+
+    void WaveformRecorder::record(const double dTime, std::span<const double> oValues) {
+        if (m_bRecording == false) {
+            cout << "Waveform recorder has no open run!" << endl;
+            throw std::exception("Waveform recorder has no open run!");
+        }
+        if (oValues.size() != m_iNumChannels) {
+            cout << "Number of recorded values does not match the number of channels!" << endl;
+            throw invalid_argument("Number of recorded values does not match the number of channels!");
+        }
+
+        m_pCurrentChunk->append(dTime, oValues);
+        m_iNumRecordedRows++;
+        if (m_pCurrentChunk->isFull()) {
+            submitChunk();
+        }
+    }
+
+    void WaveformRecorder::endRun() {
+        if (m_bRecording == false) {
+            return;
+        }
+        m_bRecording = false;
+
+        {
+            std::unique_lock<std::mutex> oLock(m_pWriter->oMutex);
+
+            if (m_pCurrentChunk->getNumRows() > 0) {
+                m_pWriter->oFullChunks.push_back(m_pCurrentChunk);
+                m_pWriter->oChunkReady.notify_one();
+            } else {
+                m_pWriter->oFreeChunks.push_back(m_pCurrentChunk);
+            }
+            m_pCurrentChunk = nullptr;
+            m_pWriter->oChunkFree.wait(oLock, [this]() { return m_pWriter->oFullChunks.empty() && m_pWriter->bWriting == false; });
+            m_pWriter->rethrowError();
+        }
+
+        m_pSink->endRun();
+    }
+
+    void WaveformRecorder::submitChunk() {
+        std::unique_lock<std::mutex> oLock(m_pWriter->oMutex);
+
+        m_pWriter->oFullChunks.push_back(m_pCurrentChunk);
+        m_pWriter->oChunkReady.notify_one();
+
+        // Back pressure, wait for the writer if every chunk is queued
+        m_pWriter->oChunkFree.wait(oLock, [this]() { return !m_pWriter->oFreeChunks.empty(); });
+        m_pCurrentChunk = m_pWriter->oFreeChunks.back();
+        m_pWriter->oFreeChunks.pop_back();
+        if (m_pWriter->pError != nullptr) {
+            m_bRecording = false;
+            m_pWriter->oChunkFree.wait(oLock, [this]() { return m_pWriter->oFullChunks.empty() && m_pWriter->bWriting == false; });
+            m_pWriter->rethrowError();
+        }
+    }
+
+    #pragma endregion
+
+}
@@ -2,6 +2,7 @@
 //
 
 #include <iostream>
+#include "BinaryCircuitFile.h"
 #include "Capacitor.h"
 #include "Component.h"
 #include "GroundedVoltageSource.h"
@@ -105,8 +106,23 @@ void SimulationIntegrationTestSeriesRL()
     cout << "Current through component 2 (expect 1.46748): " << oLinearCircuit.getCurrent(2) << endl;
 }
 
-int main()
+int main(int argc, char* argv[])
 {
+    // SimulationEngineDebugger <circuit.txt> <circuit.eccb> converts a text circuit file to the binary format
+    if (argc == 3)
+    {
+        try
+        {
+            BinaryCircuitFile::convertNetlist(argv[1], argv[2]);
+        }
+        catch (std::exception&)
+        {
+            return 1;
+        }
+        cout << "Converted " << argv[1] << " to " << argv[2] << endl;
+        return 0;
+    }
+
     cout << "********************* Simulation Engine Debugger *********************\n\n" << endl;
     // Enable whatever circuit system you want to debug
     SimulationIntegrationTestSeriesRR();
@@ -1,13 +1,27 @@
 #pragma once
 
+#include "AcAnalysis.h"
+#include "BinaryCircuitFile.h"
 #include "Capacitor.h"
+#include "CircuitDescription.h"
 #include "Component.h"
+#include "ControlledSource.h"
+#include "CurrentSource.h"
+#include "Ground.h"
 #include "GroundedVoltageSource.h"
 #include "Inductor.h"
 #include "Simulation.h"
 #include "Matrix.h"
+#include "NetlistParser.h"
+#include "ParameterSweep.h"
+#include "PartitionedCircuitSimulation.h"
 #include "Resistor.h"
+#include "SimdKernels.h"
+#include "SourceWaveform.h"
+#include "SparseMatrix.h"
+#include "VoltageSource.h"
 #include <iostream>
+#include <msclr/marshal_cppstd.h>
 
 using namespace System;
 using namespace SimulationEngine;
@@ -52,6 +66,45 @@ namespace SimulationEngineWrapper {
 
             PLU_Factorization() :
                 ManagedObject(new SimulationEngine::PLU_Factorization<double>()) { ; }
+
+            // iPivotingPolicy follows SimulationEngine::PivotingPolicy (0 = Full, 1 = Partial, 2 = Threshold)
+            void factor(array<double, 2>^ oA, const int iPivotingPolicy, const double dPivotThreshold) {
+                *m_pInstance = SimulationEngine::PLU_Factorization<double>(toMatrix(oA), static_cast<PivotingPolicy>(iPivotingPolicy), dPivotThreshold);
+            }
+            void refactor(array<double, 2>^ oA) {
+                m_pInstance->refactor(toMatrix(oA));
+            }
+            int getPivotingPolicy() {
+                return static_cast<int>(m_pInstance->getPivotingPolicy());
+            }
+            array<double>^ solve(array<double>^ oB) {
+                int iIndex;
+                SimulationEngine::Matrix<double> oRightHandSide(oB->Length, 1);
+                SimulationEngine::Matrix<double> oSolution;
+                array<double>^ oX = gcnew array<double>(oB->Length);
+
+                for (iIndex = 0; iIndex < oB->Length; ++iIndex)
+                    oRightHandSide(iIndex, 0) = oB[iIndex];
+                oSolution = m_pInstance->solve(oRightHandSide);
+                for (iIndex = 0; iIndex < oB->Length; ++iIndex)
+                    oX[iIndex] = oSolution(iIndex, 0);
+
+                return oX;
+            }
+
+        private:
+
+            static SimulationEngine::Matrix<double> toMatrix(array<double, 2>^ oA) {
+                int iRow;
+                int iColumn;
+                SimulationEngine::Matrix<double> oMatrix(oA->GetLength(0), oA->GetLength(1));
+
+                for (iRow = 0; iRow < oA->GetLength(0); ++iRow)
+                    for (iColumn = 0; iColumn < oA->GetLength(1); ++iColumn)
+                        oMatrix(iRow, iColumn) = oA[iRow, iColumn];
+
+                return oMatrix;
+            }
     };
 
     public ref class Matrix : ManagedObject<SimulationEngine::Matrix<double>> {
@@ -89,6 +142,86 @@ namespace SimulationEngineWrapper {
             }
     };
 
+    public ref class SparseMatrix : ManagedObject<SimulationEngine::SparseMatrix<double>> {
+
+        public:
+
+            SparseMatrix() :
+                ManagedObject(new SimulationEngine::SparseMatrix<double>()) { ; }
+            SparseMatrix(const int iRows, const int iColumns) :
+                ManagedObject(new SimulationEngine::SparseMatrix<double>(iRows, iColumns)) { ; }
+
+            int getNumRows() {
+                return static_cast<int>(m_pInstance->getNumRows());
+            }
+            int getNumColumns() {
+                return static_cast<int>(m_pInstance->getNumColumns());
+            }
+            int getNumNonZeros() {
+                return static_cast<int>(m_pInstance->getNumNonZeros());
+            }
+            double getValue(const int iRow, const int iColumn) {
+                return (*static_cast<const SimulationEngine::SparseMatrix<double>*>(m_pInstance))(iRow, iColumn);
+            }
+            void setValue(const int iRow, const int iColumn, const double dValue) {
+                (*m_pInstance)(iRow, iColumn) = dValue;
+            }
+            void compress() {
+                m_pInstance->compress();
+            }
+            void clear() {
+                m_pInstance->clear();
+            }
+            void printMatrix() {
+                std::cout << m_pInstance->getMatrixString();
+            }
+    };
+
+    // Levels are 0 = Scalar, 1 = AVX2, 2 = AVX-512
+    public ref class SimdKernels abstract sealed {
+
+        public:
+
+            static int getSupportedSimdLevel() {
+                return static_cast<int>(SimulationEngine::SimdKernels::getSupportedSimdLevel());
+            }
+            static int getSimdLevel() {
+                return static_cast<int>(SimulationEngine::SimdKernels::getSimdLevel());
+            }
+            static int setSimdLevel(const int iSimdLevel) {
+                return static_cast<int>(SimulationEngine::SimdKernels::setSimdLevel(static_cast<SimdLevel>(iSimdLevel)));
+            }
+            static double dotProduct(array<double>^ oA, array<double>^ oB) {
+                if (oA->Length != oB->Length || oA->Length == 0)
+                    return 0;
+                pin_ptr<double> pA = &oA[0];
+                pin_ptr<double> pB = &oB[0];
+                return SimulationEngine::SimdKernels::dotProduct(pA, pB, static_cast<size_t>(oA->Length));
+            }
+            static double dotProductScalar(array<double>^ oA, array<double>^ oB) {
+                if (oA->Length != oB->Length || oA->Length == 0)
+                    return 0;
+                pin_ptr<double> pA = &oA[0];
+                pin_ptr<double> pB = &oB[0];
+                return SimulationEngine::SimdKernels::dotProductScalar(pA, pB, static_cast<size_t>(oA->Length));
+            }
+            // Subtract scaled updates oValues in place
+            static void subtractScaled(array<double>^ oValues, array<double>^ oOther, const double dScale) {
+                if (oValues->Length != oOther->Length || oValues->Length == 0)
+                    return;
+                pin_ptr<double> pValues = &oValues[0];
+                pin_ptr<double> pOther = &oOther[0];
+                SimulationEngine::SimdKernels::subtractScaled(pValues, pOther, dScale, static_cast<size_t>(oValues->Length));
+            }
+            static void subtractScaledScalar(array<double>^ oValues, array<double>^ oOther, const double dScale) {
+                if (oValues->Length != oOther->Length || oValues->Length == 0)
+                    return;
+                pin_ptr<double> pValues = &oValues[0];
+                pin_ptr<double> pOther = &oOther[0];
+                SimulationEngine::SimdKernels::subtractScaledScalar(pValues, pOther, dScale, static_cast<size_t>(oValues->Length));
+            }
+    };
+
     public ref class Capacitor : ManagedObject<SimulationEngine::Capacitor> {
 
         public:
@@ -101,8 +234,11 @@ namespace SimulationEngineWrapper {
 
         public:
 
-            LinearCircuitComponent(const int iNodeList, const bool bHasAcrossReferenceNode, const int iAcrossReferenceNode) :
-                ManagedObject(new SimulationEngine::LinearCircuitSimComponent(iNodeList, bHasAcrossReferenceNode, iAcrossReferenceNode)) { ; }
+            LinearCircuitComponent(array<int>^ oNodes, const bool bHasAcrossReferenceNode, const int iAcrossReferenceNode) :
+                ManagedObject(new SimulationEngine::LinearCircuitSimComponent({}, bHasAcrossReferenceNode, iAcrossReferenceNode))
+            {
+                setNodes(oNodes);
+            }
 
             int getNumNodes() {
                 return static_cast<int>(m_pInstance->getNumNodes());
@@ -110,8 +246,12 @@ namespace SimulationEngineWrapper {
             int getNode(const int iNodeIndex) {
                 return static_cast<int>(m_pInstance->getNode(iNodeIndex));
             }
-            void setNodeList(const int iNodeList) {
-                return m_pInstance->setNodeList(iNodeList);
+            void setNodes(array<int>^ oNodes) {
+                std::vector<size_t> oNodeList(oNodes->Length);
+                for (int iNodeIndex = 0; iNodeIndex < oNodes->Length; iNodeIndex++) {
+                    oNodeList[iNodeIndex] = static_cast<size_t>(oNodes[iNodeIndex]);
+                }
+                m_pInstance->setNodes(oNodeList);
             }
             bool hasGroundNode() {
                 return m_pInstance->hasGroundNode();
@@ -140,13 +280,86 @@ namespace SimulationEngineWrapper {
                 ManagedObject(new SimulationEngine::Inductor(iNodeS, iNodeD, m_dInductance)) { ; }
     };
         
+    public ref class SourceWaveform : ManagedObject<std::shared_ptr<const SimulationEngine::SourceWaveform>> {
+
+        public:
+
+            double getValue(const double dTime) {
+                return (*m_pInstance)->getValue(dTime);
+            }
+            std::shared_ptr<const SimulationEngine::SourceWaveform> getWaveform() {
+                return *m_pInstance;
+            }
+
+        protected:
+
+            SourceWaveform(SimulationEngine::SourceWaveform* pWaveform) :
+                ManagedObject(new std::shared_ptr<const SimulationEngine::SourceWaveform>(pWaveform)) { ; }
+    };
+
+    public ref class PiecewiseLinearWaveform : SourceWaveform {
+
+        public:
+
+            PiecewiseLinearWaveform(array<double>^ oTimes, array<double>^ oValues) :
+                SourceWaveform(createWaveform(oTimes, oValues)) { ; }
+
+        private:
+
+            static SimulationEngine::SourceWaveform* createWaveform(array<double>^ oTimes, array<double>^ oValues) {
+                std::vector<double> oTimeList(oTimes->Length);
+                std::vector<double> oValueList(oValues->Length);
+                for (int iPointIndex = 0; iPointIndex < oTimes->Length; iPointIndex++) {
+                    oTimeList[iPointIndex] = oTimes[iPointIndex];
+                }
+                for (int iPointIndex = 0; iPointIndex < oValues->Length; iPointIndex++) {
+                    oValueList[iPointIndex] = oValues[iPointIndex];
+                }
+                return new SimulationEngine::PiecewiseLinearWaveform(oTimeList, oValueList);
+            }
+    };
+
+    public ref class PulseWaveform : SourceWaveform {
+
+        public:
+
+            PulseWaveform(const double dInitialValue, const double dPulsedValue, const double dDelay, const double dRiseTime, const double dFallTime, const double dPulseWidth, const double dPeriod) :
+                SourceWaveform(new SimulationEngine::PulseWaveform(dInitialValue, dPulsedValue, dDelay, dRiseTime, dFallTime, dPulseWidth, dPeriod)) { ; }
+    };
+
+    public ref class SineWaveform : SourceWaveform {
+
+        public:
+
+            SineWaveform(const double dOffset, const double dAmplitude, const double dFrequency, const double dDelay, const double dDamping, const double dPhase) :
+                SourceWaveform(new SimulationEngine::SineWaveform(dOffset, dAmplitude, dFrequency, dDelay, dDamping, dPhase)) { ; }
+    };
+
+    public ref class SampledWaveform : SourceWaveform {
+
+        public:
+
+            SampledWaveform(String^ sPath, const double dSampleTime, const double dStartTime) :
+                SourceWaveform(new SimulationEngine::SampledWaveform(msclr::interop::marshal_as<std::string>(sPath), dSampleTime, dStartTime)) { ; }
+    };
+
     public ref class LinearCircuit : ManagedObject<SimulationEngine::LinearCircuitSimulationCC> {
 
         public:
 
-            LinearCircuit(const int iNumComponents) :
+            LinearCircuit() :
+                ManagedObject(new SimulationEngine::LinearCircuitSimulationCC()) { ; }
+            LinearCircuit(const int iNumComponents) : // Only reserves storage
                 ManagedObject(new SimulationEngine::LinearCircuitSimulationCC(iNumComponents)) { ; }
 
+            void reserve(const int iNumComponents) {
+                m_pInstance->reserve(iNumComponents);
+            }
+
+            int getNumComponents() {
+                return (int)m_pInstance->getNumComponents();
+            }
+
             int addResistor(const int iNodeS, const int iNodeD, const double dResistance) {
                 return static_cast<int>(m_pInstance->addComponent(make_unique<SimulationEngine::Resistor>(iNodeS, iNodeD, dResistance)));
             }
@@ -159,6 +372,42 @@ namespace SimulationEngineWrapper {
             int addGroundedVoltageSource(const int iNodeS, const int iNodeD, const double dVoltage, const double dResistance) {
                 return static_cast<int>(m_pInstance->addComponent(make_unique<SimulationEngine::GroundedVoltageSource>(iNodeS, iNodeD, dVoltage, dResistance)));
             }
+            int addGroundedVoltageSource(const int iNodeS, const int iNodeD, SourceWaveform^ oVoltage, const double dResistance) {
+                std::unique_ptr<SimulationEngine::GroundedVoltageSource> pSource = make_unique<SimulationEngine::GroundedVoltageSource>(iNodeS, iNodeD, 1, dResistance);
+                pSource->setVoltageWaveform(oVoltage->getWaveform());
+                return static_cast<int>(m_pInstance->addComponent(std::move(pSource)));
+            }
+            int addGround(const int iNode) {
+                return static_cast<int>(m_pInstance->addComponent(make_unique<SimulationEngine::Ground>(iNode)));
+            }
+            int addVoltageSource(const int iNodeS, const int iNodeD, const double dVoltage) {
+                return static_cast<int>(m_pInstance->addComponent(make_unique<SimulationEngine::VoltageSource>(iNodeS, iNodeD, dVoltage)));
+            }
+            int addVoltageSource(const int iNodeS, const int iNodeD, SourceWaveform^ oVoltage) {
+                std::unique_ptr<SimulationEngine::VoltageSource> pSource = make_unique<SimulationEngine::VoltageSource>(iNodeS, iNodeD, 0);
+                pSource->setVoltageWaveform(oVoltage->getWaveform());
+                return static_cast<int>(m_pInstance->addComponent(std::move(pSource)));
+            }
+            int addCurrentSource(const int iNodeS, const int iNodeD, const double dCurrent) {
+                return static_cast<int>(m_pInstance->addComponent(make_unique<SimulationEngine::CurrentSource>(iNodeS, iNodeD, dCurrent)));
+            }
+            int addCurrentSource(const int iNodeS, const int iNodeD, SourceWaveform^ oCurrent) {
+                std::unique_ptr<SimulationEngine::CurrentSource> pSource = make_unique<SimulationEngine::CurrentSource>(iNodeS, iNodeD, 0);
+                pSource->setCurrentWaveform(oCurrent->getWaveform());
+                return static_cast<int>(m_pInstance->addComponent(std::move(pSource)));
+            }
+            int addVoltageControlledVoltageSource(const int iNodeS, const int iNodeD, const int iControlNodeS, const int iControlNodeD, const double dGain) {
+                return static_cast<int>(m_pInstance->addComponent(make_unique<SimulationEngine::VoltageControlledVoltageSource>(iNodeS, iNodeD, iControlNodeS, iControlNodeD, dGain)));
+            }
+            int addVoltageControlledCurrentSource(const int iNodeS, const int iNodeD, const int iControlNodeS, const int iControlNodeD, const double dTransconductance) {
+                return static_cast<int>(m_pInstance->addComponent(make_unique<SimulationEngine::VoltageControlledCurrentSource>(iNodeS, iNodeD, iControlNodeS, iControlNodeD, dTransconductance)));
+            }
+            int addCurrentControlledCurrentSource(const int iNodeS, const int iNodeD, const int iControlNodeS, const int iControlNodeD, const double dGain) {
+                return static_cast<int>(m_pInstance->addComponent(make_unique<SimulationEngine::CurrentControlledCurrentSource>(iNodeS, iNodeD, iControlNodeS, iControlNodeD, dGain)));
+            }
+            int addCurrentControlledVoltageSource(const int iNodeS, const int iNodeD, const int iControlNodeS, const int iControlNodeD, const double dTransresistance) {
+                return static_cast<int>(m_pInstance->addComponent(make_unique<SimulationEngine::CurrentControlledVoltageSource>(iNodeS, iNodeD, iControlNodeS, iControlNodeD, dTransresistance)));
+            }
             void setStopTime(const double dStopTime) {
                 m_pInstance->setStopTime(dStopTime);
             }
@@ -174,6 +423,83 @@ namespace SimulationEngineWrapper {
             double getCurrent(const int iComponentIndex) {
                 return m_pInstance->getCurrent(iComponentIndex);
             }
+            void setSparseSolver(const bool bSparse) {
+                m_pInstance->setMatrixSolverType(bSparse ? MatrixSolverType::Sparse : MatrixSolverType::Dense);
+            }
+            void setAdaptiveTimeStep(const double dMinTimeStep, const double dMaxTimeStep) {
+                m_pInstance->setAdaptiveTimeStep(dMinTimeStep, dMaxTimeStep);
+            }
+            void setFixedTimeStep() {
+                m_pInstance->setFixedTimeStep();
+            }
+            // The next initalize starts the transient from the DC operating point
+            void setStartFromOperatingPoint(const bool bStartFromOperatingPoint) {
+                m_pInstance->setStartFromOperatingPoint(bStartFromOperatingPoint);
+            }
+            // DC solution, read with getVoltage/getCurrent
+            void solveOperatingPoint() {
+                m_pInstance->solveOperatingPoint();
+            }
+            void setTruncationErrorTolerance(const double dRelativeTolerance, const double dAbsoluteTolerance) {
+                m_pInstance->setTruncationErrorTolerance(dRelativeTolerance, dAbsoluteTolerance);
+            }
+            double getCurrentTimeStep() {
+                return m_pInstance->getCurrentTimeStep();
+            }
+            int getNumRejectedSteps() {
+                return static_cast<int>(m_pInstance->getNumRejectedSteps());
+            }
+            int getNumIslands() {
+                return static_cast<int>(m_pInstance->getNumIslands());
+            }
+            void setFactorizationCacheCapacity(const int iCapacity) {
+                m_pInstance->setFactorizationCacheCapacity(iCapacity);
+            }
+            int getNumFactorizationCacheHits() {
+                return static_cast<int>(m_pInstance->getNumFactorizationCacheHits());
+            }
+            int addVoltageProbe(const int iNode) {
+                return static_cast<int>(m_pInstance->addVoltageProbe(iNode));
+            }
+            int addCurrentProbe(const int iComponentIndex) {
+                return static_cast<int>(m_pInstance->addCurrentProbe(iComponentIndex));
+            }
+            void clearProbes() {
+                m_pInstance->clearProbes();
+            }
+            // The probes are written to the file from the next initalize on, every iDecimation-th step and the last step
+            void recordToCsv(String^ sPath, const int iDecimation) {
+                m_pInstance->setRecorder(make_unique<WaveformRecorder>(make_unique<CsvWaveformSink>(msclr::interop::marshal_as<std::string>(sPath))), iDecimation);
+            }
+            void recordToBinary(String^ sPath, const int iDecimation) {
+                m_pInstance->setRecorder(make_unique<WaveformRecorder>(make_unique<BinaryWaveformSink>(msclr::interop::marshal_as<std::string>(sPath))), iDecimation);
+            }
+            // Closes the file
+            void stopRecording() {
+                m_pInstance->setRecorder(nullptr);
+            }
+            int getRunRowSize() {
+                return static_cast<int>(m_pInstance->getRunRowSize());
+            }
+            int getNumRemainingSteps() {
+                return static_cast<int>(m_pInstance->getNumRemainingSteps());
+            }
+            // Steps until the stop time or until oOutput is full with one native call. Rows are the time followed by the
+            // probe values, the number of rows written is returned and the next call continues the run.
+            int run(array<double>^ oOutput) {
+                if (oOutput->Length == 0)
+                    return 0;
+                pin_ptr<double> pOutput = &oOutput[0];
+                return static_cast<int>(m_pInstance->run(std::span<double>(pOutput, static_cast<size_t>(oOutput->Length))));
+            }
+            // Runs to the stop time and returns every row
+            array<double>^ runToEnd() {
+                array<double>^ oOutput = gcnew array<double>(getNumRemainingSteps() * getRunRowSize());
+                int iNumRows = run(oOutput);
+                if (iNumRows * getRunRowSize() != oOutput->Length) // Adaptive time stepping only has an upper bound
+                    Array::Resize<double>(oOutput, iNumRows * getRunRowSize());
+                return oOutput;
+            }
             void initalize() {
                 m_pInstance->initalize(true);
             }
@@ -182,6 +508,334 @@ namespace SimulationEngineWrapper {
             }
     };
 
+    // K copies of one circuit that only differ in their source values, all instances share one factorization
+    public ref class LinearCircuitEnsemble : ManagedObject<SimulationEngine::LinearCircuitEnsembleSimulationCC> {
+
+        public:
+
+            LinearCircuitEnsemble(const int iNumComponents, const int iNumInstances) :
+                ManagedObject(new SimulationEngine::LinearCircuitEnsembleSimulationCC(iNumComponents, iNumInstances)) { ; }
+
+            int addResistor(const int iInstance, const int iNodeS, const int iNodeD, const double dResistance) {
+                return static_cast<int>(m_pInstance->addInstanceComponent(iInstance, make_unique<SimulationEngine::Resistor>(iNodeS, iNodeD, dResistance)));
+            }
+            int addInductor(const int iInstance, const int iNodeS, const int iNodeD, const double dInductance) {
+                return static_cast<int>(m_pInstance->addInstanceComponent(iInstance, make_unique<SimulationEngine::Inductor>(iNodeS, iNodeD, dInductance)));
+            }
+            int addCapacitor(const int iInstance, const int iNodeS, const int iNodeD, const double dCapacitance) {
+                return static_cast<int>(m_pInstance->addInstanceComponent(iInstance, make_unique<SimulationEngine::Capacitor>(iNodeS, iNodeD, dCapacitance)));
+            }
+            int addGroundedVoltageSource(const int iInstance, const int iNodeS, const int iNodeD, const double dVoltage, const double dResistance) {
+                return static_cast<int>(m_pInstance->addInstanceComponent(iInstance, make_unique<SimulationEngine::GroundedVoltageSource>(iNodeS, iNodeD, dVoltage, dResistance)));
+            }
+            int addGroundedVoltageSource(const int iInstance, const int iNodeS, const int iNodeD, SourceWaveform^ oVoltage, const double dResistance) {
+                std::unique_ptr<SimulationEngine::GroundedVoltageSource> pSource = make_unique<SimulationEngine::GroundedVoltageSource>(iNodeS, iNodeD, 1, dResistance);
+                pSource->setVoltageWaveform(oVoltage->getWaveform());
+                return static_cast<int>(m_pInstance->addInstanceComponent(iInstance, std::move(pSource)));
+            }
+            int addGround(const int iInstance, const int iNode) {
+                return static_cast<int>(m_pInstance->addInstanceComponent(iInstance, make_unique<SimulationEngine::Ground>(iNode)));
+            }
+            int addVoltageSource(const int iInstance, const int iNodeS, const int iNodeD, const double dVoltage) {
+                return static_cast<int>(m_pInstance->addInstanceComponent(iInstance, make_unique<SimulationEngine::VoltageSource>(iNodeS, iNodeD, dVoltage)));
+            }
+            int addVoltageSource(const int iInstance, const int iNodeS, const int iNodeD, SourceWaveform^ oVoltage) {
+                std::unique_ptr<SimulationEngine::VoltageSource> pSource = make_unique<SimulationEngine::VoltageSource>(iNodeS, iNodeD, 0);
+                pSource->setVoltageWaveform(oVoltage->getWaveform());
+                return static_cast<int>(m_pInstance->addInstanceComponent(iInstance, std::move(pSource)));
+            }
+            int addCurrentSource(const int iInstance, const int iNodeS, const int iNodeD, const double dCurrent) {
+                return static_cast<int>(m_pInstance->addInstanceComponent(iInstance, make_unique<SimulationEngine::CurrentSource>(iNodeS, iNodeD, dCurrent)));
+            }
+            int addCurrentSource(const int iInstance, const int iNodeS, const int iNodeD, SourceWaveform^ oCurrent) {
+                std::unique_ptr<SimulationEngine::CurrentSource> pSource = make_unique<SimulationEngine::CurrentSource>(iNodeS, iNodeD, 0);
+                pSource->setCurrentWaveform(oCurrent->getWaveform());
+                return static_cast<int>(m_pInstance->addInstanceComponent(iInstance, std::move(pSource)));
+            }
+            int addVoltageControlledVoltageSource(const int iInstance, const int iNodeS, const int iNodeD, const int iControlNodeS, const int iControlNodeD, const double dGain) {
+                return static_cast<int>(m_pInstance->addInstanceComponent(iInstance, make_unique<SimulationEngine::VoltageControlledVoltageSource>(iNodeS, iNodeD, iControlNodeS, iControlNodeD, dGain)));
+            }
+            int addVoltageControlledCurrentSource(const int iInstance, const int iNodeS, const int iNodeD, const int iControlNodeS, const int iControlNodeD, const double dTransconductance) {
+                return static_cast<int>(m_pInstance->addInstanceComponent(iInstance, make_unique<SimulationEngine::VoltageControlledCurrentSource>(iNodeS, iNodeD, iControlNodeS, iControlNodeD, dTransconductance)));
+            }
+            int addCurrentControlledCurrentSource(const int iInstance, const int iNodeS, const int iNodeD, const int iControlNodeS, const int iControlNodeD, const double dGain) {
+                return static_cast<int>(m_pInstance->addInstanceComponent(iInstance, make_unique<SimulationEngine::CurrentControlledCurrentSource>(iNodeS, iNodeD, iControlNodeS, iControlNodeD, dGain)));
+            }
+            int addCurrentControlledVoltageSource(const int iInstance, const int iNodeS, const int iNodeD, const int iControlNodeS, const int iControlNodeD, const double dTransresistance) {
+                return static_cast<int>(m_pInstance->addInstanceComponent(iInstance, make_unique<SimulationEngine::CurrentControlledVoltageSource>(iNodeS, iNodeD, iControlNodeS, iControlNodeD, dTransresistance)));
+            }
+            int getNumInstances() {
+                return static_cast<int>(m_pInstance->getNumInstances());
+            }
+            void setStopTime(const double dStopTime) {
+                m_pInstance->setStopTime(dStopTime);
+            }
+            void setTimeStep(const double dTimeStep) {
+                m_pInstance->setTimeStep(dTimeStep);
+            }
+            double getTime() {
+                return m_pInstance->getTime();
+            }
+            double getVoltage(const int iInstance, const int iNode) {
+                return m_pInstance->getVoltage(iInstance, iNode);
+            }
+            double getCurrent(const int iInstance, const int iComponentIndex) {
+                return m_pInstance->getCurrent(iInstance, iComponentIndex);
+            }
+            void setSparseSolver(const bool bSparse) {
+                m_pInstance->setMatrixSolverType(bSparse ? MatrixSolverType::Sparse : MatrixSolverType::Dense);
+            }
+            void initalize() {
+                m_pInstance->initalize(true);
+            }
+            bool step() {
+                return m_pInstance->step();
+            }
+    };
+
+    // Same circuits as LinearCircuit for the built in component types, stepped without per-component virtual calls
+    public ref class PartitionedCircuit : ManagedObject<SimulationEngine::PartitionedCircuitSimulation> {
+
+        public:
+
+            PartitionedCircuit() :
+                ManagedObject(new SimulationEngine::PartitionedCircuitSimulation()) { ; }
+
+            int addResistor(const int iNodeS, const int iNodeD, const double dResistance) {
+                return static_cast<int>(m_pInstance->addResistor(iNodeS, iNodeD, dResistance));
+            }
+            int addInductor(const int iNodeS, const int iNodeD, const double dInductance) {
+                return static_cast<int>(m_pInstance->addInductor(iNodeS, iNodeD, dInductance));
+            }
+            int addCapacitor(const int iNodeS, const int iNodeD, const double dCapacitance) {
+                return static_cast<int>(m_pInstance->addCapacitor(iNodeS, iNodeD, dCapacitance));
+            }
+            int addGroundedVoltageSource(const int iNodeS, const int iNodeD, const double dVoltage, const double dResistance) {
+                return static_cast<int>(m_pInstance->addGroundedVoltageSource(iNodeS, iNodeD, dVoltage, dResistance));
+            }
+            void setComponentValue(const int iComponentIndex, const double dValue) {
+                m_pInstance->setComponentValue(iComponentIndex, dValue);
+            }
+            int getNumComponents() {
+                return static_cast<int>(m_pInstance->getNumComponents());
+            }
+            void setStopTime(const double dStopTime) {
+                m_pInstance->setStopTime(dStopTime);
+            }
+            void setTimeStep(const double dTimeStep) {
+                m_pInstance->setTimeStep(dTimeStep);
+            }
+            double getTime() {
+                return m_pInstance->getTime();
+            }
+            double getVoltage(const int iNode) {
+                return m_pInstance->getVoltage(iNode);
+            }
+            double getCurrent(const int iComponentIndex) {
+                return m_pInstance->getCurrent(iComponentIndex);
+            }
+            void setSparseSolver(const bool bSparse) {
+                m_pInstance->setMatrixSolverType(bSparse ? MatrixSolverType::Sparse : MatrixSolverType::Dense);
+            }
+            void initalize() {
+                m_pInstance->initalize();
+            }
+            bool step() {
+                return m_pInstance->step();
+            }
+    };
+
+    public ref class CircuitDescription : ManagedObject<SimulationEngine::CircuitDescription> {
+
+        public:
+
+            CircuitDescription() :
+                ManagedObject(new SimulationEngine::CircuitDescription()) { ; }
+            CircuitDescription(const SimulationEngine::CircuitDescription& oCircuit) :
+                ManagedObject(new SimulationEngine::CircuitDescription(oCircuit)) { ; }
+
+            int addResistor(const int iNodeS, const int iNodeD, const double dResistance) {
+                return static_cast<int>(m_pInstance->addResistor(iNodeS, iNodeD, dResistance));
+            }
+            int addInductor(const int iNodeS, const int iNodeD, const double dInductance) {
+                return static_cast<int>(m_pInstance->addInductor(iNodeS, iNodeD, dInductance));
+            }
+            int addCapacitor(const int iNodeS, const int iNodeD, const double dCapacitance) {
+                return static_cast<int>(m_pInstance->addCapacitor(iNodeS, iNodeD, dCapacitance));
+            }
+            int addGroundedVoltageSource(const int iNodeS, const int iNodeD, const double dVoltage, const double dResistance) {
+                return static_cast<int>(m_pInstance->addGroundedVoltageSource(iNodeS, iNodeD, dVoltage, dResistance));
+            }
+            int getNumComponents() {
+                return static_cast<int>(m_pInstance->getNumComponents());
+            }
+
+        internal:
+
+            const SimulationEngine::CircuitDescription& getDescription() {
+                return *m_pInstance;
+            }
+    };
+
+    public ref class Netlist : ManagedObject<SimulationEngine::Netlist> {
+
+        public:
+
+            Netlist(String^ sPath) :
+                ManagedObject(new SimulationEngine::Netlist(NetlistParser::parseFile(msclr::interop::marshal_as<std::string>(sPath)))) { ; }
+            Netlist(const SimulationEngine::Netlist& oNetlist) :
+                ManagedObject(new SimulationEngine::Netlist(oNetlist)) { ; }
+
+            // Binary circuit files (see BinaryCircuitFile.h)
+            static Netlist^ loadBinary(String^ sPath) {
+                return gcnew Netlist(BinaryCircuitFile(msclr::interop::marshal_as<std::string>(sPath)).toNetlist());
+            }
+            static void convertToBinary(String^ sTextPath, String^ sBinaryPath) {
+                BinaryCircuitFile::convertNetlist(msclr::interop::marshal_as<std::string>(sTextPath), msclr::interop::marshal_as<std::string>(sBinaryPath));
+            }
+
+            String^ getTitle() {
+                return gcnew String(m_pInstance->sTitle.c_str());
+            }
+            int getVoltageScopeNode() {
+                return static_cast<int>(m_pInstance->iVoltageScopeNode);
+            }
+            int getCurrentScopeComponent() {
+                return static_cast<int>(m_pInstance->iCurrentScopeComponent);
+            }
+            double getTimeStep() {
+                return m_pInstance->dTimeStep;
+            }
+            double getStopTime() {
+                return m_pInstance->dStopTime;
+            }
+            int getNumComponents() {
+                return static_cast<int>(m_pInstance->oCircuit.getNumComponents());
+            }
+            CircuitDescription^ getCircuit() {
+                return gcnew CircuitDescription(m_pInstance->oCircuit);
+            }
+            // Components, time step and stop time from the file, ready to initalize
+            LinearCircuit^ createLinearCircuit() {
+                LinearCircuit^ oLinearCircuit = gcnew LinearCircuit(static_cast<int>(m_pInstance->oCircuit.getNumComponents()));
+
+                for (const ComponentDescription& oComponent : m_pInstance->oCircuit.getComponents()) {
+                    switch (oComponent.eKind) {
+                        case CircuitComponentKind::Resistor:
+                            oLinearCircuit->addResistor(static_cast<int>(oComponent.iNodeS), static_cast<int>(oComponent.iNodeD), oComponent.dValue);
+                            break;
+                        case CircuitComponentKind::Capacitor:
+                            oLinearCircuit->addCapacitor(static_cast<int>(oComponent.iNodeS), static_cast<int>(oComponent.iNodeD), oComponent.dValue);
+                            break;
+                        case CircuitComponentKind::Inductor:
+                            oLinearCircuit->addInductor(static_cast<int>(oComponent.iNodeS), static_cast<int>(oComponent.iNodeD), oComponent.dValue);
+                            break;
+                        case CircuitComponentKind::GroundedVoltageSource:
+                            oLinearCircuit->addGroundedVoltageSource(static_cast<int>(oComponent.iNodeS), static_cast<int>(oComponent.iNodeD), oComponent.dValue, oComponent.dSourceResistance);
+                            break;
+                    }
+                }
+                oLinearCircuit->setTimeStep(m_pInstance->dTimeStep);
+                oLinearCircuit->setStopTime(m_pInstance->dStopTime);
+
+                return oLinearCircuit;
+            }
+    };
+
+    public ref class ParameterSweep : ManagedObject<SimulationEngine::ParameterSweep> {
+
+        public:
+
+            ParameterSweep(CircuitDescription^ oCircuit, const double dStopTime, const double dTimeStep) :
+                ManagedObject(new SimulationEngine::ParameterSweep(oCircuit->getDescription(), dStopTime, dTimeStep)) { ; }
+
+            int addGridParameter(const int iComponentIndex, const double dStart, const double dStop, const int iNumPoints) {
+                return static_cast<int>(m_pInstance->addGridParameter(iComponentIndex, dStart, dStop, iNumPoints));
+            }
+            int addUniformParameter(const int iComponentIndex, const double dMin, const double dMax) {
+                return static_cast<int>(m_pInstance->addUniformParameter(iComponentIndex, dMin, dMax));
+            }
+            int addNormalParameter(const int iComponentIndex, const double dMean, const double dStandardDeviation) {
+                return static_cast<int>(m_pInstance->addNormalParameter(iComponentIndex, dMean, dStandardDeviation));
+            }
+            int addVoltageProbe(const int iNode) {
+                return static_cast<int>(m_pInstance->addVoltageProbe(iNode));
+            }
+            int addCurrentProbe(const int iComponentIndex) {
+                return static_cast<int>(m_pInstance->addCurrentProbe(iComponentIndex));
+            }
+            void setNumSamples(const int iNumSamples) {
+                m_pInstance->setNumSamples(iNumSamples);
+            }
+            void setSeed(const int iSeed) {
+                m_pInstance->setSeed(static_cast<std::uint64_t>(iSeed));
+            }
+            void setNumThreads(const int iNumThreads) {
+                m_pInstance->setNumThreads(iNumThreads);
+            }
+            int getNumVariants() {
+                return static_cast<int>(m_pInstance->getNumVariants());
+            }
+            int getNumFailedVariants() {
+                return static_cast<int>(m_pInstance->getNumFailedVariants());
+            }
+            double getParameterValue(const int iVariant, const int iParameterIndex) {
+                return m_pInstance->getParameterValue(iVariant, iParameterIndex);
+            }
+            double getResult(const int iVariant, const int iProbeIndex) {
+                return m_pInstance->getResult(iVariant, iProbeIndex);
+            }
+            void run() {
+                m_pInstance->run();
+            }
+    };
+
+    // Frequency response of a circuit, every grounded voltage source drives it with its voltage as the amplitude
+    public ref class AcAnalysis : ManagedObject<SimulationEngine::AcAnalysis> {
+
+        public:
+
+            AcAnalysis(CircuitDescription^ oCircuit) :
+                ManagedObject(new SimulationEngine::AcAnalysis(oCircuit->getDescription())) { ; }
+
+            void addFrequency(const double dFrequency) {
+                m_pInstance->addFrequency(dFrequency);
+            }
+            void addLinearFrequencies(const double dStart, const double dStop, const int iNumPoints) {
+                m_pInstance->addLinearFrequencies(dStart, dStop, iNumPoints);
+            }
+            void addLogFrequencies(const double dStart, const double dStop, const int iNumPoints) {
+                m_pInstance->addLogFrequencies(dStart, dStop, iNumPoints);
+            }
+            void clearFrequencies() {
+                m_pInstance->clearFrequencies();
+            }
+            int addVoltageProbe(const int iNode) {
+                return static_cast<int>(m_pInstance->addVoltageProbe(iNode));
+            }
+            int addCurrentProbe(const int iComponentIndex) {
+                return static_cast<int>(m_pInstance->addCurrentProbe(iComponentIndex));
+            }
+            void setNumThreads(const int iNumThreads) {
+                m_pInstance->setNumThreads(iNumThreads);
+            }
+            int getNumFrequencies() {
+                return static_cast<int>(m_pInstance->getNumFrequencies());
+            }
+            double getFrequency(const int iFrequencyIndex) {
+                return m_pInstance->getFrequency(iFrequencyIndex);
+            }
+            double getMagnitude(const int iFrequencyIndex, const int iProbeIndex) {
+                return m_pInstance->getMagnitude(iFrequencyIndex, iProbeIndex);
+            }
+            double getPhase(const int iFrequencyIndex, const int iProbeIndex) { // Radians
+                return m_pInstance->getPhase(iFrequencyIndex, iProbeIndex);
+            }
+            void run() {
+                m_pInstance->run();
+            }
+    };
+
     public ref class Resistor : ManagedObject<SimulationEngine::Resistor> {
 
         public:
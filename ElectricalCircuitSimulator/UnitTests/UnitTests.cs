@@ -43,6 +43,126 @@ namespace UnitTests
         }
     }
 
+    // Series RC circuit shared by the integration tests. A 30 V source with a 10 ohm internal resistance (node 2 is
+    // ground) charges 0.2 F through 10 ohm, the reference values are the ones after 10 steps of 1 s.
+    public class SeriesRC
+    {
+        public const double dStopTime = 10;
+        public const double dTimeStep = 1;
+        public const int iNumSteps = 10;
+        // The same circuit as a netlist, a ';' may follow a component
+        public const string sNetlist = "Series RC Circuit\nGroundedVoltageSource(2, 1, 30, 10)\nResistor(1, 0, 10)\nCapacitor(0, 2, 0.2);\nScopeV(0)\nScopeI(2)\nTimeStep(1)\nStopTime(10)\n";
+
+        public static void addComponents(LinearCircuit oLinearCircuit)
+        {
+            oLinearCircuit.addGroundedVoltageSource(2, 1, 30, 10); // Node 2 is ground
+            oLinearCircuit.addResistor(1, 0, 10);
+            oLinearCircuit.addCapacitor(0, 2, 0.2);
+            oLinearCircuit.setStopTime(dStopTime);
+            oLinearCircuit.setTimeStep(dTimeStep);
+        }
+
+        public static void addComponents(PartitionedCircuit oCircuit)
+        {
+            oCircuit.addGroundedVoltageSource(2, 1, 30, 10); // Node 2 is ground
+            oCircuit.addResistor(1, 0, 10);
+            oCircuit.addCapacitor(0, 2, 0.2);
+            oCircuit.setStopTime(dStopTime);
+            oCircuit.setTimeStep(dTimeStep);
+        }
+
+        // Returns the resistor index, the stop time and time step are passed to whatever simulates the description
+        public static int addComponents(CircuitDescription oCircuit)
+        {
+            int iResistor;
+
+            oCircuit.addGroundedVoltageSource(2, 1, 30, 10); // Node 2 is ground
+            iResistor = oCircuit.addResistor(1, 0, 10);
+            oCircuit.addCapacitor(0, 2, 0.2);
+
+            return iResistor;
+        }
+
+        // The circuit is linear and starts discharged, so the results scale with dVoltage (30 V gives the reference values)
+        public static void addComponents(LinearCircuitEnsemble oEnsemble, int iInstance, double dVoltage)
+        {
+            oEnsemble.addGroundedVoltageSource(iInstance, 2, 1, dVoltage, 10); // Node 2 is ground
+            oEnsemble.addResistor(iInstance, 1, 0, 10);
+            oEnsemble.addCapacitor(iInstance, 0, 2, 0.2);
+            oEnsemble.setStopTime(dStopTime);
+            oEnsemble.setTimeStep(dTimeStep);
+        }
+
+        // Steps until the stop time, which takes exactly iNumSteps steps
+        public static void stepToEnd(Func<bool> oStep)
+        {
+            bool bDone;
+            int iSteps = 0;
+
+            do
+            {
+                bDone = oStep();
+                iSteps++;
+            }
+            while (bDone == false);
+
+            Assert.IsTrue(iSteps == iNumSteps, "Simulation did not finish in the correct number of time steps!");
+        }
+
+        public static void checkNode0Voltage(double dVoltage)
+        {
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * dVoltage)) / 10000 == 27.2224, "Incorrect voltage at node 0! Expected 27.2224");
+        }
+
+        public static void checkCurrent(double dCurrent)
+        {
+            Assert.IsTrue(Math.Truncate(Math.Round(100000 * dCurrent)) / 100000 == 0.13888, "Incorrect series current! Expected 0.13888");
+        }
+
+        // All node voltages, every component carries the same series current
+        public static void checkResult(Func<int, double> oGetVoltage, Func<int, double> oGetCurrent)
+        {
+            checkNode0Voltage(oGetVoltage(0));
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oGetVoltage(1))) / 10000 == 28.6112, "Incorrect voltage at node 1! Expected 28.6112");
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oGetVoltage(2))) / 10000 == 0, "Incorrect voltage at node 2! Expected 0");
+            for (int iComponent = 0; iComponent < 3; iComponent++)
+                checkCurrent(oGetCurrent(iComponent));
+        }
+    }
+
+    // The series RC circuit with the capacitor replaced by a 50 H inductor, same timing and reference point
+    public class SeriesRL
+    {
+        public static void addComponents(LinearCircuit oLinearCircuit)
+        {
+            oLinearCircuit.addGroundedVoltageSource(2, 1, 30, 10); // Node 2 is ground
+            oLinearCircuit.addResistor(1, 0, 10);
+            oLinearCircuit.addInductor(0, 2, 50);
+            oLinearCircuit.setStopTime(SeriesRC.dStopTime);
+            oLinearCircuit.setTimeStep(SeriesRC.dTimeStep);
+        }
+
+        public static void checkNode0Voltage(double dVoltage)
+        {
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * dVoltage)) / 10000 == 0.6503, "Incorrect voltage at node 0! Expected 0.6503");
+        }
+
+        public static void checkCurrent(double dCurrent)
+        {
+            Assert.IsTrue(Math.Truncate(Math.Round(100000 * dCurrent)) / 100000 == 1.46748, "Incorrect series current! Expected 1.46748");
+        }
+
+        // All node voltages, every component carries the same series current
+        public static void checkResult(Func<int, double> oGetVoltage, Func<int, double> oGetCurrent)
+        {
+            checkNode0Voltage(oGetVoltage(0));
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oGetVoltage(1))) / 10000 == 15.3252, "Incorrect voltage at node 1! Expected 15.3252");
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oGetVoltage(2))) / 10000 == 0, "Incorrect voltage at node 2! Expected 0");
+            for (int iComponent = 0; iComponent < 3; iComponent++)
+                checkCurrent(oGetCurrent(iComponent));
+        }
+    }
+
     // We need this because UI elements have to be tested from STA threads
     public class STATestMethod : TestMethodAttribute
     {
@@ -211,12 +331,107 @@ namespace UnitTests
             oMatrix.Dispose();
         }
 
+        [TestMethod]
+        public void TestSparseMatrix()
+        {
+            SparseMatrix oMatrix = new SparseMatrix();
+            oMatrix = new SparseMatrix(4, 5);
+            Assert.IsTrue(oMatrix.getNumRows() == 4, "Incorrect matrix row count! Expected 4");
+            Assert.IsTrue(oMatrix.getNumColumns() == 5, "Incorrect matrix column count! Expected 5");
+            Assert.IsTrue(oMatrix.getNumNonZeros() == 0, "Incorrect non-zero count! Expected 0");
+            AssertAction.VerifyAssert(() => oMatrix = new SparseMatrix(0, 5), "Expected 'Matrix dimensions must be positive and non-zero!' error, did not get it!");
+            AssertAction.VerifyAssert(() => oMatrix = new SparseMatrix(5, 0), "Expected 'Matrix dimensions must be positive and non-zero!' error, did not get it!");
+            AssertAction.VerifyAssert(() => oMatrix.setValue(4, 1, 11), "Expected 'Location beyond dimensions of matrix!' error, did not get it!");
+            AssertAction.VerifyAssert(() => oMatrix.getValue(1, 5), "Expected 'Location beyond dimensions of matrix!' error, did not get it!");
+
+            oMatrix.setValue(2, 3, 11);
+            oMatrix.setValue(0, 3, 27);
+            Assert.IsTrue(oMatrix.getNumNonZeros() == 2, "Incorrect non-zero count! Expected 2");
+            Assert.IsTrue(oMatrix.getValue(1, 1) == 0, "Incorrect matrix value! Expected 0");
+            Assert.IsTrue(oMatrix.getNumNonZeros() == 2, "Reading a missing entry must not insert it!");
+            oMatrix.compress();
+            Assert.IsTrue(oMatrix.getValue(2, 3) == 11 && oMatrix.getValue(0, 3) == 27, "Incorrect matrix values after compress!");
+            oMatrix.setValue(2, 3, 5);
+            oMatrix.setValue(3, 0, 7);
+            Assert.IsTrue(oMatrix.getNumNonZeros() == 3, "Incorrect non-zero count! Expected 3");
+            oMatrix.compress();
+            Assert.IsTrue(oMatrix.getValue(2, 3) == 5 && oMatrix.getValue(3, 0) == 7, "Incorrect matrix values after second compress!");
+            oMatrix.printMatrix();
+            oMatrix.clear();
+            Assert.IsTrue(oMatrix.getValue(2, 3) == 0 && oMatrix.getNumNonZeros() == 3, "Clear must zero values and keep the sparsity pattern!");
+            oMatrix.Dispose();
+        }
+
+        [TestMethod]
+        public void TestSimdKernels()
+        {
+            Random oRandom = new Random(17);
+            int iSupportedLevel = SimdKernels.getSupportedSimdLevel();
+            Assert.IsTrue(iSupportedLevel >= 0 && iSupportedLevel <= 2, "Incorrect supported SIMD level!");
+
+            for (int iLevel = 0; iLevel <= iSupportedLevel; iLevel++)
+            {
+                Assert.IsTrue(SimdKernels.setSimdLevel(iLevel) == iLevel, "Supported SIMD level could not be selected!");
+                for (int iLength = 1; iLength < 70; iLength++)
+                {
+                    double[] oA = new double[iLength];
+                    double[] oB = new double[iLength];
+                    for (int iIndex = 0; iIndex < iLength; iIndex++)
+                    {
+                        oA[iIndex] = oRandom.NextDouble() * 2 - 1;
+                        oB[iIndex] = oRandom.NextDouble() * 2 - 1;
+                    }
+                    Assert.IsTrue(Math.Abs(SimdKernels.dotProduct(oA, oB) - SimdKernels.dotProductScalar(oA, oB)) < 1e-12, "SIMD dot product does not match the scalar reference!");
+
+                    // Subtract scaled may fuse the multiply add and differ by one rounding
+                    double[] oSimd = (double[])oA.Clone();
+                    double[] oReference = (double[])oA.Clone();
+                    SimdKernels.subtractScaled(oSimd, oB, -1.25);
+                    SimdKernels.subtractScaledScalar(oReference, oB, -1.25);
+                    for (int iIndex = 0; iIndex < iLength; iIndex++)
+                        Assert.IsTrue(Math.Abs(oSimd[iIndex] - oReference[iIndex]) < 1e-15, "SIMD subtract scaled does not match the scalar reference!");
+                }
+            }
+            Assert.IsTrue(SimdKernels.setSimdLevel(2) == iSupportedLevel, "Unsupported SIMD level must be clamped!");
+        }
+
         [TestMethod]
         public void TestPLU_Factorization()
         {
             PLU_Factorization oPLU_Factorization = new PLU_Factorization();
             oPLU_Factorization = new PLU_Factorization(); // Check for memory access problems
             oPLU_Factorization.Dispose();
+
+            // Zero leading diagonal, every policy has to swap rows. The first refactor keeps the pattern, the second
+            // zeroes the reused column 0 pivot and has to fall back to a new pivot search.
+            double[,] oA = { { 0, 2, 1 }, { 1, 1, 1 }, { 2, 1, 3 } };
+            double[,] oRefactorA = { { 0, 3, 1 }, { 2, 1, 1 }, { 1, 1, 4 } };
+            double[,] oFallbackA = { { 1, 2, 1 }, { 0, 1, 1 }, { 0, 1, 3 } };
+            double[] oB = { 7, 6, 13 };
+            double[] oRefactorB = { -1, 3, 8 };
+            double[] oFallbackB = { 8, 5, 11 };
+            double[] oExpectedX = { 1, 2, 3 };
+            double[] oExpectedRefactorX = { 1, -1, 2 };
+            double[] oX;
+
+            for (int iPolicy = 0; iPolicy <= 2; iPolicy++)
+            {
+                oPLU_Factorization = new PLU_Factorization();
+                oPLU_Factorization.factor(oA, iPolicy, 0.1);
+                Assert.IsTrue(oPLU_Factorization.getPivotingPolicy() == iPolicy, "Incorrect pivoting policy!");
+                oX = oPLU_Factorization.solve(oB);
+                for (int iIndex = 0; iIndex < 3; iIndex++)
+                    Assert.IsTrue(Math.Abs(oX[iIndex] - oExpectedX[iIndex]) < 1e-12, "Incorrect solution for pivoting policy " + iPolicy + "!");
+                oPLU_Factorization.refactor(oRefactorA);
+                oX = oPLU_Factorization.solve(oRefactorB);
+                for (int iIndex = 0; iIndex < 3; iIndex++)
+                    Assert.IsTrue(Math.Abs(oX[iIndex] - oExpectedRefactorX[iIndex]) < 1e-12, "Incorrect refactored solution for pivoting policy " + iPolicy + "!");
+                oPLU_Factorization.refactor(oFallbackA);
+                oX = oPLU_Factorization.solve(oFallbackB);
+                for (int iIndex = 0; iIndex < 3; iIndex++)
+                    Assert.IsTrue(Math.Abs(oX[iIndex] - oExpectedX[iIndex]) < 1e-12, "Incorrect solution after pivot search fallback for pivoting policy " + iPolicy + "!");
+                oPLU_Factorization.Dispose();
+            }
         }
 
         [TestMethod]
@@ -226,20 +441,27 @@ namespace UnitTests
 
             //AssertAction.VerifyAssert(() => oCircuitComponent = new LinearCircuitComponent()), "Expected 'Two node values must not be the same!' error, did not get it!");
 
-            oCircuitComponent = new LinearCircuitComponent(0, true, 1);
+            oCircuitComponent = new LinearCircuitComponent(new int[] { 1 }, true, 1);
             Assert.IsTrue(oCircuitComponent.getNumNodes() == 1, "Incorrect value! Expected 1");
             Assert.IsTrue(oCircuitComponent.hasGroundNode() == true, "Incorrect value! Expected true");
             Assert.IsTrue(oCircuitComponent.getGroundNode() == 1, "Incorrect value! Expected 1");
+            Assert.IsTrue(oCircuitComponent.getNode(0) == 1, "Incorrect value! Expected 1");
             AssertAction.VerifyAssert(() => oCircuitComponent.getNode(1), "Expected 'Index is out of bounds!' error, did not get it!");
             Assert.IsTrue(oCircuitComponent.getCurrent() == 0, "Incorrect value! Expected 0");
-            oCircuitComponent.setNodeList(0b0011001000000001);
+            oCircuitComponent.setNodes(new int[] { 1, 0, 2, 3 });
             Assert.IsTrue(oCircuitComponent.getNumNodes() == 4, "Incorrect value! Expected 4");
             Assert.IsTrue(oCircuitComponent.getNode(0) == 1, "Incorrect value! Expected 1");
-            Assert.IsTrue(oCircuitComponent.getNode(1) == 0, "Incorrect value! Expected 1");
-            Assert.IsTrue(oCircuitComponent.getNode(2) == 2, "Incorrect value! Expected 1");
-            Assert.IsTrue(oCircuitComponent.getNode(3) == 3, "Incorrect value! Expected 1");
+            Assert.IsTrue(oCircuitComponent.getNode(1) == 0, "Incorrect value! Expected 0");
+            Assert.IsTrue(oCircuitComponent.getNode(2) == 2, "Incorrect value! Expected 2");
+            Assert.IsTrue(oCircuitComponent.getNode(3) == 3, "Incorrect value! Expected 3");
+            oCircuitComponent.setNodes(new int[] { 7, 5000, 16, 2, 900, 31 }); // Past the inline node storage and the old 4 bit node limit
+            Assert.IsTrue(oCircuitComponent.getNumNodes() == 6, "Incorrect value! Expected 6");
+            Assert.IsTrue(oCircuitComponent.getNode(1) == 5000, "Incorrect value! Expected 5000");
+            Assert.IsTrue(oCircuitComponent.getNode(4) == 900, "Incorrect value! Expected 900");
+            Assert.IsTrue(oCircuitComponent.getNode(5) == 31, "Incorrect value! Expected 31");
+            AssertAction.VerifyAssert(() => oCircuitComponent.setNodes(new int[] { 3, 4, 3 }), "Expected 'Two node values must not be the same!' error, did not get it!");
 
-            oCircuitComponent = new LinearCircuitComponent(0, false, 0); // Check for memory access problems
+            oCircuitComponent = new LinearCircuitComponent(new int[] { 0 }, false, 0); // Check for memory access problems
         }
 
         [TestMethod]
@@ -271,8 +493,15 @@ namespace UnitTests
         {
             GroundedVoltageSource oGroundedVoltageSource = new GroundedVoltageSource(1, 2, 7, 10);
             oGroundedVoltageSource = new GroundedVoltageSource(0, 2, 4, 4);  // Check for memory access problems
-            AssertAction.VerifyAssert(() => oGroundedVoltageSource = new GroundedVoltageSource(1, 2, -7, 10), "Expected 'Voltage value must be greater than 0!' error, did not get it!");
+            oGroundedVoltageSource = new GroundedVoltageSource(1, 2, -7, 10);  // Negative source voltages are allowed
             AssertAction.VerifyAssert(() => oGroundedVoltageSource = new GroundedVoltageSource(1, 2, 7, -10), "Expected 'Resistance value must be greater than 0!' error, did not get it!");
+
+            LinearCircuit oLinearCircuit = new LinearCircuit(2);
+            oLinearCircuit.addGroundedVoltageSource(0, 1, -10, 1);
+            oLinearCircuit.addResistor(1, 0, 1);
+            oLinearCircuit.solveOperatingPoint();
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oLinearCircuit.getVoltage(1))) / 10000 == -5, "Incorrect DC voltage at node 1! Expected -5");
+            oLinearCircuit.Dispose();
         }
 
         [TestMethod]
@@ -284,9 +513,10 @@ namespace UnitTests
             oLinearCircuit.addGroundedVoltageSource(1, 2, 30, 10);
             oLinearCircuit.addCapacitor(1, 0, 10);
             oLinearCircuit.addResistor(3, 2, 10);
-            AssertAction.VerifyAssert(() => oLinearCircuit.addGroundedVoltageSource(1, 2, 30, 10), "Expected 'Simulation already has an across reference node, cannot add another one!' error, did not get it!");
+            AssertAction.VerifyAssert(() => oLinearCircuit.addGroundedVoltageSource(1, 2, 30, 10), "Expected 'The island containing node 1 already has an across reference node, cannot add another one!' error, did not get it!");
             oLinearCircuit.addInductor(4, 2, 10);
-            AssertAction.VerifyAssert(() => oLinearCircuit.addInductor(5, 2, 10), "Expected 'Simulation is already full of components!' error, did not get it!");
+            Assert.IsTrue(oLinearCircuit.addInductor(5, 2, 10) == 4, "Component storage must grow past the reserved count! Expected index 4");
+            Assert.IsTrue(oLinearCircuit.getNumComponents() == 5, "Expected 5 components");
             oLinearCircuit.setStopTime(10);
             AssertAction.VerifyAssert(() => oLinearCircuit.setStopTime(0), "Expected 'Stop time must be greater than 0!' error, did not get it!");
             oLinearCircuit.setTimeStep(1);
@@ -309,9 +539,8 @@ namespace UnitTests
             while (bDone == false && iSteps < 20);
             Assert.IsTrue(iSteps == 10, "Simulation did not finish in the correct number of time steps!");
 
-            AssertAction.VerifyAssert(() => new LinearCircuit(-5), "Expected 'Simulation must have a positive and non-zero number of components!' error, did not get it!");
-            AssertAction.VerifyAssert(() => new LinearCircuit(0), "Expected 'Simulation must have a positive and non-zero number of components!' error, did not get it!");
-            oLinearCircuit = new LinearCircuit(4);
+            oLinearCircuit = new LinearCircuit();
+            oLinearCircuit.reserve(4);
             oLinearCircuit.setStopTime(10);
             oLinearCircuit.setTimeStep(1);
             AssertAction.VerifyAssert(() => oLinearCircuit.initalize(), "Expected 'There are no components in the simulation!' error, did not get it!");
@@ -321,8 +550,12 @@ namespace UnitTests
             oLinearCircuit.setTimeStep(11);
             AssertAction.VerifyAssert(() => oLinearCircuit.initalize(), "Expected 'Stop time cannot be smaller than time step!' error, did not get it!");
             oLinearCircuit.setTimeStep(1);
-            oLinearCircuit.addResistor(0, 6, 10);
-            AssertAction.VerifyAssert(() => oLinearCircuit.initalize(), "Expected 'Simulation nodes are not condensed into the smallest number possible!' error, did not get it!");
+            oLinearCircuit.addResistor(0, 6, 10); // Node numbers do not have to be condensed
+            oLinearCircuit.initalize();
+            oLinearCircuit.step();
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oLinearCircuit.getVoltage(2))) / 10000 == 10, "Incorrect voltage at node 2! Expected 10");
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oLinearCircuit.getVoltage(6))) / 10000 == 0, "Incorrect voltage at node 6! Expected 0");
+            AssertAction.VerifyAssert(() => oLinearCircuit.getVoltage(5), "Expected 'Requested node does not exist!' error, did not get it!");
 
             oLinearCircuit.Dispose();
         }
@@ -371,65 +604,517 @@ namespace UnitTests
         [TestMethod]
         public void SimulationIntegrationTestRC()
         {
-            bool bDone;
-            int iSteps = 0;
             LinearCircuit oLinearCircuit = new LinearCircuit(3);
 
-            oLinearCircuit.addGroundedVoltageSource(2, 1, 30, 10); // Node 2 is ground
-            oLinearCircuit.addResistor(1, 0, 10);
-            oLinearCircuit.addCapacitor(0, 2, 0.2);
-            oLinearCircuit.setStopTime(10);
-            oLinearCircuit.setTimeStep(1);
+            SeriesRC.addComponents(oLinearCircuit);
             oLinearCircuit.initalize();
+            SeriesRC.stepToEnd(oLinearCircuit.step);
 
-            do
+            Assert.IsTrue((int)Math.Round(oLinearCircuit.getTime()) == 10, "Incorrect time! Expected 10");
+            SeriesRC.checkResult(oLinearCircuit.getVoltage, oLinearCircuit.getCurrent);
+
+            oLinearCircuit.Dispose();
+        }
+
+        [TestMethod]
+        public void SimulationIntegrationTestRCSparse()
+        {
+            LinearCircuit oLinearCircuit = new LinearCircuit(3);
+
+            // The sparse solver must give the same result as the dense one
+            oLinearCircuit.setSparseSolver(true);
+            SeriesRC.addComponents(oLinearCircuit);
+            oLinearCircuit.initalize();
+            SeriesRC.stepToEnd(oLinearCircuit.step);
+            SeriesRC.checkResult(oLinearCircuit.getVoltage, oLinearCircuit.getCurrent);
+
+            oLinearCircuit.Dispose();
+        }
+
+        [TestMethod]
+        public void SimulationIntegrationTestReinitalize()
+        {
+            LinearCircuit oLinearCircuit = new LinearCircuit(3);
+
+            SeriesRC.addComponents(oLinearCircuit);
+            oLinearCircuit.setTimeStep(2);
+            oLinearCircuit.initalize();
+            oLinearCircuit.step();
+
+            // Same topology with a new time step reuses the factorization structure, the run starts over
+            oLinearCircuit.setTimeStep(SeriesRC.dTimeStep);
+            oLinearCircuit.initalize();
+            SeriesRC.stepToEnd(oLinearCircuit.step);
+            SeriesRC.checkResult(oLinearCircuit.getVoltage, oLinearCircuit.getCurrent);
+
+            oLinearCircuit.Dispose();
+        }
+
+        [TestMethod]
+        public void SimulationIntegrationTestRCEnsemble()
+        {
+            double[] oVoltages = { 30, 15, 60 };
+            LinearCircuitEnsemble oEnsemble = new LinearCircuitEnsemble(3, 3);
+
+            for (int iInstance = 0; iInstance < 3; iInstance++)
+                SeriesRC.addComponents(oEnsemble, iInstance, oVoltages[iInstance]);
+            oEnsemble.initalize();
+            SeriesRC.stepToEnd(oEnsemble.step);
+
+            // Instance 0 is the reference circuit, the others are its result scaled by their source voltage
+            Assert.IsTrue(oEnsemble.getNumInstances() == 3, "Incorrect instance count! Expected 3");
+            SeriesRC.checkResult(iNode => oEnsemble.getVoltage(0, iNode), iComponent => oEnsemble.getCurrent(0, iComponent));
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oEnsemble.getVoltage(1, 0))) / 10000 == 13.6112, "Incorrect voltage at node 0 of instance 1! Expected 13.6112");
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oEnsemble.getVoltage(2, 0))) / 10000 == 54.4448, "Incorrect voltage at node 0 of instance 2! Expected 54.4448");
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oEnsemble.getVoltage(2, 1))) / 10000 == 57.2224, "Incorrect voltage at node 1 of instance 2! Expected 57.2224");
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oEnsemble.getVoltage(1, 2))) / 10000 == 0, "Incorrect voltage at node 2 of instance 1! Expected 0");
+            Assert.IsTrue(Math.Truncate(Math.Round(100000 * oEnsemble.getCurrent(1, 2))) / 100000 == 0.06944, "Incorrect current at component 2 of instance 1! Expected 0.06944");
+            AssertAction.VerifyAssert(() => oEnsemble.getVoltage(3, 0), "Expected 'Requested instance does not exist!' error, did not get it!");
+
+            oEnsemble.Dispose();
+        }
+
+        [TestMethod]
+        public void SimulationIntegrationTestRCPartitioned()
+        {
+            PartitionedCircuit oCircuit = new PartitionedCircuit();
+
+            // The partitioned engine must match the component based simulation
+            SeriesRC.addComponents(oCircuit);
+            oCircuit.initalize();
+            SeriesRC.stepToEnd(oCircuit.step);
+            SeriesRC.checkResult(oCircuit.getVoltage, oCircuit.getCurrent);
+            AssertAction.VerifyAssert(() => oCircuit.addGroundedVoltageSource(3, 4, 10, 1), "Expected 'Simulation already has an across reference node, cannot add another one!' error, did not get it!");
+
+            oCircuit.Dispose();
+        }
+
+        [TestMethod]
+        public void SimulationIntegrationTestRLCAdaptive()
+        {
+            int iSteps = 0;
+            LinearCircuit oLinearCircuit = new LinearCircuit();
+
+            oLinearCircuit.addGroundedVoltageSource(0, 1, 10, 1); // Node 0 is ground
+            oLinearCircuit.addResistor(1, 2, 10);
+            oLinearCircuit.addInductor(2, 3, 0.001);
+            oLinearCircuit.addCapacitor(3, 0, 0.000001);
+            oLinearCircuit.setStopTime(0.01);
+            oLinearCircuit.setTimeStep(0.0000001);
+            oLinearCircuit.setAdaptiveTimeStep(0.00000001, 0.001);
+            oLinearCircuit.setTruncationErrorTolerance(0.0001, 0.000001);
+            oLinearCircuit.initalize();
+
+            while (oLinearCircuit.step() == false)
             {
-                bDone = oLinearCircuit.step();
                 iSteps++;
             }
-            while (bDone == false);
 
-            Assert.IsTrue(iSteps == 10, "Simulation did not finish in the correct number of time steps!");
-            Assert.IsTrue((int)Math.Round(oLinearCircuit.getTime()) == 10, "Incorrect time! Expected 10");
-            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oLinearCircuit.getVoltage(0))) / 10000 == 27.2224, "Incorrect voltage at node 0! Expected 27.2224");
-            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oLinearCircuit.getVoltage(1))) / 10000 == 28.6112, "Incorrect voltage at node 1! Expected 28.6112");
-            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oLinearCircuit.getVoltage(2))) / 10000 == 0, "Incorrect voltage at node 2! Expected 0");
-            Assert.IsTrue(Math.Truncate(Math.Round(100000 * oLinearCircuit.getCurrent(0))) / 100000 == 0.13888, "Incorrect current at component 0! Expected 0.13888");
-            Assert.IsTrue(Math.Truncate(Math.Round(100000 * oLinearCircuit.getCurrent(1))) / 100000 == 0.13888, "Incorrect current at component 1! Expected 0.13888");
-            Assert.IsTrue(Math.Truncate(Math.Round(100000 * oLinearCircuit.getCurrent(2))) / 100000 == 0.13888, "Incorrect current at component 2! Expected 0.13888");
+            Assert.IsTrue(iSteps < 5000, "Adaptive stepping took too many steps! A fixed step of 0.0000001 needs 100000");
+            Assert.IsTrue(Math.Abs(oLinearCircuit.getTime() - 0.01) < 1e-12, "Incorrect time! Expected 0.01");
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oLinearCircuit.getVoltage(3))) / 10000 == 10, "Incorrect voltage at node 3! Expected 10");
+            Assert.IsTrue(oLinearCircuit.getCurrentTimeStep() <= 0.001, "Time step grew past the maximum!");
+            Assert.IsTrue(oLinearCircuit.getNumFactorizationCacheHits() > 0, "Expected step size changes to reuse cached factorizations!");
+            AssertAction.VerifyAssert(() => oLinearCircuit.setAdaptiveTimeStep(0.001, 0.0001), "Expected 'Adaptive time step bounds must be positive and the minimum cannot be larger than the maximum!' error, did not get it!");
 
             oLinearCircuit.Dispose();
         }
 
         [TestMethod]
-        public void SimulationIntegrationTestRL()
+        public void SimulationIntegrationTestRCSweep()
         {
-            bool bDone;
-            int iSteps = 0;
+            int iResistor;
+            CircuitDescription oCircuit = new CircuitDescription();
+            ParameterSweep oSweep;
+
+            iResistor = SeriesRC.addComponents(oCircuit);
+            oSweep = new ParameterSweep(oCircuit, SeriesRC.dStopTime, SeriesRC.dTimeStep);
+            oSweep.addGridParameter(iResistor, 5, 15, 3);
+            oSweep.addVoltageProbe(0);
+            oSweep.addCurrentProbe(iResistor);
+            oSweep.setNumThreads(2);
+            AssertAction.VerifyAssert(() => oSweep.getResult(0, 0), "Expected 'Cannot read results from a sweep that has not been run!' error, did not get it!");
+            oSweep.run();
+
+            Assert.IsTrue(oSweep.getNumVariants() == 3, "Incorrect number of variants! Expected 3");
+            Assert.IsTrue(oSweep.getNumFailedVariants() == 0, "Incorrect number of failed variants! Expected 0");
+            Assert.IsTrue(oSweep.getParameterValue(1, 0) == 10, "Incorrect resistance for variant 1! Expected 10");
+            // Variant 1 keeps the original 10 ohm, so it must reproduce the single simulation
+            SeriesRC.checkNode0Voltage(oSweep.getResult(1, 0));
+            SeriesRC.checkCurrent(oSweep.getResult(1, 1));
+            AssertAction.VerifyAssert(() => oSweep.getResult(3, 0), "Expected 'Requested sweep value does not exist!' error, did not get it!");
+
+            oSweep.Dispose();
+            oCircuit.Dispose();
+
+            // High impedance divider, a 1e10 ohm source driving a 1e10 to 3e10 ohm load
+            oCircuit = new CircuitDescription();
+            iResistor = oCircuit.addResistor(1, 0, 1e10);
+            oCircuit.addGroundedVoltageSource(0, 1, 10, 1e10);
+            oSweep = new ParameterSweep(oCircuit, 1, 1);
+            oSweep.addGridParameter(iResistor, 1e10, 3e10, 3);
+            oSweep.addVoltageProbe(1);
+            oSweep.run();
+
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oSweep.getResult(0, 0))) / 10000 == 5, "Incorrect voltage at node 1 for variant 0! Expected 5");
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oSweep.getResult(1, 0))) / 10000 == 6.6667, "Incorrect voltage at node 1 for variant 1! Expected 6.6667");
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oSweep.getResult(2, 0))) / 10000 == 7.5, "Incorrect voltage at node 1 for variant 2! Expected 7.5");
+
+            oSweep.Dispose();
+            oCircuit.Dispose();
+        }
+
+        [TestMethod]
+        public void NetlistParserTest()
+        {
+            string sPath = Path.GetTempFileName();
+            Netlist oNetlist;
+            LinearCircuit oLinearCircuit;
+
+            File.WriteAllText(sPath, SeriesRC.sNetlist);
+            oNetlist = new Netlist(sPath);
+
+            Assert.IsTrue(oNetlist.getTitle() == "Series RC Circuit", "Incorrect title! Expected 'Series RC Circuit'");
+            Assert.IsTrue(oNetlist.getNumComponents() == 3, "Incorrect number of components! Expected 3");
+            Assert.IsTrue(oNetlist.getVoltageScopeNode() == 0, "Incorrect voltage scope node! Expected 0");
+            Assert.IsTrue(oNetlist.getCurrentScopeComponent() == 2, "Incorrect current scope component! Expected 2");
+            Assert.IsTrue(oNetlist.getTimeStep() == 1, "Incorrect time step! Expected 1");
+            Assert.IsTrue(oNetlist.getStopTime() == 10, "Incorrect stop time! Expected 10");
+
+            // The parsed circuit must simulate like the one built in code
+            oLinearCircuit = oNetlist.createLinearCircuit();
+            oLinearCircuit.initalize();
+            SeriesRC.stepToEnd(oLinearCircuit.step);
+            SeriesRC.checkResult(oLinearCircuit.getVoltage, oLinearCircuit.getCurrent);
+
+            File.WriteAllText(sPath, "Broken Circuit\nResistor(1, 0 10)\nScopeV(0)\nScopeI(0)\nTimeStep(1)\nStopTime(10)\n");
+            AssertAction.VerifyAssert(() => new Netlist(sPath), "Expected 'Line 2, column 15: Expected ','!' error, did not get it!");
+
+            File.Delete(sPath);
+            oLinearCircuit.Dispose();
+            oNetlist.Dispose();
+        }
+
+        [TestMethod]
+        public void BinaryCircuitFileTest()
+        {
+            string sTextPath = Path.GetTempFileName();
+            string sBinaryPath = Path.GetTempFileName();
+            Netlist oNetlist;
+            LinearCircuit oLinearCircuit;
+
+            File.WriteAllText(sTextPath, SeriesRC.sNetlist);
+            Netlist.convertToBinary(sTextPath, sBinaryPath);
+            oNetlist = Netlist.loadBinary(sBinaryPath);
+
+            Assert.IsTrue(oNetlist.getTitle() == "Series RC Circuit", "Incorrect title! Expected 'Series RC Circuit'");
+            Assert.IsTrue(oNetlist.getNumComponents() == 3, "Incorrect number of components! Expected 3");
+            Assert.IsTrue(oNetlist.getVoltageScopeNode() == 0, "Incorrect voltage scope node! Expected 0");
+            Assert.IsTrue(oNetlist.getCurrentScopeComponent() == 2, "Incorrect current scope component! Expected 2");
+            Assert.IsTrue(oNetlist.getTimeStep() == 1, "Incorrect time step! Expected 1");
+            Assert.IsTrue(oNetlist.getStopTime() == 10, "Incorrect stop time! Expected 10");
+            AssertAction.VerifyAssert(() => Netlist.loadBinary(sTextPath), "Expected 'File is not a binary circuit file!' error, did not get it!");
+
+            // The round trip keeps the component values
+            oLinearCircuit = oNetlist.createLinearCircuit();
+            oLinearCircuit.initalize();
+            SeriesRC.stepToEnd(oLinearCircuit.step);
+            SeriesRC.checkResult(oLinearCircuit.getVoltage, oLinearCircuit.getCurrent);
+
+            File.Delete(sTextPath);
+            File.Delete(sBinaryPath);
+            oLinearCircuit.Dispose();
+            oNetlist.Dispose();
+        }
+
+        [TestMethod]
+        public void SimulationIntegrationTestRCRecorded()
+        {
+            string sPath = Path.GetTempFileName();
+            string[] sLines;
+            LinearCircuit oLinearCircuit = new LinearCircuit();
+
+            SeriesRC.addComponents(oLinearCircuit);
+            oLinearCircuit.addVoltageProbe(0);
+            oLinearCircuit.addCurrentProbe(2);
+            oLinearCircuit.recordToCsv(sPath, 2);
+            oLinearCircuit.initalize();
+            while (oLinearCircuit.step() == false) ;
+            oLinearCircuit.stopRecording();
+
+            sLines = File.ReadAllLines(sPath);
+            Assert.IsTrue(sLines.Length == 6, "Incorrect number of recorded lines! Expected 6");
+            Assert.IsTrue(sLines[0] == "Time,V(0),I(2)", "Incorrect recording header! Expected 'Time,V(0),I(2)'");
+            Assert.IsTrue(double.Parse(sLines[5].Split(',')[0]) == 10, "Incorrect time of the last sample! Expected 10");
+            SeriesRC.checkNode0Voltage(double.Parse(sLines[5].Split(',')[1]));
+            SeriesRC.checkCurrent(double.Parse(sLines[5].Split(',')[2]));
+
+            oLinearCircuit.addVoltageProbe(7);
+            oLinearCircuit.recordToCsv(sPath, 1);
+            AssertAction.VerifyAssert(() => oLinearCircuit.initalize(), "Expected 'Requested node does not exist!' error, did not get it!");
+
+            oLinearCircuit.Dispose();
+            File.Delete(sPath);
+        }
+
+        [TestMethod]
+        public void SimulationIntegrationTestRLRun()
+        {
+            double[] oRows;
+            double[] oChunk = new double[4 * 3];
+            int iTotalRows = 0;
+            int iNumRows;
             LinearCircuit oLinearCircuit = new LinearCircuit(3);
 
-            oLinearCircuit.addGroundedVoltageSource(2, 1, 30, 10); // Node 2 is ground
-            oLinearCircuit.addResistor(1, 0, 10);
-            oLinearCircuit.addInductor(0, 2, 50);
-            oLinearCircuit.setStopTime(10);
+            SeriesRL.addComponents(oLinearCircuit);
+            oLinearCircuit.addVoltageProbe(0);
+            oLinearCircuit.addCurrentProbe(2);
+            oLinearCircuit.initalize();
+
+            Assert.IsTrue(oLinearCircuit.getRunRowSize() == 3, "Incorrect run row size! Expected 3");
+            Assert.IsTrue(oLinearCircuit.getNumRemainingSteps() == 10, "Incorrect number of remaining steps! Expected 10");
+            oRows = oLinearCircuit.runToEnd();
+            Assert.IsTrue(oRows.Length == 30, "Incorrect number of run values! Expected 30");
+            Assert.IsTrue((int)Math.Round(oRows[27]) == 10, "Incorrect time of the last row! Expected 10");
+            SeriesRL.checkNode0Voltage(oRows[28]);
+            SeriesRL.checkCurrent(oRows[29]);
+            Assert.IsTrue(oLinearCircuit.run(oChunk) == 0, "Run past the stop time wrote rows!");
+
+            // A small buffer is filled chunk by chunk
+            oLinearCircuit.initalize();
+            while ((iNumRows = oLinearCircuit.run(oChunk)) > 0)
+                iTotalRows += iNumRows;
+            Assert.IsTrue(iTotalRows == 10, "Incorrect number of rows in chunks! Expected 10");
+            SeriesRL.checkNode0Voltage(oChunk[1 * 3 + 1]); // Last row of the last chunk
+
+            oLinearCircuit.Dispose();
+        }
+
+        [TestMethod]
+        public void SimulationIntegrationTestRLOperatingPoint()
+        {
+            LinearCircuit oLinearCircuit = new LinearCircuit(3);
+
+            SeriesRL.addComponents(oLinearCircuit);
+
+            // Inductor is a short in DC
+            oLinearCircuit.solveOperatingPoint();
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oLinearCircuit.getVoltage(0))) / 10000 == 0, "Incorrect DC voltage at node 0! Expected 0");
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oLinearCircuit.getVoltage(1))) / 10000 == 15, "Incorrect DC voltage at node 1! Expected 15");
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oLinearCircuit.getCurrent(2))) / 10000 == 1.5, "Incorrect DC current at component 2! Expected 1.5");
+            AssertAction.VerifyAssert(() => oLinearCircuit.step(), "Expected 'Simulation has not been initalized!' error, did not get it!");
+
+            // A transient started from the operating point is already settled
+            oLinearCircuit.setStartFromOperatingPoint(true);
+            oLinearCircuit.initalize();
+            SeriesRC.stepToEnd(oLinearCircuit.step);
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oLinearCircuit.getCurrent(2))) / 10000 == 1.5, "Incorrect current at component 2 after the transient! Expected 1.5");
+
+            oLinearCircuit.Dispose();
+        }
+
+        [TestMethod]
+        public void SimulationIntegrationTestSeriesCapacitorsOperatingPoint()
+        {
+            // Node 2 only connects through capacitors, in DC it settles where the uncharged capacitive divider puts it
+            for (int iSolver = 0; iSolver < 2; iSolver++)
+            {
+                LinearCircuit oLinearCircuit = new LinearCircuit(3);
+
+                oLinearCircuit.addGroundedVoltageSource(0, 1, 10, 1); // Node 0 is ground
+                oLinearCircuit.addCapacitor(1, 2, 1e-6);
+                oLinearCircuit.addCapacitor(2, 0, 3e-6);
+                oLinearCircuit.setSparseSolver(iSolver == 1);
+
+                oLinearCircuit.solveOperatingPoint();
+                Assert.IsTrue(Math.Truncate(Math.Round(10000 * oLinearCircuit.getVoltage(1))) / 10000 == 10, "Incorrect DC voltage at node 1! Expected 10");
+                Assert.IsTrue(Math.Truncate(Math.Round(10000 * oLinearCircuit.getVoltage(2))) / 10000 == 2.5, "Incorrect DC voltage at node 2! Expected 2.5");
+
+                // A transient started from the operating point is already settled
+                oLinearCircuit.setStopTime(1e-3);
+                oLinearCircuit.setTimeStep(1e-5);
+                oLinearCircuit.setStartFromOperatingPoint(true);
+                oLinearCircuit.initalize();
+                while (oLinearCircuit.step() == false) ;
+                Assert.IsTrue(Math.Truncate(Math.Round(10000 * oLinearCircuit.getVoltage(2))) / 10000 == 2.5, "Incorrect voltage at node 2 after the transient! Expected 2.5");
+
+                oLinearCircuit.Dispose();
+            }
+        }
+
+        [TestMethod]
+        public void AcAnalysisTestRC()
+        {
+            CircuitDescription oCircuit = new CircuitDescription();
+
+            oCircuit.addGroundedVoltageSource(0, 1, 1, 1); // Node 0 is ground
+            oCircuit.addResistor(1, 2, 999);
+            oCircuit.addCapacitor(2, 0, 0.000001);
+
+            AcAnalysis oAnalysis = new AcAnalysis(oCircuit);
+            oAnalysis.addFrequency(1 / (2 * Math.PI * 0.001)); // Cutoff, RC = 1 ms
+            oAnalysis.addLogFrequencies(10, 100000, 5);
+            oAnalysis.addVoltageProbe(2);
+            AssertAction.VerifyAssert(() => oAnalysis.getMagnitude(0, 0), "Expected 'Cannot read results from an analysis that has not been run!' error, did not get it!");
+            oAnalysis.run();
+
+            Assert.IsTrue(oAnalysis.getNumFrequencies() == 6, "Incorrect number of frequencies! Expected 6");
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oAnalysis.getMagnitude(0, 0))) / 10000 == 0.7071, "Incorrect magnitude at the cutoff! Expected 0.7071");
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oAnalysis.getPhase(0, 0) * 180 / Math.PI)) / 10000 == -45, "Incorrect phase at the cutoff! Expected -45");
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oAnalysis.getFrequency(2))) / 10000 == 100, "Incorrect second log frequency! Expected 100");
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oAnalysis.getMagnitude(1, 0))) / 10000 == 0.998, "Incorrect magnitude at 10 Hz! Expected 0.998");
+
+            oAnalysis.Dispose();
+            oCircuit.Dispose();
+        }
+
+        [TestMethod]
+        public void SimulationIntegrationTestRCIslands()
+        {
+            LinearCircuit oLinearCircuit = new LinearCircuit(6);
+
+            // Two isolated circuits in one simulation, each one with its own reference
+            SeriesRC.addComponents(oLinearCircuit);
+            oLinearCircuit.addGroundedVoltageSource(12, 11, 10, 1); // Node 12 is ground
+            oLinearCircuit.addResistor(11, 12, 9);
+            AssertAction.VerifyAssert(() => oLinearCircuit.addGroundedVoltageSource(11, 13, 10, 1), "Expected 'The island containing node 11 already has an across reference node, cannot add another one!' error, did not get it!");
+            AssertAction.VerifyAssert(() => oLinearCircuit.addResistor(0, 11, 10), "Expected 'The island containing node 11 already has an across reference node, cannot add another one!' error, did not get it!");
+            Assert.IsTrue(oLinearCircuit.getNumIslands() == 2, "Incorrect island count! Expected 2");
+            oLinearCircuit.initalize();
+            SeriesRC.stepToEnd(oLinearCircuit.step);
+
+            // The RC island is unaffected by the resistive one
+            SeriesRC.checkResult(oLinearCircuit.getVoltage, oLinearCircuit.getCurrent);
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oLinearCircuit.getVoltage(11))) / 10000 == 9, "Incorrect voltage at node 11! Expected 9");
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oLinearCircuit.getVoltage(12))) / 10000 == 0, "Incorrect voltage at node 12! Expected 0");
+            Assert.IsTrue(Math.Truncate(Math.Round(100000 * oLinearCircuit.getCurrent(4))) / 100000 == 1, "Incorrect current at component 4! Expected 1");
+
+            // A third circuit without a reference cannot be solved
+            oLinearCircuit.addResistor(20, 21, 5);
+            AssertAction.VerifyAssert(() => oLinearCircuit.initalize(), "Expected 'Every isolated part of the simulation needs an across reference node!' error, did not get it!");
+
+            oLinearCircuit.Dispose();
+        }
+
+        [TestMethod]
+        public void SimulationIntegrationTestIdealSources()
+        {
+            LinearCircuit oLinearCircuit = new LinearCircuit(12);
+
+            // Ideal sources have no source resistance, their currents are extra unknowns of the simulation
+            oLinearCircuit.addGround(0);
+            oLinearCircuit.addVoltageSource(0, 1, 1);
+            oLinearCircuit.addResistor(1, 0, 4);
+            oLinearCircuit.addVoltageControlledVoltageSource(0, 2, 0, 1, 5);
+            oLinearCircuit.addResistor(2, 0, 10);
+            oLinearCircuit.addVoltageControlledCurrentSource(0, 3, 0, 1, 2);
+            oLinearCircuit.addResistor(3, 0, 1);
+            oLinearCircuit.addCurrentControlledVoltageSource(0, 4, 1, 5, 4); // Control current flows from node 1 to node 5
+            oLinearCircuit.addResistor(5, 0, 1);
+            oLinearCircuit.addResistor(4, 0, 1);
+            oLinearCircuit.addCurrentSource(0, 6, 2);
+            oLinearCircuit.addResistor(6, 0, 5);
+            AssertAction.VerifyAssert(() => oLinearCircuit.addGround(1), "Expected 'The island containing node 1 already has an across reference node, cannot add another one!' error, did not get it!");
+            AssertAction.VerifyAssert(() => oLinearCircuit.addVoltageControlledVoltageSource(7, 7, 0, 1, 1), "Expected 'Two node values must not be the same!' error, did not get it!");
+            oLinearCircuit.setStopTime(1);
             oLinearCircuit.setTimeStep(1);
             oLinearCircuit.initalize();
+            oLinearCircuit.step();
+
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oLinearCircuit.getVoltage(1))) / 10000 == 1, "Incorrect voltage at node 1! Expected 1");
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oLinearCircuit.getVoltage(2))) / 10000 == 5, "Incorrect voltage at node 2! Expected 5");
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oLinearCircuit.getVoltage(3))) / 10000 == 2, "Incorrect voltage at node 3! Expected 2");
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oLinearCircuit.getVoltage(4))) / 10000 == 4, "Incorrect voltage at node 4! Expected 4");
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oLinearCircuit.getVoltage(6))) / 10000 == 10, "Incorrect voltage at node 6! Expected 10");
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oLinearCircuit.getCurrent(1))) / 10000 == 1.25, "Incorrect current at component 1! Expected 1.25");
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oLinearCircuit.getCurrent(3))) / 10000 == 0.5, "Incorrect current at component 3! Expected 0.5");
+
+            oLinearCircuit.Dispose();
+        }
+
+        [TestMethod]
+        public void SimulationIntegrationTestWaveformSources()
+        {
+            bool bDone;
+            int iSteps = 0;
+            LinearCircuit oLinearCircuit = new LinearCircuit(5);
+            PiecewiseLinearWaveform oRamp = new PiecewiseLinearWaveform(new double[] { 0, 1, 2 }, new double[] { 0, 10, 0 });
+            PulseWaveform oPulse = new PulseWaveform(0, 1, 0.5, 0, 0, 1, 4);
+
+            AssertAction.VerifyAssert(() => new PiecewiseLinearWaveform(new double[] { 0, 0 }, new double[] { 0, 1 }), "Expected 'Waveform times must be increasing!' error, did not get it!");
+            AssertAction.VerifyAssert(() => new PulseWaveform(0, 1, 0, 1, 1, 1, 2), "Expected 'Pulse period must be greater than 0 and fit the rise, width and fall times!' error, did not get it!");
+
+            // Source values follow the waveforms at the end of every step
+            oLinearCircuit.addGround(0);
+            oLinearCircuit.addVoltageSource(0, 1, oRamp);
+            oLinearCircuit.addResistor(1, 0, 2);
+            oLinearCircuit.addCurrentSource(0, 2, oPulse);
+            oLinearCircuit.addResistor(2, 0, 10);
+            oLinearCircuit.setStopTime(2);
+            oLinearCircuit.setTimeStep(0.25);
+            oLinearCircuit.initalize();
 
             do
             {
                 bDone = oLinearCircuit.step();
                 iSteps++;
+                Assert.IsTrue(Math.Truncate(Math.Round(10000 * oLinearCircuit.getVoltage(1))) / 10000 == oRamp.getValue(oLinearCircuit.getTime()), "Incorrect voltage at node 1! Expected the ramp value");
+                Assert.IsTrue(Math.Truncate(Math.Round(10000 * oLinearCircuit.getVoltage(2))) / 10000 == 10 * oPulse.getValue(oLinearCircuit.getTime()), "Incorrect voltage at node 2! Expected 10 times the pulse value");
             }
             while (bDone == false);
 
-            Assert.IsTrue(iSteps == 10, "Simulation did not finish in the correct number of time steps!");
+            Assert.IsTrue(iSteps == 8, "Simulation did not finish in the correct number of time steps!");
+            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oLinearCircuit.getCurrent(1))) / 10000 == 0, "Incorrect current at component 1! Expected 0");
+
+            oLinearCircuit.Dispose();
+            oRamp.Dispose();
+            oPulse.Dispose();
+        }
+
+        [TestMethod]
+        public void SimulationIntegrationTestHighImpedance()
+        {
+            // Conductances of 1e-10 S are far from singular, the solution must not depend on the absolute scale of the matrix
+            for (int iSolver = 0; iSolver < 2; iSolver++)
+            {
+                LinearCircuit oLinearCircuit = new LinearCircuit(2);
+                oLinearCircuit.addGroundedVoltageSource(0, 1, 10, 1e10);
+                oLinearCircuit.addResistor(1, 0, 1e10);
+                oLinearCircuit.setSparseSolver(iSolver == 1);
+                oLinearCircuit.setStopTime(1);
+                oLinearCircuit.setTimeStep(1);
+                oLinearCircuit.initalize();
+                oLinearCircuit.step();
+
+                Assert.IsTrue(Math.Truncate(Math.Round(10000 * oLinearCircuit.getVoltage(1))) / 10000 == 5, "Incorrect voltage at node 1! Expected 5");
+                Assert.IsTrue(Math.Truncate(Math.Round(1e14 * oLinearCircuit.getCurrent(1))) / 10000 == 5, "Incorrect current at component 1! Expected 5e-10");
+                oLinearCircuit.Dispose();
+
+                PartitionedCircuit oCircuit = new PartitionedCircuit();
+                oCircuit.addGroundedVoltageSource(0, 1, 10, 1e10);
+                oCircuit.addResistor(1, 0, 1e10);
+                oCircuit.setSparseSolver(iSolver == 1);
+                oCircuit.setStopTime(1);
+                oCircuit.setTimeStep(1);
+                oCircuit.initalize();
+                oCircuit.step();
+
+                Assert.IsTrue(Math.Truncate(Math.Round(10000 * oCircuit.getVoltage(1))) / 10000 == 5, "Incorrect partitioned voltage at node 1! Expected 5");
+                oCircuit.Dispose();
+            }
+        }
+
+        [TestMethod]
+        public void SimulationIntegrationTestRL()
+        {
+            LinearCircuit oLinearCircuit = new LinearCircuit(3);
+
+            SeriesRL.addComponents(oLinearCircuit);
+            oLinearCircuit.initalize();
+            SeriesRC.stepToEnd(oLinearCircuit.step);
+
             Assert.IsTrue((int)Math.Round(oLinearCircuit.getTime()) == 10, "Incorrect time! Expected 10");
-            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oLinearCircuit.getVoltage(0))) / 10000 == 0.6503, "Incorrect voltage at node 0! Expected 0.6503");
-            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oLinearCircuit.getVoltage(1))) / 10000 == 15.3252, "Incorrect voltage at node 1! Expected 15.3252");
-            Assert.IsTrue(Math.Truncate(Math.Round(10000 * oLinearCircuit.getVoltage(2))) / 10000 == 0, "Incorrect voltage at node 2! Expected 0");
-            Assert.IsTrue(Math.Truncate(Math.Round(100000 * oLinearCircuit.getCurrent(0))) / 100000 == 1.46748, "Incorrect current at component 0! Expected 1.46748");
-            Assert.IsTrue(Math.Truncate(Math.Round(100000 * oLinearCircuit.getCurrent(1))) / 100000 == 1.46748, "Incorrect current at component 1! Expected 1.46748");
-            Assert.IsTrue(Math.Truncate(Math.Round(100000 * oLinearCircuit.getCurrent(2))) / 100000 == 1.46748, "Incorrect current at component 2! Expected 1.46748");
+            SeriesRL.checkResult(oLinearCircuit.getVoltage, oLinearCircuit.getCurrent);
 
             oLinearCircuit.Dispose();
         }